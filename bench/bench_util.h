@@ -0,0 +1,79 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+// Helpers shared by the standalone benchmarks: timing, the editor-style
+// test course and pixel comparison of software-rendered frames.
+
+#include "track.h"
+#include <SDL3/SDL.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The way the editor lays tracks out: a grass field of 50 px tiles with a
+// four-tile road around it and through the middle, walls on the corners
+// and a start line
+inline std::vector<Tile> buildCourse(int side) {
+    const float tileSize = 50.0f;
+    const int road = 4;
+    std::vector<Tile> tiles;
+    for (int row = 0; row < side; ++row) {
+        for (int col = 0; col < side; ++col) {
+            bool onRing = row < road || col < road || row >= side - road || col >= side - road;
+            bool onCross = std::abs(row - side / 2) < road / 2;
+            TileType type = onRing || onCross ? TileType::TRACK : TileType::GRASS;
+            tiles.push_back({ type, col * tileSize, row * tileSize, tileSize, tileSize, 0.0f });
+        }
+    }
+    for (int corner = 0; corner < 4; ++corner) {
+        float x = (corner & 1) ? (side - 1) * tileSize : 0.0f;
+        float y = (corner & 2) ? (side - 1) * tileSize : 0.0f;
+        tiles.push_back({ TileType::WALL, x + 10.0f, y + 10.0f, 30.0f, 30.0f, 0.0f });
+    }
+    tiles.push_back({ TileType::START_FINISH, tileSize * side / 2, 0.0f, 20.0f, road * tileSize, 0.0f });
+    return tiles;
+}
+
+inline void addAll(Track& track, const std::vector<Tile>& tiles) {
+    for (const Tile& tile : tiles) {
+        track.addTile(tile.type, tile.x, tile.y, tile.width, tile.height, tile.angle);
+    }
+}
+
+// Mean ns per query over x, y pairs; the answers are summed into checksum
+// so the loop can't be optimised away
+template <typename Query>
+double timeQueries(const std::vector<float>& points, Query&& query, size_t& checksum) {
+    checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i + 1 < points.size(); i += 2) {
+        checksum += static_cast<size_t>(query(points[i], points[i + 1]));
+    }
+    return secondsSince(start) * 1e9 / (points.size() / 2);
+}
+
+// Pixels that differ between two 32-bit frames read back from a renderer,
+// or SIZE_MAX when they can't be compared
+inline size_t differingPixels(SDL_Surface* a, SDL_Surface* b) {
+    if (!a || !b || a->w != b->w || a->h != b->h || a->format != b->format) {
+        return static_cast<size_t>(-1);
+    }
+    size_t differing = 0;
+    for (int y = 0; y < a->h; ++y) {
+        const Uint32* rowA = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(a->pixels) + y * a->pitch);
+        const Uint32* rowB = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(b->pixels) + y * b->pitch);
+        for (int x = 0; x < a->w; ++x) {
+            if (rowA[x] != rowB[x]) {
+                ++differing;
+            }
+        }
+    }
+    return differing;
+}
+
+#endif // BENCH_UTIL_H
@@ -0,0 +1,117 @@
+// Car-vs-car collision benchmark: the CarCollisions grid broadphase against
+// a naive all-pairs loop.
+//
+// For 64 to 16k cars scattered over a square whose area grows with the car
+// count (so density, and the number of contacts per car, stay constant),
+// reports nanoseconds per car for detecting and resolving contacts, and
+// the narrowphase tests per car. Checks that the grid finds exactly the
+// overlapping pairs all-pairs does; all-pairs is skipped above 4096 cars.
+
+#include "car.h"
+#include "car_pool.h"
+#include "car_collisions.h"
+#include "physics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr size_t ALL_PAIRS_LIMIT = 4096;
+
+// Around one car per 40x40 px, which leaves a few percent of cars touching
+void scatter(CarPool& pool, size_t count, uint32_t seed) {
+    pool.clear();
+    pool.reserve(count);
+    const float side = std::sqrt(static_cast<float>(count)) * 40.0f;
+
+    uint32_t state = seed;
+    auto next = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 16777216.0f;
+    };
+    for (size_t i = 0; i < count; ++i) {
+        Car car = pool.add(next() * side, next() * side, 255, 50, 50);
+        car.setVelocity((next() - 0.5f) * 400.0f, (next() - 0.5f) * 400.0f);
+    }
+}
+
+size_t countAllPairs(const CarPool& pool) {
+    const auto& xs = pool.getPositionsX();
+    const auto& ys = pool.getPositionsY();
+    size_t contacts = 0;
+    for (size_t i = 0; i < pool.size(); ++i) {
+        for (size_t j = i + 1; j < pool.size(); ++j) {
+            if (Physics::circleCollision(xs[i], ys[i], CarPool::RADIUS,
+                                         xs[j], ys[j], CarPool::RADIUS)) {
+                ++contacts;
+            }
+        }
+    }
+    return contacts;
+}
+
+template <typename Fn>
+double nsPerCar(size_t cars, int repeats, Fn&& run) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        run(r);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (static_cast<double>(cars) * repeats);
+}
+
+} // namespace
+
+int main() {
+    const size_t sizes[] = { 64, 256, 1024, 4096, 16384 };
+    bool allMatch = true;
+
+    std::printf("%8s %12s %12s %12s %10s %8s\n",
+                "cars", "pairs(ns)", "grid(ns)", "tests/car", "contacts", "match");
+
+    for (size_t count : sizes) {
+        int repeats = static_cast<int>(std::max<size_t>(20, 2000000 / count));
+
+        CarPool pool;
+        scatter(pool, count, 12345);
+
+        double pairsNs = 0;
+        size_t expected = 0;
+        bool checked = count <= ALL_PAIRS_LIMIT;
+        if (checked) {
+            int pairRepeats = static_cast<int>(std::max<size_t>(3, 20000000 / (count * count)));
+            pairsNs = nsPerCar(count, pairRepeats, [&](int) { expected = countAllPairs(pool); });
+        }
+
+        // Resolve a fresh copy each time so every run sees the same overlaps;
+        // the copy is counted in the grid time
+        CarCollisions collisions;
+        CarPool scratch;
+        size_t found = 0;
+        size_t candidates = 0;
+        double gridNs = nsPerCar(count, repeats, [&](int) {
+            scratch = pool;
+            collisions.resolve(scratch);
+            found = collisions.getContactCount();
+            candidates = collisions.getCandidatePairs();
+        });
+
+        bool match = !checked || found == expected;
+        allMatch = allMatch && match;
+
+        if (checked) {
+            std::printf("%8zu %12.1f %12.1f %12.2f %10zu %8s\n",
+                        count, pairsNs, gridNs, static_cast<double>(candidates) / count, found,
+                        match ? "yes" : "NO");
+        } else {
+            std::printf("%8zu %12s %12.1f %12.2f %10zu %8s\n",
+                        count, "-", gridNs, static_cast<double>(candidates) / count, found, "-");
+        }
+    }
+
+    return allMatch ? 0 : 1;
+}
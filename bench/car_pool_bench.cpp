@@ -0,0 +1,194 @@
+// Car integration benchmark: the structure-of-arrays CarPool against the
+// previous layout of one heap-allocated Car object per car.
+//
+// For 4 to 16k cars, steps every car with scripted per-car inputs and
+// reports nanoseconds per car per tick for the old per-object update, the
+// pool's scalar kernel and its SIMD kernel. Checks that the two pool kernels
+// agree bit for bit and that the pool stays within rounding of the old code.
+
+#include "car.h"
+#include "car_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr float TICK_SECONDS = 1.0f / 120.0f;
+
+// The original Car::update, kept as the reference implementation
+struct LegacyCar {
+    float x, y;
+    float velocityX = 0, velocityY = 0;
+    float angle = 0;
+
+    LegacyCar(float x, float y) : x(x), y(y) {}
+
+    void update(float deltaTime, const Input& input) {
+        float acceleration = 0;
+        float turnAmount = 0;
+        if (input.isForward()) acceleration = CarPool::ACCELERATION;
+        if (input.isBackward()) acceleration = -CarPool::BRAKE_FORCE;
+        if (input.isLeft()) turnAmount = -CarPool::TURN_SPEED;
+        if (input.isRight()) turnAmount = CarPool::TURN_SPEED;
+
+        float speed = std::sqrt(velocityX * velocityX + velocityY * velocityY);
+        if (speed > 10.0f) {
+            angle += turnAmount * deltaTime * (speed / CarPool::MAX_SPEED);
+        }
+        if (acceleration != 0) {
+            velocityX += std::cos(angle) * acceleration * deltaTime;
+            velocityY += std::sin(angle) * acceleration * deltaTime;
+        }
+        float friction = std::pow(CarPool::FRICTION, deltaTime * 60.0f);
+        velocityX *= friction;
+        velocityY *= friction;
+        speed = std::sqrt(velocityX * velocityX + velocityY * velocityY);
+        if (speed > CarPool::MAX_SPEED) {
+            velocityX = (velocityX / speed) * CarPool::MAX_SPEED;
+            velocityY = (velocityY / speed) * CarPool::MAX_SPEED;
+        }
+        x += velocityX * deltaTime;
+        y += velocityY * deltaTime;
+    }
+};
+
+// Deterministic, state-independent input for a car; changes every 30 ticks
+constexpr int INPUT_PERIOD = 30;
+
+InputState scriptedInput(size_t car, int tick) {
+    uint32_t h = static_cast<uint32_t>(car) * 2654435761u ^ static_cast<uint32_t>(tick / INPUT_PERIOD) * 40503u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    InputState state;
+    state.forward = (h & 7) != 0;
+    state.backward = !state.forward;
+    state.left = (h & 0x30) == 0x10;
+    state.right = (h & 0x30) == 0x20;
+    return state;
+}
+
+void spawn(CarPool& pool, std::vector<Car>& handles, size_t count) {
+    pool.clear();
+    handles.clear();
+    pool.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        handles.push_back(pool.add(static_cast<float>(i % 128) * 40.0f,
+                                   static_cast<float>(i / 128) * 40.0f, 255, 50, 50));
+    }
+}
+
+void refreshInputs(std::vector<InputState>& inputs, int tick) {
+    if (tick % INPUT_PERIOD == 0) {
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            inputs[i] = scriptedInput(i, tick);
+        }
+    }
+}
+
+void stepPool(CarPool& pool, std::vector<InputState>& inputs, int tick, bool simd) {
+    refreshInputs(inputs, tick);
+    for (size_t i = 0; i < pool.size(); ++i) {
+        pool.setInput(i, inputs[i]);
+    }
+    if (simd) {
+        pool.integrate(TICK_SECONDS);
+    } else {
+        pool.integrateScalar(TICK_SECONDS, 0, pool.size());
+    }
+}
+
+template <typename Fn>
+double nsPerCarTick(size_t cars, int ticks, Fn&& step) {
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < ticks; ++t) {
+        step(t);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (static_cast<double>(cars) * ticks);
+}
+
+} // namespace
+
+int main() {
+    const size_t sizes[] = { 4, 64, 1024, 16384 };
+    bool allMatch = true;
+
+    std::printf("SIMD kernel: %s\n", CarPool::hasSimd() ? "SSE2" : "none (scalar fallback)");
+    std::printf("%8s %12s %12s %12s %9s %8s %12s\n",
+                "cars", "legacy(ns)", "scalar(ns)", "simd(ns)", "speedup", "exact", "drift(px)");
+
+    for (size_t count : sizes) {
+        // About eight million car updates per variant
+        int ticks = static_cast<int>(std::max<size_t>(240, 8000000 / count));
+
+        std::vector<std::unique_ptr<LegacyCar>> legacy;
+        for (size_t i = 0; i < count; ++i) {
+            legacy.push_back(std::make_unique<LegacyCar>(static_cast<float>(i % 128) * 40.0f,
+                                                         static_cast<float>(i / 128) * 40.0f));
+        }
+        std::vector<StateInput> legacyInputs(count);
+        double legacyNs = nsPerCarTick(count, ticks, [&](int t) {
+            if (t % INPUT_PERIOD == 0) {
+                for (size_t i = 0; i < count; ++i) {
+                    legacyInputs[i].state = scriptedInput(i, t);
+                }
+            }
+            for (size_t i = 0; i < legacy.size(); ++i) {
+                legacy[i]->update(TICK_SECONDS, legacyInputs[i]);
+            }
+        });
+
+        CarPool scalarPool, simdPool;
+        std::vector<Car> scalarCars, simdCars;
+        spawn(scalarPool, scalarCars, count);
+        spawn(simdPool, simdCars, count);
+        std::vector<InputState> inputs(count);
+        double scalarNs = nsPerCarTick(count, ticks, [&](int t) { stepPool(scalarPool, inputs, t, false); });
+        double simdNs = nsPerCarTick(count, ticks, [&](int t) { stepPool(simdPool, inputs, t, true); });
+
+        bool exact = true;
+        for (size_t i = 0; i < count; ++i) {
+            const Car& a = scalarCars[i];
+            const Car& b = simdCars[i];
+            if (a.getX() != b.getX() || a.getY() != b.getY() || a.getAngle() != b.getAngle() ||
+                a.getVelocityX() != b.getVelocityX() || a.getVelocityY() != b.getVelocityY()) {
+                exact = false;
+            }
+        }
+
+        // Drift against the old std::sin/std::cos code over one second of racing
+        std::vector<LegacyCar> reference;
+        for (size_t i = 0; i < count; ++i) {
+            reference.emplace_back(static_cast<float>(i % 128) * 40.0f, static_cast<float>(i / 128) * 40.0f);
+        }
+        spawn(simdPool, simdCars, count);
+        for (int t = 0; t < 120; ++t) {
+            if (t % INPUT_PERIOD == 0) {
+                for (size_t i = 0; i < count; ++i) {
+                    legacyInputs[i].state = scriptedInput(i, t);
+                }
+            }
+            for (size_t i = 0; i < count; ++i) {
+                reference[i].update(TICK_SECONDS, legacyInputs[i]);
+            }
+            stepPool(simdPool, inputs, t, true);
+        }
+        float drift = 0;
+        for (size_t i = 0; i < count; ++i) {
+            drift = std::max(drift, std::fabs(reference[i].x - simdCars[i].getX()));
+            drift = std::max(drift, std::fabs(reference[i].y - simdCars[i].getY()));
+        }
+
+        bool match = exact && drift < 0.01f;
+        allMatch = allMatch && match;
+        std::printf("%8zu %12.2f %12.2f %12.2f %8.1fx %8s %12.2e\n",
+                    count, legacyNs, scalarNs, simdNs, legacyNs / simdNs, exact ? "yes" : "NO", drift);
+    }
+
+    return allMatch ? 0 : 1;
+}
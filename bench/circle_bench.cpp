@@ -0,0 +1,145 @@
+// Circle drawing benchmark: a field of debug markers drawn with the old
+// per-pixel SDL_RenderPoint midpoint loop, against Renderer::drawCircle
+// unbatched (one SDL_RenderPoints per circle) and batched (one
+// SDL_RenderGeometry per frame), in the software renderer.
+//
+// Reports draw calls and ms per frame for each, checks the three images
+// match, and times filled circles the same way.
+//
+//   circle_bench [markers] [radius] [frames]
+
+#include "renderer.h"
+#include "bench_util.h"
+#include <SDL3/SDL.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+namespace {
+
+const int WIDTH = 1280;
+const int HEIGHT = 720;
+
+// The midpoint loop drawCircle used before outlines were cached
+size_t drawCirclePerPoint(SDL_Renderer* sdl, float fx, float fy, float radius) {
+    int cx = static_cast<int>(fx);
+    int cy = static_cast<int>(fy);
+    int x = radius;
+    int y = 0;
+    int err = 0;
+    size_t calls = 0;
+
+    while (x >= y) {
+        const int offsets[8][2] = {
+            { x, y }, { -x, y }, { x, -y }, { -x, -y },
+            { y, x }, { -y, x }, { y, -x }, { -y, -x }
+        };
+        for (const auto& o : offsets) {
+            SDL_RenderPoint(sdl, cx + o[0], cy + o[1]);
+            ++calls;
+        }
+        if (err <= 0) {
+            y += 1;
+            err += 2 * y + 1;
+        }
+        if (err > 0) {
+            x -= 1;
+            err -= 2 * x + 1;
+        }
+    }
+    return calls;
+}
+
+struct Result {
+    double milliseconds;
+    size_t drawCalls;
+    SDL_Surface* image;
+};
+
+// Runs frames of drawFrame, which returns the draw calls it made
+Result measure(SDL_Renderer* sdl, int frames, const std::function<size_t()>& drawFrame) {
+    size_t calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        SDL_SetRenderDrawColor(sdl, 20, 20, 20, 255);
+        SDL_RenderClear(sdl);
+        calls += drawFrame();
+        SDL_RenderPresent(sdl);
+    }
+    double seconds = secondsSince(start);
+    return { seconds * 1e3 / frames, calls / frames, SDL_RenderReadPixels(sdl, nullptr) };
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int markers = argc > 1 ? std::atoi(argv[1]) : 10000;
+    float radius = argc > 2 ? static_cast<float>(std::atof(argv[2])) : 5.0f;
+    int frames = argc > 3 ? std::atoi(argv[3]) : 20;
+
+    SDL_Surface* surface = SDL_CreateSurface(WIDTH, HEIGHT, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* sdl = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!sdl) {
+        std::fprintf(stderr, "software renderer unavailable: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    // Scattered deterministically over the screen, off whole pixels
+    std::vector<SDL_FPoint> centres(markers);
+    unsigned seed = 12345;
+    for (auto& centre : centres) {
+        seed = seed * 1103515245u + 12345u;
+        centre.x = (seed >> 8) % (WIDTH * 16) / 16.0f;
+        seed = seed * 1103515245u + 12345u;
+        centre.y = (seed >> 8) % (HEIGHT * 16) / 16.0f;
+    }
+
+    Renderer renderer(sdl);
+    auto withRenderer = [&](bool batching, bool filled) {
+        return [&, batching, filled]() {
+            renderer.setBatching(batching);
+            renderer.resetDrawCalls();
+            for (const auto& centre : centres) {
+                renderer.drawCircle(centre.x, centre.y, radius, 255, 255, 0, filled);
+            }
+            renderer.flush();
+            return renderer.getDrawCalls();
+        };
+    };
+
+    Result perPoint = measure(sdl, frames, [&]() {
+        SDL_SetRenderDrawColor(sdl, 255, 255, 0, 255);
+        size_t calls = 0;
+        for (const auto& centre : centres) {
+            calls += drawCirclePerPoint(sdl, centre.x, centre.y, radius);
+        }
+        return calls;
+    });
+    Result points = measure(sdl, frames, withRenderer(false, false));
+    Result batched = measure(sdl, frames, withRenderer(true, false));
+    Result filledImmediate = measure(sdl, frames, withRenderer(false, true));
+    Result filledBatched = measure(sdl, frames, withRenderer(true, true));
+
+    bool outlinesMatch = differingPixels(perPoint.image, points.image) == 0 &&
+                         differingPixels(perPoint.image, batched.image) == 0;
+    bool fillsMatch = differingPixels(filledImmediate.image, filledBatched.image) == 0;
+
+    std::printf("%d markers of radius %.1f, %d frames\n\n", markers, radius, frames);
+    std::printf("%-26s %12s %12s\n", "", "calls/frame", "ms/frame");
+    std::printf("%-26s %12zu %12.3f\n", "outline, per point", perPoint.drawCalls, perPoint.milliseconds);
+    std::printf("%-26s %12zu %12.3f\n", "outline, points per circle", points.drawCalls, points.milliseconds);
+    std::printf("%-26s %12zu %12.3f\n", "outline, batched", batched.drawCalls, batched.milliseconds);
+    std::printf("%-26s %12zu %12.3f\n", "filled, per circle", filledImmediate.drawCalls, filledImmediate.milliseconds);
+    std::printf("%-26s %12zu %12.3f\n", "filled, batched", filledBatched.drawCalls, filledBatched.milliseconds);
+    std::printf("\noutlines identical: %s\nfills identical:    %s\n",
+                outlinesMatch ? "yes" : "NO", fillsMatch ? "yes" : "NO");
+
+    for (Result* result : { &perPoint, &points, &batched, &filledImmediate, &filledBatched }) {
+        SDL_DestroySurface(result->image);
+    }
+    SDL_DestroyRenderer(sdl);
+    SDL_DestroySurface(surface);
+    return outlinesMatch && fillsMatch ? 0 : 1;
+}
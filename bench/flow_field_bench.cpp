@@ -0,0 +1,125 @@
+// Flow field benchmark: full build against the incremental refresh after
+// an editor-style tile placement, plus the per-bot cost of steering by it.
+//
+// Places a run of small tiles one at a time, refreshing the field after
+// each as the editor would, and checks that no cell farther than
+// getRefreshRange() from a tile changed. Also counts the cells where the
+// patched field differs from one built from scratch over the final tiles,
+// which re-derives the racing line and floods it over the whole grid.
+//
+//   flow_field_bench [track.json]
+
+#include "track.h"
+#include "car_pool.h"
+#include "ai_bot.h"
+#include "bench_util.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Every cell centre, row by row
+std::vector<FlowSample> cellsOf(const FlowField& field) {
+    std::vector<FlowSample> cells;
+    for (int cy = 0; cy < field.getRows(); ++cy) {
+        for (int cx = 0; cx < field.getColumns(); ++cx) {
+            FlowSample sample = {};
+            field.sample(field.getOriginX() + (cx + 0.5f) * field.getCellSize(),
+                         field.getOriginY() + (cy + 0.5f) * field.getCellSize(), sample);
+            cells.push_back(sample);
+        }
+    }
+    return cells;
+}
+
+bool sameSample(const FlowSample& a, const FlowSample& b) {
+    return a.directionX == b.directionX && a.directionY == b.directionY && a.speed == b.speed &&
+           a.edgeDistance == b.edgeDistance;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string trackFile = argc > 1 ? argv[1] : "tracks/track1.json";
+
+    Track track;
+    if (!track.load(trackFile)) {
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    FlowField full;
+    full.build(track);
+    double buildSeconds = secondsSince(start);
+
+    // Walls dropped along the inside of the first tile, 20 px apart
+    const int edits = 20;
+    const FlowField& patched = track.getFlowField();
+    const Tile first = track.getTiles().front();
+    double updateSeconds = 0.0;
+    size_t changedCells = 0, strayCells = 0;
+    for (int i = 0; i < edits; ++i) {
+        std::vector<FlowSample> before = cellsOf(patched);
+        Tile wall = { TileType::WALL, first.x + (i % 5) * 20.0f, first.y + (i / 5) * 20.0f, 10.0f, 10.0f, 0.0f };
+        start = std::chrono::steady_clock::now();
+        track.addTile(wall.type, wall.x, wall.y, wall.width, wall.height);
+        track.getFlowField();
+        updateSeconds += secondsSince(start) / edits;
+
+        std::vector<FlowSample> after = cellsOf(patched);
+        const float range = patched.getRefreshRange();
+        for (size_t cell = 0; cell < after.size(); ++cell) {
+            if (sameSample(before[cell], after[cell])) {
+                continue;
+            }
+            ++changedCells;
+            float x = patched.getOriginX() + (cell % patched.getColumns() + 0.5f) * patched.getCellSize();
+            float y = patched.getOriginY() + (cell / patched.getColumns() + 0.5f) * patched.getCellSize();
+            strayCells += x < wall.x - range || x > wall.x + wall.width + range ||
+                          y < wall.y - range || y > wall.y + wall.height + range;
+        }
+    }
+
+    FlowField rebuilt;
+    rebuilt.build(track);
+    std::vector<FlowSample> patchedCells = cellsOf(patched);
+    std::vector<FlowSample> rebuiltCells = cellsOf(rebuilt);
+    size_t differFromRebuild = 0;
+    for (size_t cell = 0; cell < patchedCells.size(); ++cell) {
+        differFromRebuild += !sameSample(patchedCells[cell], rebuiltCells[cell]);
+    }
+
+    // Steering cost per bot, spread over the track
+    const size_t botCount = 10000;
+    CarPool cars;
+    cars.reserve(botCount);
+    std::vector<std::unique_ptr<AIBot>> bots;
+    const auto& tiles = track.getTiles();
+    for (size_t i = 0; i < botCount; ++i) {
+        const Tile& tile = tiles[i % tiles.size()];
+        bots.push_back(std::make_unique<AIBot>(cars, tile.x + tile.width / 2, tile.y + tile.height / 2, 2));
+    }
+    const int ticks = 100;
+    const FlowField& field = track.getFlowField();
+    start = std::chrono::steady_clock::now();
+    for (int t = 0; t < ticks; ++t) {
+        for (auto& bot : bots) {
+            bot->steer(field);
+        }
+    }
+    double steerNs = secondsSince(start) * 1e9 / (static_cast<double>(botCount) * ticks);
+
+    std::printf("track:             %s\n", trackFile.c_str());
+    std::printf("grid:              %d x %d cells of %.0f px\n", full.getColumns(), full.getRows(), full.getCellSize());
+    std::printf("full build:        %.3f ms\n", buildSeconds * 1e3);
+    std::printf("refresh per edit:  %.3f ms, %.0f px round the tile\n", updateSeconds * 1e3,
+                patched.getRefreshRange());
+    std::printf("cells changed:     %zu, %zu outside the refresh range\n", changedCells, strayCells);
+    std::printf("differ from build: %zu of %zu cells\n", differFromRebuild, patchedCells.size());
+    std::printf("steer per bot:     %.1f ns\n", steerNs);
+
+    return strayCells == 0 ? 0 : 1;
+}
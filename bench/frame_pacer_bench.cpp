@@ -0,0 +1,90 @@
+// Frame pacing benchmark: a main loop doing a fixed amount of busy work per
+// frame, ended the old way (a 1 ms sleep, otherwise uncapped) and by
+// FramePacer at a few target rates and uncapped.
+//
+// Reports achieved frame rate, frame time p50/p99/max, how far the p50
+// lands from the target, and CPU use as process time over wall time, so
+// latency and CPU cost can be compared directly.
+//
+//   frame_pacer_bench [work ms] [seconds per run]
+
+#include "frame_pacer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Stands in for update and render
+void busyWork(double milliseconds) {
+    auto until = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(milliseconds));
+    while (Clock::now() < until) {
+    }
+}
+
+struct Run {
+    double fps;
+    double cpuPercent;
+    FrameTimeStats frames;
+};
+
+// endFrame ends each frame; pacer only records the frame times
+template <typename EndFrame>
+Run runLoop(FramePacer& pacer, double workMs, double seconds, EndFrame endFrame) {
+    pacer.resetStats();
+    size_t frameCount = 0;
+    std::clock_t cpuStart = std::clock();
+    auto start = Clock::now();
+    while (std::chrono::duration<double>(Clock::now() - start).count() < seconds) {
+        busyWork(workMs);
+        endFrame();
+        ++frameCount;
+    }
+    double wall = std::chrono::duration<double>(Clock::now() - start).count();
+    double cpu = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    return { frameCount / wall, cpu / wall * 100.0, pacer.getStats() };
+}
+
+void print(const char* name, double targetFps, const Run& run) {
+    char error[32] = "-";
+    if (targetFps > 0.0) {
+        std::snprintf(error, sizeof(error), "%+.3f", run.frames.p50 - 1000.0 / targetFps);
+    }
+    std::printf("%-20s %9.1f %9.3f %9.3f %9.3f %10s %8zu %7.1f%%\n", name, run.fps,
+                run.frames.p50, run.frames.p99, run.frames.max, error, run.frames.hitches, run.cpuPercent);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double workMs = argc > 1 ? std::atof(argv[1]) : 2.0;
+    double seconds = argc > 2 ? std::atof(argv[2]) : 2.0;
+
+    std::printf("%.1f ms of work per frame, %.1f s per run\n\n", workMs, seconds);
+    std::printf("%-20s %9s %9s %9s %9s %10s %8s %8s\n",
+                "", "fps", "p50 ms", "p99 ms", "max ms", "p50 error", "hitches", "cpu");
+
+    // The loop Game and Editor used to run: sleep 1 ms, then go again
+    FramePacer recorder(0.0);
+    print("sleep 1 ms", 0.0, runLoop(recorder, workMs, seconds, [&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        recorder.endFrame();
+    }));
+
+    for (double fps : { 30.0, 60.0, 144.0, 240.0 }) {
+        FramePacer pacer(fps);
+        char name[32];
+        std::snprintf(name, sizeof(name), "paced %.0f fps", fps);
+        print(name, fps, runLoop(pacer, workMs, seconds, [&]() { pacer.endFrame(); }));
+        std::printf("%-20s spin margin settled at %.3f ms\n", "", pacer.getSpinMargin());
+    }
+
+    FramePacer uncapped(0.0);
+    print("uncapped", 0.0, runLoop(uncapped, workMs, seconds, [&]() { uncapped.endFrame(); }));
+    return 0;
+}
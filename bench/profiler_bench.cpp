@@ -0,0 +1,94 @@
+// Profiler overhead benchmark: a small loop body run bare, inside a zone
+// with the profiler disabled at run time, and inside a recording zone, on
+// one thread and on several at once. The bare loop is what a build with
+// ENABLE_PROFILER=OFF compiles to.
+//
+// Reports ns per iteration and the added cost per zone, then writes the
+// recorded zones as a Chrome trace to check the dump.
+//
+//   profiler_bench [iterations] [threads] [trace path]
+
+#include "profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Roughly the size of the smallest zoned function, so the overhead shows
+volatile float sink;
+
+void body(int i) {
+    float x = static_cast<float>(i);
+    for (int k = 0; k < 8; ++k) {
+        x = x * 1.0001f + 0.5f;
+    }
+    sink = x;
+}
+
+double nsPerIteration(long iterations, bool zoned) {
+    auto start = std::chrono::steady_clock::now();
+    if (zoned) {
+        for (long i = 0; i < iterations; ++i) {
+            Profiler::Zone zone("body");
+            body(static_cast<int>(i));
+        }
+    } else {
+        for (long i = 0; i < iterations; ++i) {
+            body(static_cast<int>(i));
+        }
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+// Every thread records at once, as the job system's workers do
+double nsPerIterationThreaded(long iterations, unsigned threadCount) {
+    std::vector<double> results(threadCount);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&results, t, iterations]() { results[t] = nsPerIteration(iterations, true); });
+    }
+    double worst = 0.0;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        threads[t].join();
+        worst = std::max(worst, results[t]);
+    }
+    return worst;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? std::atol(argv[1]) : 10000000;
+    unsigned threadCount = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 4;
+    const char* tracePath = argc > 3 ? argv[3] : "profiler_bench_trace.json";
+
+    nsPerIteration(iterations / 10, false); // Warm up
+
+    double bare = nsPerIteration(iterations, false);
+    Profiler::setEnabled(false);
+    double disabled = nsPerIteration(iterations, true);
+    Profiler::setEnabled(true);
+    double recording = nsPerIteration(iterations, true);
+    double threaded = nsPerIterationThreaded(iterations, threadCount);
+    Profiler::setEnabled(false);
+
+    std::printf("%ld iterations\n\n", iterations);
+    std::printf("%-28s %10s %12s\n", "", "ns/iter", "ns per zone");
+    std::printf("%-28s %10.2f %12s\n", "no zone (compiled out)", bare, "-");
+    std::printf("%-28s %10.2f %12.2f\n", "zone, profiler disabled", disabled, disabled - bare);
+    std::printf("%-28s %10.2f %12.2f\n", "zone, recording", recording, recording - bare);
+    char name[32];
+    std::snprintf(name, sizeof(name), "zone, recording x%u threads", threadCount);
+    std::printf("%-28s %10.2f %12.2f\n", name, threaded, threaded - bare);
+
+    // Each thread keeps its last EVENTS_PER_THREAD zones
+    if (!Profiler::writeTrace(tracePath)) {
+        std::fprintf(stderr, "failed to write %s\n", tracePath);
+        return 1;
+    }
+    std::printf("\ntrace: %s (up to %zu zones per thread)\n", tracePath, Profiler::EVENTS_PER_THREAD);
+    return 0;
+}
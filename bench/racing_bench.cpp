@@ -0,0 +1,516 @@
+// Regression benchmark suite for the core game code, in the manner of
+// Google Benchmark: every case runs as name/size over procedurally
+// generated tracks of 10 to 1M tiles, repeating its loop until a minimum
+// time has passed, and results print as a table and optionally as JSON in
+// Google Benchmark's schema, so runs from two builds can be diffed with
+// its compare.py or any JSON tool.
+//
+//   racing_bench [--filter TEXT] [--min-time SECONDS] [--max-tiles N] [--json FILE]
+
+#include "track.h"
+#include "car_pool.h"
+#include "car.h"
+#include "ai_bot.h"
+#include "physics.h"
+#include "input.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr float TILE_SIZE = 50.0f;
+constexpr float TICK_SECONDS = 1.0f / 120.0f;
+
+// Per-case timing state. The timed region is the body's keepRunning() loop,
+// so setup before it is not measured.
+class State {
+public:
+    State(int64_t arg, double minSeconds) : arg(arg), minSeconds(minSeconds) {}
+
+    bool keepRunning() {
+        if (iterations == 0) {
+            start = std::chrono::steady_clock::now();
+        } else if ((iterations & (iterations - 1)) == 0 && elapsedSeconds() >= minSeconds) {
+            // Clock checked on powers of two only, to stay out of the loop
+            end = std::chrono::steady_clock::now();
+            return false;
+        }
+        ++iterations;
+        return true;
+    }
+
+    int64_t range() const { return arg; }
+    void setItemsPerIteration(int64_t items) { itemsPerIteration = items; }
+    void skip(const std::string& why) { skipped = why; }
+
+    int64_t getIterations() const { return iterations; }
+    double getSeconds() const { return std::chrono::duration<double>(end - start).count(); }
+    int64_t getItemsPerIteration() const { return itemsPerIteration; }
+    const std::string& getSkipped() const { return skipped; }
+
+private:
+    int64_t arg;
+    double minSeconds;
+    int64_t iterations = 0;
+    int64_t itemsPerIteration = 1;
+    std::string skipped;
+    std::chrono::steady_clock::time_point start, end;
+
+    double elapsedSeconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+struct Benchmark {
+    const char* name;
+    void (*body)(State&);
+    std::vector<int64_t> args;
+};
+
+const std::vector<int64_t> TRACK_SIZES = { 10, 100, 1000, 10000, 100000, 1000000 };
+
+// Results are passed here so the measured loops can't be optimised away
+volatile const void* sink;
+
+template <typename T>
+void doNotOptimize(const T& value) {
+    sink = &value;
+}
+
+struct Throttle : Input {
+    bool isForward() const override { return true; }
+    bool isBackward() const override { return false; }
+    bool isLeft() const override { return true; }
+    bool isRight() const override { return false; }
+};
+
+// Square grid of 50 px tiles: mostly track, with walls, jumps and grass
+// mixed in so every query path is exercised. Turned by angle degrees
+// about their centres when it is not 0.
+void buildTrack(Track& track, int64_t tileCount, float angle = 0.0f) {
+    track.clear();
+    int64_t side = static_cast<int64_t>(std::ceil(std::sqrt(static_cast<double>(tileCount))));
+    int64_t placed = 0;
+    for (int64_t row = 0; row < side && placed < tileCount; ++row) {
+        for (int64_t col = 0; col < side && placed < tileCount; ++col, ++placed) {
+            TileType type = TileType::TRACK;
+            if ((row * 7 + col * 3) % 11 == 0) {
+                type = TileType::WALL;
+            } else if ((row + col) % 13 == 0) {
+                type = TileType::JUMP;
+            } else if ((row * col) % 17 == 5) {
+                type = TileType::GRASS;
+            }
+            track.addTile(type, col * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE, angle);
+        }
+    }
+}
+
+// PLACED leaves the tiles as addTile() put them; MERGED and ROTATED are
+// merged, with the surface map, as loading leaves a track
+enum class Layout { PLACED, MERGED, ROTATED };
+
+// Generated once per size and layout and shared by the cases that leave
+// the tiles alone
+Track& sharedTrack(int64_t tileCount, Layout layout = Layout::PLACED) {
+    static std::map<std::pair<int64_t, Layout>, std::unique_ptr<Track>> tracks;
+    auto& track = tracks[{ tileCount, layout }];
+    if (!track) {
+        track = std::make_unique<Track>();
+        buildTrack(*track, tileCount, layout == Layout::ROTATED ? 30.0f : 0.0f);
+        if (layout != Layout::PLACED) {
+            track->mergeTiles();
+        }
+    }
+    return *track;
+}
+
+float trackExtent(int64_t tileCount) {
+    return static_cast<float>(std::ceil(std::sqrt(static_cast<double>(tileCount)))) * TILE_SIZE;
+}
+
+// Points spread over the track, cycled through by the query cases
+std::vector<Point2D> samplePoints(int64_t tileCount, size_t count = 4096) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coord(-TILE_SIZE, trackExtent(tileCount) + TILE_SIZE);
+    std::vector<Point2D> points(count);
+    for (auto& point : points) {
+        point = { coord(rng), coord(rng) };
+    }
+    return points;
+}
+
+std::string tempPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+void carUpdate(State& state) {
+    CarPool pool;
+    std::vector<Car> cars;
+    for (int64_t i = 0; i < state.range(); ++i) {
+        cars.push_back(pool.add((i % 64) * 40.0f, (i / 64) * 40.0f, 255, 0, 0));
+    }
+    Throttle input;
+    while (state.keepRunning()) {
+        for (Car& car : cars) {
+            car.update(TICK_SECONDS, input);
+        }
+    }
+    doNotOptimize(pool.getPositionsX());
+    state.setItemsPerIteration(state.range());
+}
+
+void trackIsOnTrack(State& state) {
+    const Track& track = sharedTrack(state.range());
+    std::vector<Point2D> points = samplePoints(state.range());
+    size_t next = 0;
+    int onTrack = 0;
+    while (state.keepRunning()) {
+        const Point2D& point = points[next++ & (points.size() - 1)];
+        onTrack += track.isOnTrack(point.x, point.y);
+    }
+    doNotOptimize(onTrack);
+}
+
+void trackIsOnTrackRotated(State& state) {
+    const Track& track = sharedTrack(state.range(), Layout::ROTATED);
+    std::vector<Point2D> points = samplePoints(state.range());
+    size_t next = 0;
+    int onTrack = 0;
+    while (state.keepRunning()) {
+        const Point2D& point = points[next++ & (points.size() - 1)];
+        onTrack += track.isOnTrack(point.x, point.y);
+    }
+    doNotOptimize(onTrack);
+}
+
+void trackSurfaceAt(State& state) {
+    const Track& track = sharedTrack(state.range(), Layout::MERGED);
+    std::vector<Point2D> points = samplePoints(state.range());
+    size_t next = 0;
+    int surfaces = 0;
+    while (state.keepRunning()) {
+        const Point2D& point = points[next++ & (points.size() - 1)];
+        surfaces += static_cast<int>(track.surfaceAt(point.x, point.y));
+    }
+    doNotOptimize(surfaces);
+}
+
+void trackMergeTiles(State& state) {
+    Track track;
+    buildTrack(track, state.range());
+    size_t drawTiles = 0;
+    while (state.keepRunning()) {
+        drawTiles += track.mergeTiles().drawTiles;
+    }
+    doNotOptimize(drawTiles);
+    state.setItemsPerIteration(state.range());
+}
+
+void trackCheckCollisions(State& state) {
+    Track& track = sharedTrack(state.range());
+    std::vector<Point2D> points = samplePoints(state.range());
+    CarPool pool;
+    Car car = pool.add(0.0f, 0.0f, 255, 0, 0);
+    size_t next = 0;
+    while (state.keepRunning()) {
+        const Point2D& point = points[next++ & (points.size() - 1)];
+        // One tick's move ending at the point
+        car.setPosition(point.x - 120.0f * TICK_SECONDS, point.y + 80.0f * TICK_SECONDS);
+        car.beginTick();
+        car.setPosition(point.x, point.y);
+        car.setVelocity(120.0f, -80.0f);
+        track.checkCollisions(car, TICK_SECONDS);
+    }
+    doNotOptimize(car.getX());
+}
+
+void aiBotUpdate(State& state) {
+    const int botCount = 64;
+    Track& track = sharedTrack(state.range());
+    track.getFlowField(); // Built up front, outside the timed loop
+
+    CarPool pool;
+    pool.reserve(botCount);
+    std::vector<Point2D> starts = samplePoints(state.range(), botCount);
+    std::vector<std::unique_ptr<AIBot>> bots;
+    for (const Point2D& start : starts) {
+        bots.push_back(std::make_unique<AIBot>(pool, start.x, start.y, 1));
+    }
+    while (state.keepRunning()) {
+        for (auto& bot : bots) {
+            bot->update(TICK_SECONDS, track);
+        }
+    }
+    doNotOptimize(pool.getPositionsX());
+    state.setItemsPerIteration(botCount);
+}
+
+void trackSaveToFile(State& state) {
+    Track track;
+    buildTrack(track, state.range());
+    const std::string path = tempPath("racing_bench_save.json");
+    bool ok = true;
+    while (state.keepRunning()) {
+        ok &= track.saveToFile(path);
+    }
+    std::filesystem::remove(path);
+    if (!ok) {
+        state.skip("save failed");
+    }
+    state.setItemsPerIteration(state.range());
+}
+
+void trackLoadFromFile(State& state) {
+    const std::string path = tempPath("racing_bench_load.json");
+    {
+        Track source;
+        buildTrack(source, state.range());
+        if (!source.saveToFile(path)) {
+            state.skip("could not write the track");
+            return;
+        }
+    }
+    Track track;
+    bool ok = true;
+    while (state.keepRunning()) {
+        ok &= track.loadFromFile(path);
+    }
+    std::filesystem::remove(path);
+    if (!ok || track.getTiles().size() != static_cast<size_t>(state.range())) {
+        state.skip("load failed");
+    }
+    state.setItemsPerIteration(state.range());
+}
+
+void trackLoadCompiled(State& state) {
+    const std::string path = tempPath("racing_bench_load.trk");
+    {
+        Track source;
+        buildTrack(source, state.range());
+        if (!source.saveCompiled(path)) {
+            state.skip("could not write the track");
+            return;
+        }
+    }
+    Track track;
+    bool ok = true;
+    while (state.keepRunning()) {
+        ok &= track.loadCompiled(path);
+    }
+    std::filesystem::remove(path);
+    if (!ok || track.getTiles().size() != static_cast<size_t>(state.range())) {
+        state.skip("load failed");
+    }
+    state.setItemsPerIteration(state.range());
+}
+
+// The Physics helpers over a batch of car-sized pairs
+struct Pairs {
+    std::vector<float> x1, y1, x2, y2;
+    explicit Pairs(int64_t count) {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> coord(0.0f, 200.0f);
+        for (int64_t i = 0; i < count; ++i) {
+            x1.push_back(coord(rng));
+            y1.push_back(coord(rng));
+            x2.push_back(coord(rng));
+            y2.push_back(coord(rng));
+        }
+    }
+};
+
+void physicsCircleCollision(State& state) {
+    Pairs pairs(state.range());
+    int hits = 0;
+    while (state.keepRunning()) {
+        for (size_t i = 0; i < pairs.x1.size(); ++i) {
+            hits += Physics::circleCollision(pairs.x1[i], pairs.y1[i], 12.0f, pairs.x2[i], pairs.y2[i], 12.0f);
+        }
+    }
+    doNotOptimize(hits);
+    state.setItemsPerIteration(state.range());
+}
+
+void physicsRectCollision(State& state) {
+    Pairs pairs(state.range());
+    int hits = 0;
+    while (state.keepRunning()) {
+        for (size_t i = 0; i < pairs.x1.size(); ++i) {
+            hits += Physics::rectCollision(pairs.x1[i], pairs.y1[i], 24.0f, 14.0f,
+                                           pairs.x2[i], pairs.y2[i], 50.0f, 50.0f);
+        }
+    }
+    doNotOptimize(hits);
+    state.setItemsPerIteration(state.range());
+}
+
+void physicsDistance(State& state) {
+    Pairs pairs(state.range());
+    float total = 0.0f;
+    while (state.keepRunning()) {
+        for (size_t i = 0; i < pairs.x1.size(); ++i) {
+            total += Physics::distance(pairs.x1[i], pairs.y1[i], pairs.x2[i], pairs.y2[i]);
+        }
+    }
+    doNotOptimize(total);
+    state.setItemsPerIteration(state.range());
+}
+
+void physicsNormalize(State& state) {
+    Pairs pairs(state.range());
+    float total = 0.0f;
+    while (state.keepRunning()) {
+        for (size_t i = 0; i < pairs.x1.size(); ++i) {
+            float x = pairs.x1[i] - pairs.x2[i];
+            float y = pairs.y1[i] - pairs.y2[i];
+            Physics::normalize(x, y);
+            total += x + y;
+        }
+    }
+    doNotOptimize(total);
+    state.setItemsPerIteration(state.range());
+}
+
+const Benchmark BENCHMARKS[] = {
+    { "Car::update", carUpdate, { 1, 64, 1024, 16384 } },
+    { "Track::isOnTrack", trackIsOnTrack, TRACK_SIZES },
+    { "Track::isOnTrackRotated", trackIsOnTrackRotated, TRACK_SIZES },
+    { "Track::surfaceAt", trackSurfaceAt, TRACK_SIZES },
+    { "Track::mergeTiles", trackMergeTiles, TRACK_SIZES },
+    { "Track::checkCollisions", trackCheckCollisions, TRACK_SIZES },
+    { "AIBot::update", aiBotUpdate, TRACK_SIZES },
+    { "Track::saveToFile", trackSaveToFile, TRACK_SIZES },
+    { "Track::loadFromFile", trackLoadFromFile, TRACK_SIZES },
+    { "Track::loadCompiled", trackLoadCompiled, TRACK_SIZES },
+    { "Physics::circleCollision", physicsCircleCollision, { 1024 } },
+    { "Physics::rectCollision", physicsRectCollision, { 1024 } },
+    { "Physics::distance", physicsDistance, { 1024 } },
+    { "Physics::normalize", physicsNormalize, { 1024 } },
+};
+
+// Cases whose size is a tile count, limited by --max-tiles
+bool isTrackCase(const Benchmark& benchmark) {
+    return std::strncmp(benchmark.name, "Track::", 7) == 0 || std::strncmp(benchmark.name, "AIBot::", 7) == 0;
+}
+
+std::string formatTime(double nanoseconds) {
+    char text[32];
+    if (nanoseconds >= 1e9) {
+        std::snprintf(text, sizeof(text), "%.2f s", nanoseconds / 1e9);
+    } else if (nanoseconds >= 1e6) {
+        std::snprintf(text, sizeof(text), "%.2f ms", nanoseconds / 1e6);
+    } else if (nanoseconds >= 1e3) {
+        std::snprintf(text, sizeof(text), "%.2f us", nanoseconds / 1e3);
+    } else {
+        std::snprintf(text, sizeof(text), "%.1f ns", nanoseconds);
+    }
+    return text;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    std::string jsonPath;
+    double minSeconds = 0.5;
+    int64_t maxTiles = 1000000;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-tiles") == 0 && i + 1 < argc) {
+            maxTiles = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            std::fprintf(stderr, "Usage: racing_bench [--filter TEXT] [--min-time SECONDS] "
+                                 "[--max-tiles N] [--json FILE]\n");
+            return 1;
+        }
+    }
+
+    nlohmann::json results = nlohmann::json::array();
+    std::printf("%-36s %14s %14s %12s %14s\n", "Benchmark", "Time", "Per item", "Iterations", "Items/s");
+    std::printf("%s\n", std::string(94, '-').c_str());
+
+    for (const Benchmark& benchmark : BENCHMARKS) {
+        for (int64_t arg : benchmark.args) {
+            if (isTrackCase(benchmark) && arg > maxTiles) {
+                continue;
+            }
+            std::string name = std::string(benchmark.name) + "/" + std::to_string(arg);
+            if (!filter.empty() && name.find(filter) == std::string::npos) {
+                continue;
+            }
+
+            State state(arg, minSeconds);
+            benchmark.body(state);
+            if (!state.getSkipped().empty() || state.getIterations() == 0) {
+                std::printf("%-36s skipped: %s\n", name.c_str(), state.getSkipped().c_str());
+                continue;
+            }
+
+            double nsPerIteration = state.getSeconds() * 1e9 / state.getIterations();
+            double itemsPerSecond = state.getIterations() * static_cast<double>(state.getItemsPerIteration()) /
+                                    state.getSeconds();
+            std::printf("%-36s %14s %14s %12lld %14.4g\n", name.c_str(), formatTime(nsPerIteration).c_str(),
+                        formatTime(nsPerIteration / state.getItemsPerIteration()).c_str(),
+                        static_cast<long long>(state.getIterations()), itemsPerSecond);
+            std::fflush(stdout);
+
+            results.push_back({
+                { "name", name },
+                { "run_name", name },
+                { "run_type", "iteration" },
+                { "iterations", state.getIterations() },
+                { "real_time", nsPerIteration },
+                { "cpu_time", nsPerIteration },
+                { "time_unit", "ns" },
+                { "items_per_second", itemsPerSecond },
+            });
+        }
+    }
+
+    if (!jsonPath.empty()) {
+        char date[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+        nlohmann::json report = {
+            { "context", {
+                { "date", date },
+                { "executable", argv[0] },
+                { "num_cpus", std::thread::hardware_concurrency() },
+#ifdef NDEBUG
+                { "library_build_type", "release" },
+#else
+                { "library_build_type", "debug" },
+#endif
+            } },
+            { "benchmarks", results },
+        };
+        std::ofstream out(jsonPath);
+        out << report.dump(2) << "\n";
+        if (!out) {
+            std::fprintf(stderr, "failed to write %s\n", jsonPath.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
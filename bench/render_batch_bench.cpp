@@ -0,0 +1,141 @@
+// Render batching benchmark: a frame of a 100k-tile track drawn into the
+// software renderer one SDL call per primitive, against the same frame
+// batched through SDL_RenderGeometry.
+//
+// Reports draw calls and milliseconds per frame for both, and compares the
+// two images pixel by pixel, once with the camera on whole pixels and once
+// between them.
+//
+//   render_batch_bench [tiles] [frames]
+
+#include "track.h"
+#include "camera.h"
+#include "car_pool.h"
+#include "renderer.h"
+#include "bench_util.h"
+#include <SDL3/SDL.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const int WIDTH = 1280;
+const int HEIGHT = 1280;
+const float TILE_SIZE = 4.0f;
+
+// Square-ish field of small tiles filling the surface, mostly road with
+// bands of grass and wall, so both fills and outlines are exercised
+void buildTrack(Track& track, int tileCount) {
+    int side = 1;
+    while (side * side < tileCount) {
+        ++side;
+    }
+    for (int i = 0; i < tileCount; ++i) {
+        int cx = i % side;
+        int cy = i / side;
+        TileType type = TileType::TRACK;
+        if (cy % 17 == 0) {
+            type = TileType::GRASS;
+        } else if (cx % 23 == 0) {
+            type = TileType::WALL;
+        } else if (i == 0) {
+            type = TileType::START_FINISH;
+        }
+        track.addTile(type, cx * TILE_SIZE, cy * TILE_SIZE, TILE_SIZE, TILE_SIZE);
+    }
+}
+
+void drawFrame(Renderer& renderer, SDL_Renderer* sdl, Track& track, CarPool& cars, const Camera& camera) {
+    SDL_SetRenderDrawColor(sdl, 20, 20, 20, 255);
+    SDL_RenderClear(sdl);
+    track.render(renderer, camera);
+    for (size_t i = 0; i < cars.size(); ++i) {
+        Car car(cars, static_cast<uint32_t>(i));
+        car.render(renderer, camera, 1.0f);
+        renderer.drawCircle(car.getX() - camera.getX(), car.getY() - camera.getY(), 5, 255, 255, 0);
+    }
+    renderer.flush();
+    renderer.renderText("Lap: 1/3", 10, 10, 255, 255, 255);
+    renderer.flush();
+    SDL_RenderPresent(sdl);
+}
+
+struct FrameResult {
+    double milliseconds;
+    size_t drawCalls;
+    SDL_Surface* image;
+};
+
+FrameResult measure(Renderer& renderer, SDL_Renderer* sdl, Track& track, CarPool& cars,
+                    const Camera& camera, bool batching, int frames) {
+    renderer.setBatching(batching);
+    drawFrame(renderer, sdl, track, cars, camera); // Warm-up, sizes the batch buffers
+
+    renderer.resetDrawCalls();
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        drawFrame(renderer, sdl, track, cars, camera);
+    }
+    double seconds = secondsSince(start);
+
+    FrameResult result;
+    result.milliseconds = seconds * 1e3 / frames;
+    result.drawCalls = renderer.getDrawCalls() / frames;
+    result.image = SDL_RenderReadPixels(sdl, nullptr);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int tileCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    SDL_Surface* surface = SDL_CreateSurface(WIDTH, HEIGHT, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* sdl = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!sdl) {
+        std::fprintf(stderr, "software renderer unavailable: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    Track track;
+    buildTrack(track, tileCount);
+
+    CarPool cars;
+    for (int i = 0; i < 1000; ++i) {
+        Car car = cars.add(40.0f + (i % 40) * 30.0f, 40.0f + (i / 40) * 45.0f, 200, (i * 37) % 256, 60);
+        car.setAngle(i * 0.1f);
+    }
+
+    Renderer renderer(sdl);
+    Camera camera(WIDTH, HEIGHT);
+
+    std::printf("tiles: %d, cars: %zu, %dx%d software surface, %d frames\n\n",
+                tileCount, cars.size(), WIDTH, HEIGHT, frames);
+    std::printf("%-12s %14s %14s %12s %12s %16s\n",
+                "camera", "calls (immed)", "calls (batch)", "ms (immed)", "ms (batch)", "differing px");
+
+    bool identical = true;
+    const float offsets[2] = { 0.0f, 0.37f };
+    for (float offset : offsets) {
+        // setPosition centres the view; this puts the top-left at (-8, -8)
+        camera.setPosition(WIDTH / 2 - 8.0f - offset, HEIGHT / 2 - 8.0f - offset);
+        FrameResult immediate = measure(renderer, sdl, track, cars, camera, false, frames);
+        FrameResult batched = measure(renderer, sdl, track, cars, camera, true, frames);
+        size_t differing = differingPixels(immediate.image, batched.image);
+        identical = identical && differing == 0;
+
+        std::printf("%-12s %14zu %14zu %12.2f %12.2f %16zu\n",
+                    offset == 0.0f ? "whole px" : "sub-pixel",
+                    immediate.drawCalls, batched.drawCalls,
+                    immediate.milliseconds, batched.milliseconds, differing);
+
+        SDL_DestroySurface(immediate.image);
+        SDL_DestroySurface(batched.image);
+    }
+
+    SDL_DestroyRenderer(sdl);
+    SDL_DestroySurface(surface);
+    return identical ? 0 : 1;
+}
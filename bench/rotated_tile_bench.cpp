@@ -0,0 +1,297 @@
+// Rotated tile benchmark: the same course laid out with every tile square
+// to the axes and with every tile turned, timed through Track::isOnTrack,
+// Track::surfaceAt, Track::checkCollisions and Track::render. The share of
+// surface map cells a tile edge crosses is shown too, since slanted edges
+// cross more of them and those cells fall back to the tiles.
+//
+// Tiles sit apart on a fixed pitch, so merging leaves them alone and both
+// layouts have the same tile count. Answers are checked against a
+// double-precision reference built from each tile's corners, points right
+// on an edge aside; after every collision the car must be clear of all
+// walls, and fast cars fired at thin turned walls must not get through.
+//
+//   rotated_tile_bench [course side in tiles] [angle in degrees] [frames]
+
+#include "track.h"
+#include "car.h"
+#include "camera.h"
+#include "renderer.h"
+#include "bench_util.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int WIDTH = 1280;
+const int HEIGHT = 720;
+const float PITCH = 60.0f;
+const float TILE_SIZE = 40.0f;
+const int QUERIES = 1000000;
+const int CARS = 100000;
+const float TICK_SECONDS = 1.0f / 120.0f;
+
+// Mostly road, with walls, jumps and checkpoints scattered through it.
+// 40 px tiles on a 60 px pitch never touch at any angle.
+std::vector<Tile> buildScattered(int side, float angle) {
+    std::vector<Tile> tiles;
+    for (int row = 0; row < side; ++row) {
+        for (int col = 0; col < side; ++col) {
+            TileType type = TileType::TRACK;
+            if ((row * 7 + col * 3) % 5 == 0) {
+                type = TileType::WALL;
+            } else if ((row + col) % 13 == 0) {
+                type = TileType::JUMP;
+            } else if ((row * col) % 17 == 5) {
+                type = TileType::CHECKPOINT;
+            }
+            float width = TILE_SIZE - (col % 3) * 8.0f;
+            tiles.push_back({ type, col * PITCH, row * PITCH, width, TILE_SIZE, angle });
+        }
+    }
+    return tiles;
+}
+
+// Offsets from a tile's centre along its own axes, in double precision
+struct Local {
+    double x, y, halfWidth, halfHeight;
+};
+
+Local localTo(const Tile& tile, double x, double y) {
+    const double radians = tile.angle * 3.14159265358979323846 / 180.0;
+    const double c = std::cos(radians), s = std::sin(radians);
+    const double dx = x - (tile.x + tile.width / 2.0);
+    const double dy = y - (tile.y + tile.height / 2.0);
+    return { dx * c + dy * s, dy * c - dx * s, tile.width / 2.0, tile.height / 2.0 };
+}
+
+// Signed distance outside the tile: negative inside
+double outside(const Tile& tile, double x, double y) {
+    Local l = localTo(tile, x, y);
+    double qx = std::fabs(l.x) - l.halfWidth;
+    double qy = std::fabs(l.y) - l.halfHeight;
+    double ox = std::max(qx, 0.0), oy = std::max(qy, 0.0);
+    return std::sqrt(ox * ox + oy * oy) + std::min(std::max(qx, qy), 0.0);
+}
+
+// Reference surface by the map's precedence, or -1 when the point is too
+// close to an edge for float and double to be sure to agree
+int referenceSurface(const std::vector<Tile>& tiles, float x, float y) {
+    static const int rank[] = { 0, 1, 2, 3, 4, -1 }; // By TileType; walls apart
+    int best = -1;
+    bool wall = false;
+    for (const Tile& tile : tiles) {
+        double d = outside(tile, x, y);
+        if (std::fabs(d) < 1e-3) {
+            return -1;
+        }
+        if (d < 0.0) {
+            if (tile.type == TileType::WALL) {
+                wall = true;
+            } else if (isDrivable(tile.type) &&
+                       (best < 0 || rank[static_cast<int>(tile.type)] > rank[best])) {
+                best = static_cast<int>(tile.type);
+            }
+        }
+    }
+    if (best >= 0) {
+        return best;
+    }
+    return static_cast<int>(wall ? TileType::WALL : TileType::GRASS);
+}
+
+struct Shot {
+    float x, y, vx, vy;
+};
+
+double timeRender(SDL_Renderer* sdl, Renderer& renderer, const Track& track, float extent, int frames) {
+    Camera camera(WIDTH, HEIGHT);
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        float t = static_cast<float>(f) / frames;
+        camera.setPosition(WIDTH / 2 + t * std::max(0.0f, extent - WIDTH),
+                           HEIGHT / 2 + t * std::max(0.0f, extent - HEIGHT));
+        SDL_SetRenderDrawColor(sdl, 20, 20, 20, 255);
+        SDL_RenderClear(sdl);
+        track.render(renderer, camera);
+        renderer.flush();
+        SDL_RenderPresent(sdl);
+    }
+    return secondsSince(start) * 1e3 / frames;
+}
+
+struct Result {
+    double onTrackNs, exactOnTrackNs, surfaceNs, collideNs, renderMs, mixedPercent;
+    size_t mismatches, checked, contacts, stuck;
+};
+
+Result run(int side, float angle, SDL_Renderer* sdl, Renderer* renderer, int frames) {
+    const std::vector<Tile> tiles = buildScattered(side, angle);
+    Track track;
+    addAll(track, tiles);
+    track.mergeTiles();
+    const float extent = side * PITCH;
+    Result result = {};
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> across(-PITCH, extent + PITCH);
+    std::vector<float> points;
+    points.reserve(2 * QUERIES);
+    for (int i = 0; i < QUERIES; ++i) {
+        points.push_back(across(rng));
+        points.push_back(across(rng));
+    }
+
+    // Reference answers from the tiles near each point only
+    SpatialGrid grid;
+    grid.build(tiles);
+    std::vector<Tile> near;
+    for (int i = 0; i < QUERIES; i += 7) {
+        float x = points[2 * i], y = points[2 * i + 1];
+        near.clear();
+        grid.visitRect(x - 1.0f, y - 1.0f, x + 1.0f, y + 1.0f, [&](uint32_t index) { near.push_back(tiles[index]); });
+        int expected = referenceSurface(near, x, y);
+        if (expected < 0) {
+            continue;
+        }
+        ++result.checked;
+        result.mismatches += static_cast<int>(track.surfaceAt(x, y)) != expected;
+        result.mismatches += track.isOnTrack(x, y) != isDrivable(static_cast<TileType>(expected));
+    }
+
+    const SurfaceMap& map = track.getSurfaceMap();
+    size_t cells = map.getBlockCount() * SurfaceMap::BLOCK_SIZE * SurfaceMap::BLOCK_SIZE;
+    result.mixedPercent = 100.0 * map.getMixedCellCount() / std::max<size_t>(1, cells);
+
+    size_t checksum = 0;
+    result.onTrackNs = timeQueries(points, [&](float x, float y) { return track.isOnTrack(x, y); }, checksum);
+    result.surfaceNs = timeQueries(points, [&](float x, float y) { return track.surfaceAt(x, y); }, checksum);
+    track.setSurfaceCellSize(0.0f);
+    track.mergeTiles();
+    result.exactOnTrackNs = timeQueries(points, [&](float x, float y) { return track.isOnTrack(x, y); }, checksum);
+
+    // One tick of cars at up to 1200 px/s in every direction, each left
+    // wherever checkCollisions puts it and then checked against every wall
+    std::uniform_real_distribution<float> speed(-1200.0f, 1200.0f);
+    std::vector<Shot> shots(CARS);
+    for (Shot& shot : shots) {
+        do {
+            shot = { across(rng), across(rng), speed(rng), speed(rng) };
+            near.clear();
+            grid.visitRect(shot.x - 12.0f, shot.y - 12.0f, shot.x + 12.0f, shot.y + 12.0f,
+                           [&](uint32_t index) { near.push_back(tiles[index]); });
+        } while (std::any_of(near.begin(), near.end(), [&](const Tile& tile) {
+            return tile.type == TileType::WALL && outside(tile, shot.x, shot.y) < 12.5;
+        }));
+    }
+    CarPool pool;
+    Car car = pool.add(0, 0, 0, 0, 0);
+    auto launch = [&](const Shot& shot) {
+        car.setPosition(shot.x, shot.y);
+        car.beginTick();
+        car.setPosition(shot.x + shot.vx * TICK_SECONDS, shot.y + shot.vy * TICK_SECONDS);
+        car.setVelocity(shot.vx, shot.vy);
+    };
+    auto start = std::chrono::steady_clock::now();
+    for (const Shot& shot : shots) {
+        launch(shot);
+        result.contacts += track.checkCollisions(car, TICK_SECONDS).wallHits;
+    }
+    result.collideNs = secondsSince(start) * 1e9 / CARS;
+    for (const Shot& shot : shots) {
+        launch(shot);
+        track.checkCollisions(car, TICK_SECONDS);
+        near.clear();
+        grid.visitRect(car.getX() - 12.0f, car.getY() - 12.0f, car.getX() + 12.0f, car.getY() + 12.0f,
+                       [&](uint32_t index) { near.push_back(tiles[index]); });
+        result.stuck += std::any_of(near.begin(), near.end(), [&](const Tile& tile) {
+            return tile.type == TileType::WALL && outside(tile, car.getX(), car.getY()) < car.getRadius() - 0.01;
+        });
+    }
+
+    if (sdl && renderer) {
+        result.renderMs = timeRender(sdl, *renderer, track, extent, frames);
+    }
+    return result;
+}
+
+// Cars at 400 px/s in 0.1 s steps head straight at a 6 px wall turned by
+// angle, from random points along a line parallel to it
+int tunnelled(float angle) {
+    Track track;
+    track.addTile(TileType::WALL, 197.0f, 0.0f, 6.0f, 400.0f, angle);
+    const float radians = angle * 3.14159265f / 180.0f;
+    const float normalX = std::cos(radians), normalY = std::sin(radians);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> along(-150.0f, 150.0f);
+
+    CarPool pool;
+    Car car = pool.add(0, 0, 0, 0, 0);
+    int through = 0;
+    for (int i = 0; i < 1000; ++i) {
+        float offset = along(rng);
+        float x = 200.0f - normalX * 100.0f - normalY * offset;
+        float y = 200.0f - normalY * 100.0f + normalX * offset;
+        car.setPosition(x, y);
+        car.setVelocity(normalX * 400.0f, normalY * 400.0f);
+        for (int step = 0; step < 5; ++step) {
+            car.beginTick();
+            car.setPosition(car.getX() + car.getVelocityX() * 0.1f, car.getY() + car.getVelocityY() * 0.1f);
+            track.checkCollisions(car, 0.1f);
+        }
+        through += (car.getX() - 200.0f) * normalX + (car.getY() - 200.0f) * normalY > 0.0f;
+    }
+    return through;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 300;
+    float angle = argc > 2 ? static_cast<float>(std::atof(argv[2])) : 30.0f;
+    int frames = argc > 3 ? std::atoi(argv[3]) : 100;
+
+    SDL_Surface* surface = SDL_CreateSurface(WIDTH, HEIGHT, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* sdl = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!sdl) {
+        std::printf("software renderer unavailable (%s), not timing render\n\n", SDL_GetError());
+    }
+    std::unique_ptr<Renderer> renderer;
+    if (sdl) {
+        renderer = std::make_unique<Renderer>(sdl);
+    }
+
+    bool ok = true;
+    std::printf("course %dx%d tiles\n", side, side);
+    std::printf("%8s %8s %14s %14s %13s %13s %12s %10s %10s %10s\n", "angle", "mixed %", "isOnTrack ns",
+                "no map ns", "surfaceAt ns", "collide ns", "render ms", "contacts", "stuck", "mismatch");
+    for (float a : { 0.0f, angle }) {
+        Result r = run(side, a, sdl, renderer.get(), frames);
+        std::printf("%8.1f %8.2f %14.1f %14.1f %13.1f %13.1f %12.3f %10zu %10zu %5zu/%zu\n", a, r.mixedPercent, r.onTrackNs,
+                    r.exactOnTrackNs, r.surfaceNs, r.collideNs, r.renderMs, r.contacts, r.stuck,
+                    r.mismatches, r.checked);
+        ok = ok && r.mismatches == 0 && r.stuck == 0;
+    }
+
+    std::printf("\nthrough a 6 px wall at 400 px/s in 0.1 s steps:");
+    for (float a : { 0.0f, angle, 45.0f }) {
+        int through = tunnelled(a);
+        std::printf(" %.0f deg %d of 1000,", a, through);
+        ok = ok && through == 0;
+    }
+    std::printf("\n");
+
+    renderer.reset();
+    if (sdl) {
+        SDL_DestroyRenderer(sdl);
+    }
+    SDL_DestroySurface(surface);
+    return ok ? 0 : 1;
+}
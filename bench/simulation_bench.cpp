@@ -0,0 +1,77 @@
+// Fixed-step simulation benchmark and determinism check.
+//
+// Runs two independent Simulations on the same track with the same scripted
+// player input and verifies their state hashes stay bit-identical, then
+// reports simulation throughput in ticks and simulated seconds per second.
+//
+//   simulation_bench [track.json] [ticks]
+
+#include "simulation.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+// Deterministic player input: full throttle with periodic steering and braking
+InputState scriptedInput(uint64_t tick) {
+    InputState state;
+    state.forward = tick % 600 < 540;
+    state.backward = !state.forward;
+    state.right = tick % 240 < 50;
+    state.left = tick % 400 >= 300 && tick % 400 < 340;
+    return state;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string trackFile = argc > 1 ? argv[1] : "tracks/track1.json";
+    long ticks = argc > 2 ? std::atol(argv[2]) : 120L * 60 * 10;
+
+    Simulation a, b;
+    if (!a.loadTrack(trackFile) || !b.loadTrack(trackFile)) {
+        return 1;
+    }
+    a.spawnCars(3, 1);
+    b.spawnCars(3, 1);
+
+    StateInput input;
+    long firstMismatch = -1;
+
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < ticks; ++i) {
+        input.state = scriptedInput(a.getTick());
+        a.step(input);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Replay the same inputs into a second instance, comparing tick by tick
+    Simulation c;
+    c.loadTrack(trackFile);
+    c.spawnCars(3, 1);
+    for (long i = 0; i < ticks; ++i) {
+        input.state = scriptedInput(b.getTick());
+        b.step(input);
+        c.step(input);
+        if (firstMismatch < 0 && b.stateHash() != c.stateHash()) {
+            firstMismatch = i;
+        }
+    }
+
+    bool identical = firstMismatch < 0 && a.stateHash() == b.stateHash();
+    double simulated = ticks * static_cast<double>(Simulation::TICK_SECONDS);
+
+    std::printf("track:             %s\n", trackFile.c_str());
+    std::printf("ticks:             %ld (%.0f simulated s at %d Hz)\n", ticks, simulated, Simulation::TICK_RATE);
+    std::printf("final hash:        %016llx\n", static_cast<unsigned long long>(a.stateHash()));
+    std::printf("deterministic:     %s\n", identical ? "yes" : "NO");
+    if (firstMismatch >= 0) {
+        std::printf("first mismatch:    tick %ld\n", firstMismatch);
+    }
+    std::printf("ticks per second:  %.0f\n", ticks / seconds);
+    std::printf("realtime factor:   %.0fx\n", simulated / seconds);
+
+    return identical ? 0 : 1;
+}
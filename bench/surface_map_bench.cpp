@@ -0,0 +1,130 @@
+// Surface map benchmark: Track::isOnTrack and Track::surfaceAt read from
+// the rasterised SurfaceMap against the exact test over merged tiles, on
+// the shipped tracks and on editor-style courses up to 1M tiles.
+//
+// For each cell size reports the build time, memory, how many blocks had
+// to be stored and how many cells fall back to the tiles, then ns per
+// query both ways. Every answer is checked against the exact one,
+// including points that sit right on tile edges.
+//
+//   surface_map_bench [largest course side in tiles]
+
+#include "track.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const float TILE_SIZE = 50.0f;
+const int QUERIES = 1000000;
+
+// The shared editor-style course with jumps and checkpoints along the
+// road
+void addCourse(Track& track, int side) {
+    const int road = 4;
+    addAll(track, buildCourse(side));
+    for (int i = 10; i + 10 < side; i += 20) {
+        track.addTile(TileType::JUMP, i * TILE_SIZE + 15.0f, 40.0f, 80.0f, 80.0f);
+        track.addTile(TileType::CHECKPOINT, i * TILE_SIZE, (side - road) * TILE_SIZE, 20.0f, road * TILE_SIZE);
+    }
+}
+
+// Random points on a 1/4 px lattice, so plenty land exactly on tile edges
+std::vector<float> samplePoints(const Track& track) {
+    float maxX = 0.0f, maxY = 0.0f, minX = 0.0f, minY = 0.0f;
+    for (const Tile& tile : track.getTiles()) {
+        minX = std::min(minX, tile.x);
+        minY = std::min(minY, tile.y);
+        maxX = std::max(maxX, tile.x + tile.width);
+        maxY = std::max(maxY, tile.y + tile.height);
+    }
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> across(static_cast<int>(minX - 50.0f) * 4, static_cast<int>(maxX + 50.0f) * 4);
+    std::uniform_int_distribution<int> down(static_cast<int>(minY - 50.0f) * 4, static_cast<int>(maxY + 50.0f) * 4);
+    std::vector<float> points;
+    points.reserve(2 * QUERIES);
+    for (int i = 0; i < QUERIES; ++i) {
+        // One point in eight snapped to the 50 px grid lines
+        float x = across(rng) * 0.25f;
+        float y = down(rng) * 0.25f;
+        if (i % 8 == 0) {
+            x = std::round(x / TILE_SIZE) * TILE_SIZE;
+        }
+        points.push_back(x);
+        points.push_back(y);
+    }
+    return points;
+}
+
+bool run(const std::string& name, Track& track) {
+    const std::vector<float> points = samplePoints(track);
+
+    // Exact answers with no map
+    track.setSurfaceCellSize(0.0f);
+    track.mergeTiles();
+    std::vector<TileType> exactSurface(QUERIES);
+    std::vector<bool> exactOnTrack(QUERIES);
+    for (int i = 0; i < QUERIES; ++i) {
+        exactSurface[i] = track.surfaceAt(points[2 * i], points[2 * i + 1]);
+        exactOnTrack[i] = track.isOnTrack(points[2 * i], points[2 * i + 1]);
+    }
+    size_t checksum = 0;
+    double exactOnTrackNs = timeQueries(points, [&](float x, float y) { return track.isOnTrack(x, y); }, checksum);
+    double exactSurfaceNs = timeQueries(points, [&](float x, float y) { return track.surfaceAt(x, y); }, checksum);
+
+    std::printf("%s: %zu tiles, exact isOnTrack %.1f ns, surfaceAt %.1f ns\n", name.c_str(),
+                track.getTiles().size(), exactOnTrackNs, exactSurfaceNs);
+    std::printf("%8s %10s %10s %14s %8s %12s %12s %10s\n", "cell px", "build ms", "KB", "stored blocks",
+                "mixed %", "isOnTrack ns", "surfaceAt ns", "mismatches");
+
+    bool ok = true;
+    for (float cellSize : { 10.0f, 25.0f, 50.0f }) {
+        track.setSurfaceCellSize(cellSize);
+        auto start = std::chrono::steady_clock::now();
+        track.mergeTiles();
+        double buildMs = secondsSince(start) * 1e3;
+        const SurfaceMap& map = track.getSurfaceMap();
+
+        size_t mismatches = 0;
+        for (int i = 0; i < QUERIES; ++i) {
+            mismatches += track.surfaceAt(points[2 * i], points[2 * i + 1]) != exactSurface[i];
+            mismatches += track.isOnTrack(points[2 * i], points[2 * i + 1]) != exactOnTrack[i];
+        }
+        double onTrackNs = timeQueries(points, [&](float x, float y) { return track.isOnTrack(x, y); }, checksum);
+        double surfaceNs = timeQueries(points, [&](float x, float y) { return track.surfaceAt(x, y); }, checksum);
+
+        size_t cells = map.getBlockCount() * SurfaceMap::BLOCK_SIZE * SurfaceMap::BLOCK_SIZE;
+        std::printf("%8.0f %10.2f %10.1f %7zu/%-6zu %8.2f %12.1f %12.1f %10zu\n", cellSize, buildMs,
+                    map.getMemoryBytes() / 1024.0, map.getStoredBlockCount(), map.getBlockCount(),
+                    100.0 * map.getMixedCellCount() / std::max<size_t>(1, cells), onTrackNs, surfaceNs, mismatches);
+        ok = ok && mismatches == 0;
+    }
+    std::printf("\n");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int largest = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    bool ok = true;
+    for (const char* path : { "tracks/track1.json", "tracks/track2.json", "tracks/track3.json" }) {
+        Track track;
+        if (track.loadFromFile(path)) {
+            ok = run(path, track) && ok;
+        }
+    }
+    for (int side : { 40, 300, largest }) {
+        Track track;
+        addCourse(track, side);
+        ok = run("course " + std::to_string(side) + "x" + std::to_string(side), track) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+// Tile merging benchmark: how far Track::mergeTiles() cuts the tile count
+// of the shipped tracks and of large editor-style tracks, and what that
+// does to Track::isOnTrack and Track::render.
+//
+// Each track is built twice with addTile(), once left as placed and once
+// merged. isOnTrack is timed over the same random points on both and the
+// answers compared; render is timed panning a 1280x720 view in the
+// software renderer, when there is one.
+//
+//   tile_merge_bench [course side in tiles] [frames]
+
+#include "track.h"
+#include "camera.h"
+#include "renderer.h"
+#include "bench_util.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int WIDTH = 1280;
+const int HEIGHT = 720;
+const int QUERIES = 1000000;
+
+struct Extent {
+    float minX, minY, maxX, maxY;
+};
+
+Extent extentOf(const std::vector<Tile>& tiles) {
+    Extent e = { tiles[0].x, tiles[0].y, tiles[0].x, tiles[0].y };
+    for (const Tile& tile : tiles) {
+        e.minX = std::min(e.minX, tile.x);
+        e.minY = std::min(e.minY, tile.y);
+        e.maxX = std::max(e.maxX, tile.x + tile.width);
+        e.maxY = std::max(e.maxY, tile.y + tile.height);
+    }
+    return e;
+}
+
+double timeRender(SDL_Renderer* sdl, Renderer& renderer, const Track& track, const Extent& extent,
+                  int frames, size_t& tilesPerFrame) {
+    Camera camera(WIDTH, HEIGHT);
+    renderer.resetStats();
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        float t = static_cast<float>(f) / frames;
+        camera.setPosition(extent.minX + WIDTH / 2 + t * std::max(0.0f, extent.maxX - extent.minX - WIDTH),
+                           extent.minY + HEIGHT / 2 + t * std::max(0.0f, extent.maxY - extent.minY - HEIGHT));
+        SDL_SetRenderDrawColor(sdl, 20, 20, 20, 255);
+        SDL_RenderClear(sdl);
+        track.render(renderer, camera);
+        renderer.flush();
+        SDL_RenderPresent(sdl);
+    }
+    tilesPerFrame = renderer.getStats().tilesSubmitted / frames;
+    return secondsSince(start) * 1e3 / frames;
+}
+
+bool run(const std::string& name, const std::vector<Tile>& tiles, SDL_Renderer* sdl, Renderer* renderer, int frames) {
+    Track placed;
+    Track merged;
+    addAll(placed, tiles);
+    addAll(merged, tiles);
+
+    auto start = std::chrono::steady_clock::now();
+    TileMergeStats stats = merged.mergeTiles();
+    double mergeMs = secondsSince(start) * 1e3;
+
+    // Points off the 1/8 px grid the tiles sit on, so none lands on a seam
+    // between two tiles, where merging does change the answer
+    const Extent extent = extentOf(tiles);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> across(extent.minX - 50.0f, extent.maxX + 50.0f);
+    std::uniform_real_distribution<float> down(extent.minY - 50.0f, extent.maxY + 50.0f);
+    std::vector<float> points;
+    points.reserve(2 * QUERIES);
+    for (int i = 0; i < QUERIES; ++i) {
+        points.push_back(std::floor(across(rng) * 8.0f) / 8.0f + 1.0f / 16.0f);
+        points.push_back(std::floor(down(rng) * 8.0f) / 8.0f + 1.0f / 16.0f);
+    }
+
+    size_t checksum = 0;
+    double placedNs = timeQueries(points, [&](float x, float y) { return placed.isOnTrack(x, y); }, checksum);
+    double mergedNs = timeQueries(points, [&](float x, float y) { return merged.isOnTrack(x, y); }, checksum);
+    size_t mismatches = 0;
+    for (size_t i = 0; i + 1 < points.size(); i += 2) {
+        mismatches += placed.isOnTrack(points[i], points[i + 1]) != merged.isOnTrack(points[i], points[i + 1]);
+    }
+
+    std::printf("%s\n", name.c_str());
+    std::printf("  tiles:           %zu -> %zu drawn (%.1fx fewer), %zu drivable tested, merged in %.2f ms\n",
+                stats.tiles, stats.drawTiles, static_cast<double>(stats.tiles) / stats.drawTiles,
+                stats.drivableTiles, mergeMs);
+    std::printf("  isOnTrack:       %.1f ns -> %.1f ns per query (%.2fx), %zu of %d answers differ\n",
+                placedNs, mergedNs, placedNs / mergedNs, mismatches, QUERIES);
+
+    if (sdl && renderer) {
+        size_t placedDrawn = 0, mergedDrawn = 0;
+        double placedMs = timeRender(sdl, *renderer, placed, extent, frames, placedDrawn);
+        double mergedMs = timeRender(sdl, *renderer, merged, extent, frames, mergedDrawn);
+        std::printf("  render:          %.3f ms -> %.3f ms per frame (%.2fx), %zu -> %zu tiles drawn\n",
+                    placedMs, mergedMs, placedMs / mergedMs, placedDrawn, mergedDrawn);
+    }
+    return mismatches == 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 300;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 100;
+
+    SDL_Surface* surface = SDL_CreateSurface(WIDTH, HEIGHT, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* sdl = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!sdl) {
+        std::printf("software renderer unavailable (%s), timing isOnTrack only\n\n", SDL_GetError());
+    }
+    std::unique_ptr<Renderer> renderer;
+    if (sdl) {
+        renderer = std::make_unique<Renderer>(sdl);
+    }
+
+    bool ok = true;
+    for (const char* path : { "tracks/track1.json", "tracks/track2.json", "tracks/track3.json" }) {
+        Track shipped;
+        if (!shipped.loadFromFile(path)) {
+            continue;
+        }
+        ok = run(path, shipped.getTiles(), sdl, renderer.get(), frames) && ok;
+    }
+    for (int courseSide : { 40, side }) {
+        ok = run("course, " + std::to_string(courseSide) + "x" + std::to_string(courseSide) + " tiles",
+                 buildCourse(courseSide), sdl, renderer.get(), frames) && ok;
+    }
+
+    renderer.reset();
+    if (sdl) {
+        SDL_DestroyRenderer(sdl);
+    }
+    SDL_DestroySurface(surface);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+// Track chunk cache benchmark: frames of a large track drawn tile by tile
+// (Track::render, culled to the view) against copies of cached chunk
+// textures (TrackChunks), in the software renderer.
+//
+// Pans a 1280x720 view diagonally across the track and reports ms per
+// frame for both, the chunks rasterised on the way, the cost of a frame
+// after an editor-style tile placement, and whether a frame drawn both
+// ways comes out identical. Then pans as far again over empty space and
+// checks that no chunk is tracked there.
+//
+//   track_chunk_bench [tiles] [frames]
+
+#include "track.h"
+#include "track_chunks.h"
+#include "camera.h"
+#include "renderer.h"
+#include "bench_util.h"
+#include <SDL3/SDL.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const int WIDTH = 1280;
+const int HEIGHT = 720;
+const float TILE_SIZE = 50.0f;
+
+void buildTrack(Track& track, int tileCount) {
+    int side = 1;
+    while (side * side < tileCount) {
+        ++side;
+    }
+    for (int i = 0; i < tileCount; ++i) {
+        int cx = i % side;
+        int cy = i / side;
+        TileType type = (cx % 7 == 0 || cy % 5 == 0) ? TileType::TRACK : TileType::GRASS;
+        track.addTile(type, cx * TILE_SIZE, cy * TILE_SIZE, TILE_SIZE, TILE_SIZE);
+    }
+}
+
+// One frame with the track drawn either directly or from the chunk cache
+void drawFrame(SDL_Renderer* sdl, Renderer& renderer, TrackChunks* chunks,
+               const Track& track, const Camera& camera) {
+    SDL_SetRenderDrawColor(sdl, 20, 20, 20, 255);
+    SDL_RenderClear(sdl);
+    if (chunks) {
+        chunks->render(track, camera);
+    } else {
+        track.render(renderer, camera);
+    }
+    renderer.flush();
+    SDL_RenderPresent(sdl);
+}
+
+double pan(SDL_Renderer* sdl, Renderer& renderer, TrackChunks* chunks,
+           const Track& track, Camera& camera, int frames, float extent) {
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        float t = extent * f / frames;
+        camera.setPosition(WIDTH / 2 + t, HEIGHT / 2 + t);
+        drawFrame(sdl, renderer, chunks, track, camera);
+    }
+    return secondsSince(start) * 1e3 / frames;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int tileCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    SDL_Surface* surface = SDL_CreateSurface(WIDTH, HEIGHT, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* sdl = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!sdl) {
+        std::fprintf(stderr, "software renderer unavailable: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    Track track;
+    buildTrack(track, tileCount);
+    const float extent = track.getTiles().back().y; // Diagonal pan over the whole field
+
+    Renderer renderer(sdl);
+    Camera camera(WIDTH, HEIGHT);
+    bool ok = true;
+    {
+        TrackChunks chunks(renderer);
+
+        renderer.resetStats();
+        double directMs = pan(sdl, renderer, nullptr, track, camera, frames, extent);
+        RenderStats directStats = renderer.getStats();
+        double firstMs = pan(sdl, renderer, &chunks, track, camera, frames, extent);
+        size_t redraws = chunks.getRedrawCount();
+        double cachedMs = pan(sdl, renderer, &chunks, track, camera, frames, extent);
+
+        // Placing a tile in view costs one chunk redraw on the next frame
+        camera.setPosition(WIDTH / 2 + 100.0f, HEIGHT / 2 + 100.0f);
+        drawFrame(sdl, renderer, &chunks, track, camera);
+        const int edits = 20;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < edits; ++i) {
+            track.addTile(TileType::WALL, 200.0f + i * TILE_SIZE, 300.0f, TILE_SIZE, TILE_SIZE);
+            drawFrame(sdl, renderer, &chunks, track, camera);
+        }
+        double editMs = secondsSince(start) * 1e3 / edits;
+
+        // Same view both ways, camera on whole pixels
+        drawFrame(sdl, renderer, nullptr, track, camera);
+        SDL_Surface* direct = SDL_RenderReadPixels(sdl, nullptr);
+        drawFrame(sdl, renderer, &chunks, track, camera);
+        SDL_Surface* cached = SDL_RenderReadPixels(sdl, nullptr);
+        size_t differing = differingPixels(direct, cached);
+        SDL_DestroySurface(direct);
+        SDL_DestroySurface(cached);
+
+        pan(sdl, renderer, &chunks, track, camera, frames, -2.0f * extent);
+        size_t tracked = chunks.getChunkCount();
+        ok = differing == 0 && tracked <= chunks.getTextureCount();
+
+        std::printf("tiles:                  %d (%.0f px field), %d frames panned\n",
+                    tileCount, extent + TILE_SIZE, frames);
+        std::printf("direct, per frame:      %.3f ms (%zu tiles drawn, %zu culled)\n", directMs,
+                    directStats.tilesSubmitted / frames, directStats.tilesCulled / frames);
+        std::printf("chunks, first pass:     %.3f ms (%zu chunks rasterised)\n", firstMs, redraws);
+        std::printf("chunks, cached:         %.3f ms\n", cachedMs);
+        std::printf("frame after an edit:    %.3f ms\n", editMs);
+        std::printf("chunk textures:         %zu of %zu\n", chunks.getTextureCount(), TrackChunks::MAX_TEXTURES);
+        std::printf("differing pixels:       %zu\n", differing);
+        std::printf("chunks after empty pan: %zu tracked\n", tracked);
+    }
+
+    SDL_DestroyRenderer(sdl);
+    SDL_DestroySurface(surface);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+// Load-time and peak-RSS benchmark for Track::loadFromFile.
+//
+// Writes synthetic 10k/100k/1M-tile tracks with Track::saveToFile, then loads
+// each one in a fresh child process, once through the streaming SAX loader
+// and once through the previous DOM-based loader, so every run gets its own
+// peak-RSS reading.
+//
+//   track_load_bench                      run the whole comparison
+//   track_load_bench --load sax|dom FILE  load FILE once and print the stats
+
+#include "track.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+long peakRssKb() {
+#ifdef _WIN32
+    return -1;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// The DOM loader Track::loadFromFile used before the SAX reader
+bool domLoad(const std::string& filename, std::vector<Tile>& tiles, std::vector<Point2D>& starts) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    try {
+        json trackData;
+        file >> trackData;
+
+        tiles.clear();
+        if (trackData.contains("tiles")) {
+            for (const auto& tileData : trackData["tiles"]) {
+                Tile tile;
+                tile.type = static_cast<TileType>(tileData["type"].get<int>());
+                tile.x = tileData["x"].get<float>();
+                tile.y = tileData["y"].get<float>();
+                tile.width = tileData["width"].get<float>();
+                tile.height = tileData["height"].get<float>();
+                tile.angle = tileData.value("angle", 0.0f);
+                tiles.push_back(tile);
+            }
+        }
+
+        starts.clear();
+        if (trackData.contains("startPositions")) {
+            for (const auto& pos : trackData["startPositions"]) {
+                starts.push_back({ pos["x"].get<float>(), pos["y"].get<float>() });
+            }
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error parsing track file: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+int loadOnce(const std::string& mode, const std::string& filename) {
+    long baseline = peakRssKb();
+    auto start = std::chrono::steady_clock::now();
+
+    size_t tileCount = 0;
+    bool ok;
+    if (mode == "dom") {
+        std::vector<Tile> tiles;
+        std::vector<Point2D> starts;
+        ok = domLoad(filename, tiles, starts);
+        tileCount = tiles.size();
+    } else {
+        Track track;
+        ok = track.loadFromFile(filename);
+        tileCount = track.getTiles().size();
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%zu %.1f %ld %ld\n", tileCount, ms, baseline, peakRssKb());
+    return ok ? 0 : 1;
+}
+
+void writeTrack(const std::string& filename, int tileCount) {
+    Track track;
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(tileCount))));
+    for (int i = 0; i < tileCount; ++i) {
+        TileType type = i % 10 == 0 ? TileType::WALL : TileType::TRACK;
+        track.addTile(type, (i % side) * 50.0f, (i / side) * 50.0f, 50.0f, 50.0f, (i % 7) * 0.25f);
+    }
+    track.saveToFile(filename);
+}
+
+bool sameResult(const std::string& filename) {
+    Track track;
+    std::vector<Tile> tiles;
+    std::vector<Point2D> starts;
+    if (!track.loadFromFile(filename) || !domLoad(filename, tiles, starts)) {
+        return false;
+    }
+    return tiles.size() == track.getTiles().size() &&
+           std::memcmp(tiles.data(), track.getTiles().data(), tiles.size() * sizeof(Tile)) == 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc == 4 && std::strcmp(argv[1], "--load") == 0) {
+        return loadOnce(argv[2], argv[3]);
+    }
+
+    const int sizes[] = { 10000, 100000, 1000000 };
+    auto dir = std::filesystem::temp_directory_path();
+
+    std::printf("%10s %6s %10s %12s %14s %8s\n", "tiles", "mode", "MB", "load(ms)", "peakRSS(MB)", "match");
+
+    bool allMatch = true;
+    for (int size : sizes) {
+        std::string filename = (dir / ("track_load_bench_" + std::to_string(size) + ".json")).string();
+        writeTrack(filename, size);
+        double fileMb = std::filesystem::file_size(filename) / (1024.0 * 1024.0);
+        bool match = sameResult(filename);
+        allMatch = allMatch && match;
+
+        for (const char* mode : { "dom", "sax" }) {
+            std::string command = "\"" + std::string(argv[0]) + "\" --load " + mode + " \"" + filename + "\"";
+            FILE* child = popen(command.c_str(), "r");
+            size_t tiles = 0;
+            double ms = 0;
+            long baseline = 0, peak = 0;
+            if (!child || std::fscanf(child, "%zu %lf %ld %ld", &tiles, &ms, &baseline, &peak) != 4) {
+                std::fprintf(stderr, "Failed to run %s\n", command.c_str());
+                allMatch = false;
+            }
+            if (child) {
+                pclose(child);
+            }
+            std::printf("%10d %6s %10.1f %12.1f %14.1f %8s\n",
+                        size, mode, fileMb, ms, peak / 1024.0, match ? "yes" : "NO");
+        }
+
+        std::error_code error;
+        std::filesystem::remove(filename, error);
+    }
+
+    return allMatch ? 0 : 1;
+}
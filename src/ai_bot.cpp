@@ -1,5 +1,7 @@
 #include "ai_bot.h"
 #include "input.h"
+#include "renderer.h"
+#include "camera.h"
 #include <cmath>
 #include <algorithm>
 
@@ -7,110 +9,87 @@
 #define M_PI 3.14159265358979323846
 #endif
 
-AIBot::AIBot(float x, float y, int difficulty)
-    : difficulty(difficulty)
+AIBot::AIBot(CarPool& pool, float x, float y, int difficulty)
+    : car(pool.add(x, y, 255, 50, 50)) // AI cars are red
+    , difficulty(difficulty)
     , targetX(x), targetY(y)
-    , waypointIndex(0)
+    , targetSpeed(CarPool::MAX_SPEED)
 {
-    // Create AI car with red color
-    car = std::make_unique<Car>(x, y, 255, 50, 50);
-    
-    // Generate simple circular waypoints for now
-    float centerX = 640;
-    float centerY = 360;
-    float radius = 300;
-    
-    for (int i = 0; i < 8; ++i) {
-        float angle = (i / 8.0f) * 2.0f * M_PI;
-        waypoints.push_back({
-            centerX + std::cos(angle) * radius,
-            centerY + std::sin(angle) * radius
-        });
-    }
 }
 
 void AIBot::update(float deltaTime, const Track& track) {
-    updateWaypoint(track);
-    
-    // Calculate direction to target
-    float dx = targetX - car->getX();
-    float dy = targetY - car->getY();
-    float targetAngle = std::atan2(dy, dx);
+    steer(track.getFlowField());
+    car.integrate(deltaTime);
+}
+
+void AIBot::steer(const FlowField& field) {
+    float headingX = std::cos(car.getAngle());
+    float headingY = std::sin(car.getAngle());
+    
+    FlowSample flow;
+    if (!field.sample(car.getX(), car.getY(), flow)) {
+        // No racing line to follow; hold the current heading
+        flow.directionX = headingX;
+        flow.directionY = headingY;
+        flow.speed = CarPool::MAX_SPEED;
+    }
+    targetX = car.getX() + flow.directionX * FlowField::LOOKAHEAD;
+    targetY = car.getY() + flow.directionY * FlowField::LOOKAHEAD;
+    targetSpeed = flow.speed;
     
-    // Calculate angle difference
-    float angleDiff = targetAngle - car->getAngle();
-    
-    // Normalize angle to [-PI, PI]
-    while (angleDiff > M_PI) angleDiff -= 2 * M_PI;
-    while (angleDiff < -M_PI) angleDiff += 2 * M_PI;
+    // Sine and cosine of the angle from the heading to the flow direction
+    float cross = headingX * flow.directionY - headingY * flow.directionX;
+    float dot = headingX * flow.directionX + headingY * flow.directionY;
     
     // Simple AI controller
-    class AIInput : public Input {
-    public:
-        bool forward = false;
-        bool backward = false;
-        bool left = false;
-        bool right = false;
-        
-        bool isForward() const override { return forward; }
-        bool isBackward() const override { return backward; }
-        bool isLeft() const override { return left; }
-        bool isRight() const override { return right; }
-    };
-    
-    AIInput input;
-    input.forward = true; // Always accelerate
+    input.state = InputState();
+    input.state.forward = true; // Always accelerate
     
     // Steering based on difficulty
-    float steerThreshold = 0.1f / difficulty; // Higher difficulty = more precise
+    float steerThreshold = std::sin(0.1f / difficulty); // Higher difficulty = more precise
     
-    if (angleDiff > steerThreshold) {
-        input.right = true;
-    } else if (angleDiff < -steerThreshold) {
-        input.left = true;
+    // Positive angles turn right; a direction straight behind turns right too
+    if (cross > steerThreshold || (dot < 0 && cross >= 0)) {
+        input.state.right = true;
+    } else if (cross < -steerThreshold || dot < 0) {
+        input.state.left = true;
     }
     
-    // Slow down on sharp turns
-    if (std::abs(angleDiff) > M_PI / 3) {
-        input.forward = false;
-        input.backward = true;
+    // Slow down on sharp turns (over 60 degrees) and ahead of slow parts of
+    // the line. Cars only turn while moving, so never brake below crawling
+    // speed.
+    float speed = std::sqrt(car.getVelocityX() * car.getVelocityX() + car.getVelocityY() * car.getVelocityY());
+    bool sharpTurn = dot < 0.5f && speed > CRAWL_SPEED;
+    if (sharpTurn || speed > targetSpeed) {
+        input.state.forward = false;
+        input.state.backward = true;
     }
     
-    car->update(deltaTime, input);
+    car.setInput(input.state);
 }
 
-void AIBot::render(Renderer& renderer, const Camera& camera) {
-    car->render(renderer, camera);
+void AIBot::render(Renderer& renderer, const Camera& camera, float alpha) const {
+    car.render(renderer, camera, alpha);
     
     // Debug: Draw target waypoint
+    const float radius = 5.0f;
+    if (!camera.isVisible(targetX - radius, targetY - radius, targetX + radius, targetY + radius)) {
+        ++renderer.getStats().overlaysCulled;
+        return;
+    }
+    ++renderer.getStats().overlaysSubmitted;
     float screenX = targetX - camera.getX();
     float screenY = targetY - camera.getY();
-    renderer.drawCircle(screenX, screenY, 5, 255, 255, 0);
-}
-
-void AIBot::updateWaypoint(const Track& track) {
-    // Check if reached current waypoint
-    float dx = targetX - car->getX();
-    float dy = targetY - car->getY();
-    float distance = std::sqrt(dx * dx + dy * dy);
-    
-    if (distance < 50.0f) {
-        // Move to next waypoint
-        waypointIndex = (waypointIndex + 1) % waypoints.size();
-        if (waypointIndex < waypoints.size()) {
-            targetX = waypoints[waypointIndex].x;
-            targetY = waypoints[waypointIndex].y;
-        }
-    }
+    renderer.drawCircle(screenX, screenY, radius, 255, 255, 0);
 }
 
 void AIBot::calculateInput(float& forward, float& turn) {
     forward = 1.0f;
     
-    float dx = targetX - car->getX();
-    float dy = targetY - car->getY();
+    float dx = targetX - car.getX();
+    float dy = targetY - car.getY();
     float targetAngle = std::atan2(dy, dx);
-    float angleDiff = targetAngle - car->getAngle();
+    float angleDiff = targetAngle - car.getAngle();
     
     while (angleDiff > M_PI) angleDiff -= 2 * M_PI;
     while (angleDiff < -M_PI) angleDiff += 2 * M_PI;
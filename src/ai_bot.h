@@ -3,29 +3,38 @@
 
 #include "car.h"
 #include "track.h"
-#include <memory>
-#include <vector>
 
+// Drives by the track's shared FlowField: steers along the direction of the
+// cell under the car and brakes whenever faster than its target speed, so
+// each tick costs the same however many bots are racing.
 class AIBot {
 public:
-    AIBot(float x, float y, int difficulty);
+    AIBot(CarPool& pool, float x, float y, int difficulty);
     
+    // Picks this tick's controls; the pool integrates all cars together.
+    // Takes the field rather than the track so parallel callers never
+    // reach Track's lazy rebuild.
+    void steer(const FlowField& field);
     void update(float deltaTime, const Track& track);
-    void render(Renderer& renderer, const Camera& camera);
+    void render(Renderer& renderer, const Camera& camera, float alpha = 1.0f) const;
     
-    Car& getCar() { return *car; }
-    const Car& getCar() const { return *car; }
+    Car& getCar() { return car; }
+    const Car& getCar() const { return car; }
+    
+    // Controls chosen by the last steer(), for replays
+    const InputState& getInput() const { return input.state; }
     
 private:
-    std::unique_ptr<Car> car;
+    Car car;
     int difficulty;
+    StateInput input;
     
     // AI state
-    float targetX, targetY;
-    int waypointIndex;
-    std::vector<Point2D> waypoints;
+    float targetX, targetY; // Where the flow field points, for debug drawing
+    float targetSpeed;
+    
+    static constexpr float CRAWL_SPEED = 80.0f;
     
-    void updateWaypoint(const Track& track);
     void calculateInput(float& forward, float& turn);
 };
 
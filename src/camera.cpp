@@ -1,5 +1,6 @@
 #include "camera.h"
 #include <algorithm>
+#include <cmath>
 
 Camera::Camera(int screenWidth, int screenHeight)
     : x(0), y(0)
@@ -23,13 +24,28 @@ void Camera::followTarget(float targetPosX, float targetPosY) {
 }
 
 void Camera::update(float deltaTime) {
-    // Smooth camera movement using lerp
-    float lerpFactor = std::min(1.0f, LERP_SPEED * deltaTime);
+    // Smooth camera movement using lerp, framerate-independent
+    float lerpFactor = 1.0f - std::exp(-LERP_SPEED * deltaTime);
     
     x += (targetX - x) * lerpFactor;
     y += (targetY - y) * lerpFactor;
 }
 
+void Camera::setScreenSize(int width, int height) {
+    screenWidth = width;
+    screenHeight = height;
+}
+
+ViewRect Camera::getVisibleRect() const {
+    float scale = zoom > 0.0f ? 1.0f / zoom : 1.0f;
+    return { x, y, x + screenWidth * scale, y + screenHeight * scale };
+}
+
+bool Camera::isVisible(float minX, float minY, float maxX, float maxY) const {
+    ViewRect view = getVisibleRect();
+    return maxX >= view.minX && minX <= view.maxX && maxY >= view.minY && minY <= view.maxY;
+}
+
 void Camera::apply(SDL_Renderer* renderer) {
     // For SDL2, camera offset is handled in render code
     // by subtracting camera position from world coordinates
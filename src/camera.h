@@ -3,6 +3,11 @@
 
 #include <SDL3/SDL.h>
 
+// Axis-aligned world-space rectangle
+struct ViewRect {
+    float minX, minY, maxX, maxY;
+};
+
 class Camera {
 public:
     Camera(int screenWidth, int screenHeight);
@@ -11,6 +16,9 @@ public:
     void followTarget(float targetX, float targetY);
     void update(float deltaTime);
     
+    // Output size in pixels; follows the window when it is resized
+    void setScreenSize(int width, int height);
+    
     void apply(SDL_Renderer* renderer);
     void reset(SDL_Renderer* renderer);
     
@@ -18,6 +26,13 @@ public:
     float getY() const { return y; }
     float getZoom() const { return zoom; }
     
+    // World area on screen: screenWidth x screenHeight pixels from the
+    // top-left (x, y), divided by zoom
+    ViewRect getVisibleRect() const;
+    
+    // Whether a world-space box overlaps the visible rect
+    bool isVisible(float minX, float minY, float maxX, float maxY) const;
+    
 private:
     float x, y;
     float targetX, targetY;
@@ -1,75 +1,61 @@
 #include "car.h"
+#include "renderer.h"
+#include "camera.h"
 #include <algorithm>
 
-Car::Car(float x, float y, int r, int g, int b)
-    : x(x), y(y)
-    , velocityX(0), velocityY(0)
-    , angle(0)
-    , angularVelocity(0)
-    , colorR(r), colorG(g), colorB(b)
+Car::Car(CarPool& pool, uint32_t index)
+    : pool(&pool)
+    , index(index)
 {
 }
 
 void Car::update(float deltaTime, const Input& input) {
-    // Get input
-    float acceleration = 0;
-    float turnAmount = 0;
-    
-    if (input.isForward()) {
-        acceleration = ACCELERATION;
-    }
-    if (input.isBackward()) {
-        acceleration = -BRAKE_FORCE;
-    }
-    if (input.isLeft()) {
-        turnAmount = -TURN_SPEED;
-    }
-    if (input.isRight()) {
-        turnAmount = TURN_SPEED;
-    }
-    
-    // Calculate current speed
-    float speed = std::sqrt(velocityX * velocityX + velocityY * velocityY);
-    
-    // Apply turning (only when moving)
-    if (speed > 10.0f) {
-        angle += turnAmount * deltaTime * (speed / MAX_SPEED);
-    }
-    
-    // Apply acceleration in the direction the car is facing
-    if (acceleration != 0) {
-        velocityX += std::cos(angle) * acceleration * deltaTime;
-        velocityY += std::sin(angle) * acceleration * deltaTime;
-    }
-    
-    // Apply friction
-    velocityX *= FRICTION;
-    velocityY *= FRICTION;
-    
-    // Limit max speed
-    speed = std::sqrt(velocityX * velocityX + velocityY * velocityY);
-    if (speed > MAX_SPEED) {
-        velocityX = (velocityX / speed) * MAX_SPEED;
-        velocityY = (velocityY / speed) * MAX_SPEED;
-    }
-    
-    // Update position
-    x += velocityX * deltaTime;
-    y += velocityY * deltaTime;
+    setInput(input);
+    integrate(deltaTime);
 }
 
-void Car::render(Renderer& renderer, const Camera& camera) {
-    // Convert world coordinates to screen coordinates
-    float screenX = x - camera.getX();
-    float screenY = y - camera.getY();
+void Car::setInput(const Input& input) {
+    pool->setInput(index, input);
+}
+
+void Car::setInput(const InputState& state) {
+    pool->setInput(index, state);
+}
+
+void Car::integrate(float deltaTime) {
+    pool->integrate(deltaTime, index, index + 1);
+}
+
+void Car::beginTick() {
+    pool->previousX[index] = pool->x[index];
+    pool->previousY[index] = pool->y[index];
+    pool->previousAngle[index] = pool->angle[index];
+}
+
+void Car::render(Renderer& renderer, const Camera& camera, float alpha) const {
+    float worldX = getInterpolatedX(alpha);
+    float worldY = getInterpolatedY(alpha);
     
     // Draw car as a rotated rectangle
     float carLength = 24.0f;
     float carWidth = 14.0f;
     
+    // Skip cars whose body cannot reach the screen at any angle
+    float reach = std::sqrt(carLength * carLength + carWidth * carWidth) / 2;
+    if (!camera.isVisible(worldX - reach, worldY - reach, worldX + reach, worldY + reach)) {
+        ++renderer.getStats().carsCulled;
+        return;
+    }
+    ++renderer.getStats().carsSubmitted;
+    
+    // Convert world coordinates to screen coordinates
+    float screenX = worldX - camera.getX();
+    float screenY = worldY - camera.getY();
+    float renderAngle = getInterpolatedAngle(alpha);
+    
     // Calculate corners of the car
-    float cosA = std::cos(angle);
-    float sinA = std::sin(angle);
+    float cosA = std::cos(renderAngle);
+    float sinA = std::sin(renderAngle);
     
     SDL_FPoint points[5];
     
@@ -96,23 +82,27 @@ void Car::render(Renderer& renderer, const Camera& camera) {
     points[4].x = points[0].x - perpX;
     points[4].y = points[0].y - perpY;
     
-    renderer.drawPolygon(points, 5, colorR, colorG, colorB);
+    renderer.drawPolygon(points, 5, pool->colorR[index], pool->colorG[index], pool->colorB[index]);
     
     // Draw direction indicator (front of car)
     renderer.drawLine(screenX, screenY, points[0].x, points[0].y, 255, 255, 255);
 }
 
 void Car::setPosition(float newX, float newY) {
-    x = newX;
-    y = newY;
+    pool->x[index] = newX;
+    pool->y[index] = newY;
 }
 
 void Car::setVelocity(float vx, float vy) {
-    velocityX = vx;
-    velocityY = vy;
+    pool->velocityX[index] = vx;
+    pool->velocityY[index] = vy;
+}
+
+void Car::setAngle(float newAngle) {
+    pool->angle[index] = newAngle;
 }
 
 void Car::applyImpulse(float fx, float fy) {
-    velocityX += fx;
-    velocityY += fy;
+    pool->velocityX[index] += fx;
+    pool->velocityY[index] += fy;
 }
@@ -1,46 +1,68 @@
 #ifndef CAR_H
 #define CAR_H
 
-#include "renderer.h"
-#include "camera.h"
 #include "input.h"
+#include "car_pool.h"
 #include <cmath>
+#include <cstdint>
 
+class Renderer;
+class Camera;
+
+// Handle to one car in a CarPool. Cheap to copy; copies refer to the same
+// car, and stay valid as long as the pool is alive and not cleared.
 class Car {
 public:
-    Car(float x, float y, int r, int g, int b);
+    Car(CarPool& pool, uint32_t index);
     
+    // Latches the controls and advances just this car
     void update(float deltaTime, const Input& input);
-    void render(Renderer& renderer, const Camera& camera);
+    void setInput(const Input& input);
+    void setInput(const InputState& state);
+    void integrate(float deltaTime);
+    
+    // Renders the pose interpolated between the previous and current tick
+    void render(Renderer& renderer, const Camera& camera, float alpha = 1.0f) const;
+    
+    // Remembers the current pose as the start of the next tick
+    void beginTick();
     
-    float getX() const { return x; }
-    float getY() const { return y; }
-    float getAngle() const { return angle; }
-    float getVelocityX() const { return velocityX; }
-    float getVelocityY() const { return velocityY; }
+    float getX() const { return pool->x[index]; }
+    float getY() const { return pool->y[index]; }
+    float getAngle() const { return pool->angle[index]; }
+    float getVelocityX() const { return pool->velocityX[index]; }
+    float getVelocityY() const { return pool->velocityY[index]; }
+    
+    // Position at the last beginTick()
+    float getPreviousX() const { return pool->previousX[index]; }
+    float getPreviousY() const { return pool->previousY[index]; }
+    
+    float getInterpolatedX(float alpha) const {
+        float previous = pool->previousX[index];
+        return previous + (pool->x[index] - previous) * alpha;
+    }
+    float getInterpolatedY(float alpha) const {
+        float previous = pool->previousY[index];
+        return previous + (pool->y[index] - previous) * alpha;
+    }
+    float getInterpolatedAngle(float alpha) const {
+        float previous = pool->previousAngle[index];
+        return previous + (pool->angle[index] - previous) * alpha;
+    }
     
     void setPosition(float newX, float newY);
     void setVelocity(float vx, float vy);
+    void setAngle(float newAngle);
     void applyImpulse(float fx, float fy);
     
     // Collision
-    float getRadius() const { return 12.0f; }
+    float getRadius() const { return CarPool::RADIUS; }
+    
+    uint32_t getIndex() const { return index; }
     
 private:
-    float x, y;
-    float velocityX, velocityY;
-    float angle;
-    float angularVelocity;
-    
-    // Visual
-    int colorR, colorG, colorB;
-    
-    // Physics constants
-    static constexpr float ACCELERATION = 500.0f;
-    static constexpr float BRAKE_FORCE = 800.0f;
-    static constexpr float TURN_SPEED = 3.5f;
-    static constexpr float MAX_SPEED = 400.0f;
-    static constexpr float FRICTION = 0.98f;
+    CarPool* pool;
+    uint32_t index;
 };
 
 #endif // CAR_H
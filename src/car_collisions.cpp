@@ -0,0 +1,177 @@
+#include "car_collisions.h"
+#include "car.h"
+#include "physics.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+CarCollisions::CarCollisions()
+    : originX(0), originY(0)
+    , cellSize(1.0f)
+    , columns(0), rows(0)
+    , cellStart(1, 0)
+    , candidatePairs(0)
+{
+}
+
+size_t CarCollisions::resolve(CarPool& pool) {
+    buildGrid(pool);
+    findContacts(pool);
+
+    const float minDistance = 2.0f * CarPool::RADIUS;
+    size_t resolved = 0;
+
+    for (const auto& contact : contacts) {
+        Car a(pool, contact.first);
+        Car b(pool, contact.second);
+
+        // Earlier contacts may already have pushed this pair apart
+        if (!Physics::circleCollision(a.getX(), a.getY(), a.getRadius(),
+                                      b.getX(), b.getY(), b.getRadius())) {
+            continue;
+        }
+
+        float nx = b.getX() - a.getX();
+        float ny = b.getY() - a.getY();
+        float distance = std::sqrt(nx * nx + ny * ny);
+        if (distance > 0.0f) {
+            nx /= distance;
+            ny /= distance;
+        } else {
+            // Stacked exactly on top of each other; split along x
+            nx = 1.0f;
+            ny = 0.0f;
+        }
+
+        // Equal masses: each car moves back half the overlap
+        float push = (minDistance - distance) * 0.5f;
+        a.setPosition(a.getX() - nx * push, a.getY() - ny * push);
+        b.setPosition(b.getX() + nx * push, b.getY() + ny * push);
+
+        // Only exchange momentum if the cars are still closing
+        float closing = (b.getVelocityX() - a.getVelocityX()) * nx +
+                        (b.getVelocityY() - a.getVelocityY()) * ny;
+        if (closing < 0.0f) {
+            float impulse = -(1.0f + RESTITUTION) * closing * 0.5f;
+            a.applyImpulse(-nx * impulse, -ny * impulse);
+            b.applyImpulse(nx * impulse, ny * impulse);
+        }
+        ++resolved;
+    }
+
+    return resolved;
+}
+
+void CarCollisions::buildGrid(const CarPool& pool) {
+    const auto& xs = pool.getPositionsX();
+    const auto& ys = pool.getPositionsY();
+    const size_t count = pool.size();
+
+    columns = 0;
+    rows = 0;
+    cellStart.assign(1, 0);
+    cellItems.clear();
+    carCell.resize(count);
+
+    if (count == 0) {
+        return;
+    }
+
+    // Cars at a non-finite position are left out of the bounds, which would
+    // otherwise never fit a grid; they bin to an edge cell below
+    float minX = FLT_MAX, minY = FLT_MAX;
+    float maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (size_t i = 0; i < count; ++i) {
+        if (std::isfinite(xs[i]) && std::isfinite(ys[i])) {
+            minX = std::min(minX, xs[i]);
+            minY = std::min(minY, ys[i]);
+            maxX = std::max(maxX, xs[i]);
+            maxY = std::max(maxY, ys[i]);
+        }
+    }
+    if (minX > maxX) {
+        minX = minY = maxX = maxY = 0.0f;
+    }
+
+    // Cells one car across, so touching cars are always in neighbouring
+    // cells. Cars spread thinly over a big track get coarser cells to
+    // bound memory.
+    cellSize = 2.0f * CarPool::RADIUS;
+    originX = minX;
+    originY = minY;
+
+    const double maxCells = 4.0 * count + 64.0;
+    for (;;) {
+        double cols = std::floor((static_cast<double>(maxX) - minX) / cellSize) + 1;
+        double rws = std::floor((static_cast<double>(maxY) - minY) / cellSize) + 1;
+        if (cols * rws <= maxCells) {
+            columns = static_cast<int>(cols);
+            rows = static_cast<int>(rws);
+            break;
+        }
+        cellSize *= static_cast<float>(std::max(1.1, std::sqrt(cols * rws / maxCells)));
+    }
+
+    // Counting sort of cars into a compact per-cell layout
+    const size_t cellCount = static_cast<size_t>(columns) * rows;
+    cellStart.assign(cellCount + 1, 0);
+
+    for (size_t i = 0; i < count; ++i) {
+        float fx = (xs[i] - originX) / cellSize;
+        float fy = (ys[i] - originY) / cellSize;
+
+        // Written so that NaN coordinates land in cell 0 instead of out of range
+        int cx = fx > 0.0f ? std::min(static_cast<int>(std::min(fx, 1.0e9f)), columns - 1) : 0;
+        int cy = fy > 0.0f ? std::min(static_cast<int>(std::min(fy, 1.0e9f)), rows - 1) : 0;
+        carCell[i] = static_cast<uint32_t>(cy * columns + cx);
+        ++cellStart[carCell[i] + 1];
+    }
+
+    for (size_t i = 0; i < cellCount; ++i) {
+        cellStart[i + 1] += cellStart[i];
+    }
+
+    cellItems.resize(count);
+    std::vector<uint32_t> fill(cellStart.begin(), cellStart.end() - 1);
+    for (uint32_t i = 0; i < count; ++i) {
+        cellItems[fill[carCell[i]]++] = i;
+    }
+}
+
+void CarCollisions::findContacts(const CarPool& pool) {
+    const auto& xs = pool.getPositionsX();
+    const auto& ys = pool.getPositionsY();
+    const uint32_t count = static_cast<uint32_t>(pool.size());
+
+    contacts.clear();
+    candidatePairs = 0;
+
+    // Each pair is tested once, from its lower-indexed car, and cars are
+    // visited in index order, so contacts come out sorted by first index
+    size_t sortFrom = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        int cx = static_cast<int>(carCell[i] % columns);
+        int cy = static_cast<int>(carCell[i] / columns);
+
+        for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, rows - 1); ++ny) {
+            for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, columns - 1); ++nx) {
+                int cell = ny * columns + nx;
+                for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                    uint32_t j = cellItems[k];
+                    if (j <= i) {
+                        continue;
+                    }
+                    ++candidatePairs;
+                    if (Physics::circleCollision(xs[i], ys[i], CarPool::RADIUS,
+                                                 xs[j], ys[j], CarPool::RADIUS)) {
+                        contacts.emplace_back(i, j);
+                    }
+                }
+            }
+        }
+
+        // Partners of car i arrive in grid order; put them in index order
+        std::sort(contacts.begin() + sortFrom, contacts.end());
+        sortFrom = contacts.size();
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef CAR_COLLISIONS_H
+#define CAR_COLLISIONS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "car_pool.h"
+
+// Car-vs-car collision resolution. The broadphase bins every car into a
+// uniform grid whose cells are at least one car across (counting sort into
+// contiguous cellStart/cellItems, as SpatialGrid does for tiles), so each
+// car is only tested against cars in its own and neighbouring cells.
+//
+// Contacts are resolved in ascending (car, car) index order whatever the
+// grid layout, so results depend only on the cars' state.
+class CarCollisions {
+public:
+    CarCollisions();
+
+    // Separates overlapping cars and exchanges momentum along the contact
+    // normal. Returns the number of contacts resolved.
+    size_t resolve(CarPool& pool);
+
+    // Pairs that reached the narrowphase during the last resolve()
+    size_t getCandidatePairs() const { return candidatePairs; }
+    // Pairs found overlapping during the last resolve()
+    size_t getContactCount() const { return contacts.size(); }
+
+    static constexpr float RESTITUTION = 0.5f;
+
+private:
+    float originX, originY;
+    float cellSize;
+    int columns, rows;
+
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> cellItems;
+    std::vector<uint32_t> carCell;
+    std::vector<std::pair<uint32_t, uint32_t>> contacts;
+    size_t candidatePairs;
+
+    void buildGrid(const CarPool& pool);
+    void findContacts(const CarPool& pool);
+};
+
+#endif // CAR_COLLISIONS_H
@@ -0,0 +1,272 @@
+#include "car_pool.h"
+#include "car.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CAR_POOL_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Cephes-style sinf/cosf: reduce to [-pi/4, pi/4] by octant, then minimax
+// polynomials. Accurate to a couple of ulp for the angles cars reach, and
+// cheap to evaluate four lanes at once.
+constexpr float FOUR_OVER_PI = 1.27323954473516f;
+constexpr float DP1 = 0.78515625f;
+constexpr float DP2 = 2.4187564849853515625e-4f;
+constexpr float DP3 = 3.77489497744594108e-8f;
+constexpr float SIN0 = -1.9515295891e-4f;
+constexpr float SIN1 = 8.3321608736e-3f;
+constexpr float SIN2 = -1.6666654611e-1f;
+constexpr float COS0 = 2.443315711809948e-5f;
+constexpr float COS1 = -1.388731625493765e-3f;
+constexpr float COS2 = 4.166664568298827e-2f;
+
+inline void sinCos(float a, float& sinOut, float& cosOut) {
+    float x = std::fabs(a);
+    int j = static_cast<int>(x * FOUR_OVER_PI);
+    j = (j + 1) & ~1;
+    float y = static_cast<float>(j);
+    x = ((x - y * DP1) - y * DP2) - y * DP3;
+    float z = x * x;
+
+    float cosPoly = ((COS0 * z + COS1) * z + COS2) * z * z - 0.5f * z + 1.0f;
+    float sinPoly = ((SIN0 * z + SIN1) * z + SIN2) * z * x + x;
+
+    bool swap = (j & 2) != 0;
+    float s = swap ? cosPoly : sinPoly;
+    float c = swap ? sinPoly : cosPoly;
+
+    bool negateSin = ((j & 4) != 0) != std::signbit(a);
+    bool negateCos = ((j - 2) & 4) == 0;
+    sinOut = negateSin ? -s : s;
+    cosOut = negateCos ? -c : c;
+}
+
+#ifdef CAR_POOL_SSE2
+
+inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline void sinCos4(__m128 a, __m128& sinOut, __m128& cosOut) {
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    __m128 x = _mm_andnot_ps(signMask, a);
+    __m128 signSin = _mm_and_ps(a, signMask);
+
+    __m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(FOUR_OVER_PI)));
+    j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+    __m128 y = _mm_cvtepi32_ps(j);
+
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP1)));
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP2)));
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP3)));
+    __m128 z = _mm_mul_ps(x, x);
+
+    __m128 cosPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS0), z), _mm_set1_ps(COS1));
+    cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(COS2));
+    cosPoly = _mm_mul_ps(_mm_mul_ps(cosPoly, z), z);
+    cosPoly = _mm_sub_ps(cosPoly, _mm_mul_ps(_mm_set1_ps(0.5f), z));
+    cosPoly = _mm_add_ps(cosPoly, _mm_set1_ps(1.0f));
+
+    __m128 sinPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN0), z), _mm_set1_ps(SIN1));
+    sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(SIN2));
+    sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, z), x), x);
+
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_set1_epi32(2)));
+    __m128 s = select(swap, cosPoly, sinPoly);
+    __m128 c = select(swap, sinPoly, cosPoly);
+
+    __m128 flipSin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29));
+    __m128i jMinus2 = _mm_sub_epi32(j, _mm_set1_epi32(2));
+    __m128 flipCos = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(jMinus2, _mm_set1_epi32(4)), 29));
+
+    sinOut = _mm_xor_ps(s, _mm_xor_ps(flipSin, signSin));
+    cosOut = _mm_xor_ps(c, flipCos);
+}
+
+#endif
+
+} // namespace
+
+CarPool::CarPool() {
+}
+
+Car CarPool::add(float carX, float carY, int r, int g, int b) {
+    x.push_back(carX);
+    y.push_back(carY);
+    velocityX.push_back(0);
+    velocityY.push_back(0);
+    angle.push_back(0);
+    previousX.push_back(carX);
+    previousY.push_back(carY);
+    previousAngle.push_back(0);
+    acceleration.push_back(0);
+    turn.push_back(0);
+    colorR.push_back(static_cast<uint8_t>(r));
+    colorG.push_back(static_cast<uint8_t>(g));
+    colorB.push_back(static_cast<uint8_t>(b));
+    return Car(*this, static_cast<uint32_t>(x.size() - 1));
+}
+
+void CarPool::reserve(size_t count) {
+    for (auto* array : { &x, &y, &velocityX, &velocityY, &angle, &previousX, &previousY,
+                         &previousAngle, &acceleration, &turn }) {
+        array->reserve(count);
+    }
+    colorR.reserve(count);
+    colorG.reserve(count);
+    colorB.reserve(count);
+}
+
+void CarPool::clear() {
+    for (auto* array : { &x, &y, &velocityX, &velocityY, &angle, &previousX, &previousY,
+                         &previousAngle, &acceleration, &turn }) {
+        array->clear();
+    }
+    colorR.clear();
+    colorG.clear();
+    colorB.clear();
+}
+
+void CarPool::setInput(size_t index, const Input& input) {
+    setInput(index, readInput(input));
+}
+
+void CarPool::setInput(size_t index, const InputState& state) {
+    // Same precedence as the keyboard: brake beats throttle, right beats left
+    float accel = 0;
+    float turnAmount = 0;
+
+    if (state.forward) {
+        accel = ACCELERATION;
+    }
+    if (state.backward) {
+        accel = -BRAKE_FORCE;
+    }
+    if (state.left) {
+        turnAmount = -TURN_SPEED;
+    }
+    if (state.right) {
+        turnAmount = TURN_SPEED;
+    }
+
+    acceleration[index] = accel;
+    turn[index] = turnAmount;
+}
+
+void CarPool::beginTick() {
+    previousX = x;
+    previousY = y;
+    previousAngle = angle;
+}
+
+bool CarPool::hasSimd() {
+#ifdef CAR_POOL_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CarPool::integrate(float deltaTime) {
+    integrate(deltaTime, 0, size());
+}
+
+void CarPool::integrate(float deltaTime, size_t begin, size_t end) {
+#ifdef CAR_POOL_SSE2
+    const float friction = std::pow(FRICTION, deltaTime * 60.0f);
+
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 frictionV = _mm_set1_ps(friction);
+    const __m128 maxSpeed = _mm_set1_ps(MAX_SPEED);
+    const __m128 minTurnSpeed = _mm_set1_ps(10.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 vx = _mm_loadu_ps(&velocityX[i]);
+        __m128 vy = _mm_loadu_ps(&velocityY[i]);
+        __m128 a = _mm_loadu_ps(&angle[i]);
+        __m128 accel = _mm_loadu_ps(&acceleration[i]);
+
+        // Apply turning (only when moving)
+        __m128 speed = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)));
+        __m128 turned = _mm_add_ps(a, _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(&turn[i]), dt),
+                                                 _mm_div_ps(speed, maxSpeed)));
+        a = select(_mm_cmpgt_ps(speed, minTurnSpeed), turned, a);
+
+        // Apply acceleration in the direction the car is facing
+        __m128 s, c;
+        sinCos4(a, s, c);
+        __m128 accelerating = _mm_cmpneq_ps(accel, zero);
+        vx = select(accelerating, _mm_add_ps(vx, _mm_mul_ps(_mm_mul_ps(c, accel), dt)), vx);
+        vy = select(accelerating, _mm_add_ps(vy, _mm_mul_ps(_mm_mul_ps(s, accel), dt)), vy);
+
+        // Apply friction
+        vx = _mm_mul_ps(vx, frictionV);
+        vy = _mm_mul_ps(vy, frictionV);
+
+        // Limit max speed
+        speed = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)));
+        __m128 tooFast = _mm_cmpgt_ps(speed, maxSpeed);
+        vx = select(tooFast, _mm_mul_ps(_mm_div_ps(vx, speed), maxSpeed), vx);
+        vy = select(tooFast, _mm_mul_ps(_mm_div_ps(vy, speed), maxSpeed), vy);
+
+        // Update position
+        _mm_storeu_ps(&x[i], _mm_add_ps(_mm_loadu_ps(&x[i]), _mm_mul_ps(vx, dt)));
+        _mm_storeu_ps(&y[i], _mm_add_ps(_mm_loadu_ps(&y[i]), _mm_mul_ps(vy, dt)));
+        _mm_storeu_ps(&velocityX[i], vx);
+        _mm_storeu_ps(&velocityY[i], vy);
+        _mm_storeu_ps(&angle[i], a);
+    }
+
+    integrateScalar(deltaTime, i, end);
+#else
+    integrateScalar(deltaTime, begin, end);
+#endif
+}
+
+void CarPool::integrateScalar(float deltaTime, size_t begin, size_t end) {
+    const float friction = std::pow(FRICTION, deltaTime * 60.0f);
+
+    for (size_t i = begin; i < end; ++i) {
+        float vx = velocityX[i];
+        float vy = velocityY[i];
+        float a = angle[i];
+
+        // Apply turning (only when moving)
+        float speed = std::sqrt(vx * vx + vy * vy);
+        if (speed > 10.0f) {
+            a = a + turn[i] * deltaTime * (speed / MAX_SPEED);
+        }
+
+        // Apply acceleration in the direction the car is facing
+        if (acceleration[i] != 0) {
+            float s, c;
+            sinCos(a, s, c);
+            vx = vx + c * acceleration[i] * deltaTime;
+            vy = vy + s * acceleration[i] * deltaTime;
+        }
+
+        // Apply friction
+        vx *= friction;
+        vy *= friction;
+
+        // Limit max speed
+        speed = std::sqrt(vx * vx + vy * vy);
+        if (speed > MAX_SPEED) {
+            vx = (vx / speed) * MAX_SPEED;
+            vy = (vy / speed) * MAX_SPEED;
+        }
+
+        // Update position
+        x[i] += vx * deltaTime;
+        y[i] += vy * deltaTime;
+        velocityX[i] = vx;
+        velocityY[i] = vy;
+        angle[i] = a;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef CAR_POOL_H
+#define CAR_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "input.h"
+
+class Car;
+
+// Structure-of-arrays storage for every car in a race. Car objects are
+// lightweight handles (pool + index) into it, and integrate() advances all
+// cars at once, four at a time with SSE2 where available.
+//
+// The SIMD and scalar kernels perform the same float operations in the same
+// order, so a car stepped on its own (Car::update) ends up bit-identical to
+// one stepped as part of a batch.
+class CarPool {
+public:
+    // Physics constants
+    static constexpr float ACCELERATION = 500.0f;
+    static constexpr float BRAKE_FORCE = 800.0f;
+    static constexpr float TURN_SPEED = 3.5f;
+    static constexpr float MAX_SPEED = 400.0f;
+    static constexpr float FRICTION = 0.98f; // Velocity kept per 1/60 s
+    static constexpr float RADIUS = 12.0f;   // Collision circle
+
+    CarPool();
+
+    Car add(float x, float y, int r, int g, int b);
+    size_t size() const { return x.size(); }
+    void reserve(size_t count);
+    void clear();
+
+    // Latches the controls used by the next integrate()
+    void setInput(size_t index, const Input& input);
+    void setInput(size_t index, const InputState& state);
+
+    // Remembers every car's pose as the start of the next tick
+    void beginTick();
+
+    void integrate(float deltaTime);
+    void integrate(float deltaTime, size_t begin, size_t end);
+
+    // Portable kernel, used for the tail of a batch and where SSE2 is missing
+    void integrateScalar(float deltaTime, size_t begin, size_t end);
+
+    const std::vector<float>& getPositionsX() const { return x; }
+    const std::vector<float>& getPositionsY() const { return y; }
+
+    static bool hasSimd();
+
+private:
+    friend class Car;
+
+    std::vector<float> x, y;
+    std::vector<float> velocityX, velocityY;
+    std::vector<float> angle;
+    std::vector<float> previousX, previousY, previousAngle;
+
+    // Controls resolved to signed acceleration and turn rate
+    std::vector<float> acceleration;
+    std::vector<float> turn;
+
+    std::vector<uint8_t> colorR, colorG, colorB;
+};
+
+#endif // CAR_POOL_H
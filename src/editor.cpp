@@ -40,8 +40,15 @@ bool Editor::initialize() {
         std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
         return false;
     }
+    // Nothing animates, so follow the display where possible
+    pacer.setVSync(SDL_SetRenderVSync(sdlRenderer, 1));
     
     renderer = std::make_unique<Renderer>(sdlRenderer);
+    trackChunks = std::make_unique<TrackChunks>(*renderer);
+    textRenderer = std::make_unique<TextRenderer>(sdlRenderer);
+    if (textRenderer->loadFont()) {
+        renderer->setTextBackend(textRenderer.get());
+    }
     track = std::make_unique<Track>();
     camera = std::make_unique<Camera>(screenWidth, screenHeight);
     
@@ -63,7 +70,7 @@ void Editor::run() {
         update(deltaTime);
         render();
         
-        SDL_Delay(1);
+        pacer.endFrame();
     }
 }
 
@@ -149,6 +156,12 @@ void Editor::render() {
     SDL_SetRenderDrawColor(sdlRenderer, 40, 40, 40, 255);
     SDL_RenderClear(sdlRenderer);
     
+    // Cull against the window as it is now, not as it was created
+    int outputWidth, outputHeight;
+    if (SDL_GetCurrentRenderOutputSize(sdlRenderer, &outputWidth, &outputHeight)) {
+        camera->setScreenSize(outputWidth, outputHeight);
+    }
+    
     // Apply camera
     camera->apply(sdlRenderer);
     
@@ -166,7 +179,7 @@ void Editor::render() {
     }
     
     // Render track
-    track->render(*renderer, *camera);
+    trackChunks->render(*track, *camera);
     
     // Draw cursor preview
     float worldX = mouseX + camera->getX();
@@ -200,6 +213,7 @@ void Editor::render() {
     float screenX = snapX - camera->getX();
     float screenY = snapY - camera->getY();
     renderer->drawRect(screenX, screenY, tileSize, tileSize, r, g, b, false);
+    renderer->flush();
     
     camera->reset(sdlRenderer);
     
@@ -218,6 +232,7 @@ void Editor::render() {
         case EditorTool::MOVE_CAMERA: toolName = "Pan"; break;
     }
     renderer->renderText("Tool: " + toolName, 10, 80, 255, 215, 0);
+    renderer->flush();
     
     SDL_RenderPresent(sdlRenderer);
 }
@@ -258,6 +273,8 @@ void Editor::saveTrack() {
     std::string filename = "tracks/" + currentTrackName;
     if (track->saveToFile(filename)) {
         std::cout << "Track saved to " << filename << std::endl;
+        TileMergeStats merged = track->mergeTiles();
+        std::cout << merged.tiles << " tiles drawn as " << merged.drawTiles << " rectangles" << std::endl;
     }
 }
 
@@ -269,6 +286,12 @@ void Editor::loadTrack() {
 }
 
 void Editor::cleanup() {
+    // Chunk and glyph textures go before the SDL renderer that owns them
+    trackChunks.reset();
+    if (renderer) {
+        renderer->setTextBackend(nullptr);
+    }
+    textRenderer.reset();
     if (sdlRenderer) {
         SDL_DestroyRenderer(sdlRenderer);
         sdlRenderer = nullptr;
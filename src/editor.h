@@ -5,7 +5,10 @@
 #include <memory>
 #include "track.h"
 #include "renderer.h"
+#include "track_chunks.h"
+#include "text_renderer.h"
 #include "camera.h"
+#include "frame_pacer.h"
 
 enum class EditorTool {
     PLACE_TRACK,
@@ -38,8 +41,11 @@ private:
     SDL_Renderer* sdlRenderer;
     
     std::unique_ptr<Renderer> renderer;
+    std::unique_ptr<TrackChunks> trackChunks;
+    std::unique_ptr<TextRenderer> textRenderer;
     std::unique_ptr<Track> track;
     std::unique_ptr<Camera> camera;
+    FramePacer pacer;
     
     EditorTool currentTool;
     bool running;
@@ -0,0 +1,368 @@
+#include "flow_field.h"
+#include "track.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+FlowField::FlowField()
+    : originX(0), originY(0)
+    , cellSize(CELL_SIZE)
+    , columns(0), rows(0)
+    , hasLine(false)
+{
+}
+
+void FlowField::clear() {
+    columns = 0;
+    rows = 0;
+    hasLine = false;
+    line.clear();
+    drivable.clear();
+    edgeDistance.clear();
+    directionX.clear();
+    directionY.clear();
+    speed.clear();
+    owner.clear();
+    ownerSteps.clear();
+    roadOwned.clear();
+}
+
+void FlowField::build(const Track& track) {
+    clear();
+
+    const auto& tiles = track.getTiles();
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+    size_t drivableCount = 0;
+    for (const auto& tile : tiles) {
+        if (!isDrivable(tile.type)) {
+            continue;
+        }
+        float tileMinX, tileMinY, tileMaxX, tileMaxY;
+        tileBounds(tile, tileMinX, tileMinY, tileMaxX, tileMaxY);
+        if (drivableCount == 0) {
+            minX = tileMinX;
+            minY = tileMinY;
+            maxX = tileMaxX;
+            maxY = tileMaxY;
+        }
+        minX = std::min(minX, tileMinX);
+        minY = std::min(minY, tileMinY);
+        maxX = std::max(maxX, tileMaxX);
+        maxY = std::max(maxY, tileMaxY);
+        ++drivableCount;
+    }
+    if (drivableCount == 0) {
+        return;
+    }
+
+    // A margin of grass round the road, so the edge of the grid is never
+    // drivable and cars that run wide still find their way back
+    minX -= LOOKAHEAD;
+    minY -= LOOKAHEAD;
+    maxX += LOOKAHEAD;
+    maxY += LOOKAHEAD;
+
+    // Big tracks get coarser cells to bound memory
+    cellSize = CELL_SIZE;
+    for (;;) {
+        double cols = std::ceil((static_cast<double>(maxX) - minX) / cellSize);
+        double rws = std::ceil((static_cast<double>(maxY) - minY) / cellSize);
+        if (!std::isfinite(cols * rws)) {
+            clear();
+            return;
+        }
+        if (cols * rws <= MAX_CELLS) {
+            columns = static_cast<int>(cols);
+            rows = static_cast<int>(rws);
+            break;
+        }
+        cellSize *= static_cast<float>(std::max(1.1, std::sqrt(cols * rws / MAX_CELLS)));
+    }
+    originX = minX;
+    originY = minY;
+
+    const size_t cellCount = static_cast<size_t>(columns) * rows;
+    drivable.assign(cellCount, 0);
+    edgeDistance.assign(cellCount, 0.0f);
+    directionX.assign(cellCount, 0.0f);
+    directionY.assign(cellCount, 0.0f);
+    speed.assign(cellCount, 0.0f);
+    owner.assign(cellCount, -1);
+    ownerSteps.assign(cellCount, 0);
+    roadOwned.assign(cellCount, 0);
+    line = track.getRacingLine().getPoints();
+    hasLine = !line.empty();
+
+    rasterise(track, 0, 0, columns - 1, rows - 1);
+    measureEdges(0, 0, columns - 1, rows - 1);
+    claimCells(0, 0, columns - 1, rows - 1);
+    followLine(0, 0, columns - 1, rows - 1);
+}
+
+void FlowField::update(const Track& track, float minX, float minY, float maxX, float maxY) {
+    if (empty() || !covers(minX, minY, maxX, maxY)) {
+        build(track);
+        return;
+    }
+
+    auto column = [this](float x) { return std::clamp(static_cast<int>(std::floor((x - originX) / cellSize)), 0, columns - 1); };
+    auto row = [this](float y) { return std::clamp(static_cast<int>(std::floor((y - originY) / cellSize)), 0, rows - 1); };
+
+    int x0 = column(minX) - 1, y0 = row(minY) - 1;
+    int x1 = column(maxX) + 1, y1 = row(maxY) + 1;
+    rasterise(track, std::max(x0, 0), std::max(y0, 0), std::min(x1, columns - 1), std::min(y1, rows - 1));
+
+    // Capped distances cannot change further than EDGE_RANGE from the edit
+    int reach = edgeCells();
+    measureEdges(std::max(x0 - reach, 0), std::max(y0 - reach, 0),
+                 std::min(x1 + reach, columns - 1), std::min(y1 + reach, rows - 1));
+
+    // Owners are re-flooded over the same window from the cells around
+    // it, and directions one cell further, where the edge gradient reads
+    // a changed distance
+    claimCells(std::max(x0 - reach, 0), std::max(y0 - reach, 0),
+               std::min(x1 + reach, columns - 1), std::min(y1 + reach, rows - 1));
+    reach = refreshCells() - 1;
+    followLine(std::max(x0 - reach, 0), std::max(y0 - reach, 0),
+               std::min(x1 + reach, columns - 1), std::min(y1 + reach, rows - 1));
+}
+
+bool FlowField::covers(float minX, float minY, float maxX, float maxY) const {
+    return minX >= originX && minY >= originY &&
+           maxX <= originX + columns * cellSize && maxY <= originY + rows * cellSize;
+}
+
+int FlowField::edgeCells() const {
+    return static_cast<int>(std::ceil(EDGE_RANGE / cellSize)) + 1;
+}
+
+int FlowField::refreshCells() const {
+    // The rasterised cell round the edit, the edge window and the gradient
+    return edgeCells() + 2;
+}
+
+bool FlowField::sample(float x, float y, FlowSample& out) const {
+    if (columns == 0 || !hasLine) {
+        return false;
+    }
+
+    float fx = (x - originX) / cellSize;
+    float fy = (y - originY) / cellSize;
+
+    // Written so that NaN coordinates land in cell 0 instead of out of range
+    int cx = fx > 0.0f ? std::min(static_cast<int>(std::min(fx, 1.0e9f)), columns - 1) : 0;
+    int cy = fy > 0.0f ? std::min(static_cast<int>(std::min(fy, 1.0e9f)), rows - 1) : 0;
+    size_t cell = static_cast<size_t>(cy) * columns + cx;
+
+    out.directionX = directionX[cell];
+    out.directionY = directionY[cell];
+    out.speed = speed[cell];
+    out.edgeDistance = edgeDistance[cell];
+    return true;
+}
+
+void FlowField::rasterise(const Track& track, int x0, int y0, int x1, int y1) {
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            float x = originX + (cx + 0.5f) * cellSize;
+            float y = originY + (cy + 0.5f) * cellSize;
+            drivable[static_cast<size_t>(cy) * columns + cx] = track.isOnTrack(x, y) ? 1 : 0;
+        }
+    }
+}
+
+void FlowField::measureEdges(int x0, int y0, int x1, int y1) {
+    const float straight = cellSize;
+    const float diagonal = cellSize * 1.41421356f;
+
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            size_t cell = static_cast<size_t>(cy) * columns + cx;
+            edgeDistance[cell] = drivable[cell] ? EDGE_RANGE : 0.0f;
+        }
+    }
+
+    // Cells just outside the window keep their (unaffected) distances and
+    // act as fixed boundary values for both passes
+    auto relax = [&](size_t cell, int nx, int ny, float step) {
+        if (nx >= 0 && nx < columns && ny >= 0 && ny < rows) {
+            float via = edgeDistance[static_cast<size_t>(ny) * columns + nx] + step;
+            edgeDistance[cell] = std::min(edgeDistance[cell], via);
+        }
+    };
+
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            size_t cell = static_cast<size_t>(cy) * columns + cx;
+            relax(cell, cx - 1, cy, straight);
+            relax(cell, cx - 1, cy - 1, diagonal);
+            relax(cell, cx, cy - 1, straight);
+            relax(cell, cx + 1, cy - 1, diagonal);
+        }
+    }
+
+    for (int cy = y1; cy >= y0; --cy) {
+        for (int cx = x1; cx >= x0; --cx) {
+            size_t cell = static_cast<size_t>(cy) * columns + cx;
+            relax(cell, cx + 1, cy, straight);
+            relax(cell, cx + 1, cy + 1, diagonal);
+            relax(cell, cx, cy + 1, straight);
+            relax(cell, cx - 1, cy + 1, diagonal);
+        }
+    }
+}
+
+void FlowField::claimCells(int x0, int y0, int x1, int y1) {
+    if (!hasLine) {
+        return;
+    }
+
+    auto inWindow = [=](int cx, int cy) { return cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1; };
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            size_t cell = static_cast<size_t>(cy) * columns + cx;
+            owner[cell] = -1;
+            roadOwned[cell] = 0;
+        }
+    }
+
+    // Breadth-first from seeds given as (steps, cell), already claimed or
+    // outside the window; a seed joins once the flood has caught up with it
+    std::vector<std::pair<uint32_t, uint32_t>> seeds;
+    std::vector<std::pair<uint32_t, uint32_t>> queue;
+    auto flood = [&](bool roadOnly) {
+        std::stable_sort(seeds.begin(), seeds.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        queue.clear();
+        size_t head = 0, nextSeed = 0;
+        while (head < queue.size() || nextSeed < seeds.size()) {
+            bool fromSeed = nextSeed < seeds.size() &&
+                            (head == queue.size() || seeds[nextSeed].first <= queue[head].first);
+            auto [steps, cell] = fromSeed ? seeds[nextSeed++] : queue[head++];
+            int cx = static_cast<int>(cell % columns);
+            int cy = static_cast<int>(cell / columns);
+            const int neighbours[4][2] = { { cx - 1, cy }, { cx + 1, cy }, { cx, cy - 1 }, { cx, cy + 1 } };
+            for (const auto& n : neighbours) {
+                if (!inWindow(n[0], n[1])) {
+                    continue;
+                }
+                size_t next = static_cast<size_t>(n[1]) * columns + n[0];
+                if (owner[next] < 0 && (!roadOnly || drivable[next])) {
+                    owner[next] = owner[cell];
+                    ownerSteps[next] = steps + 1;
+                    roadOwned[next] = roadOnly;
+                    queue.push_back({ steps + 1, static_cast<uint32_t>(next) });
+                }
+            }
+        }
+        seeds.clear();
+    };
+
+    // Cells bordering the window keep their owners and seed the flood
+    std::vector<uint32_t> ring;
+    for (int cy = y0 - 1; cy <= y1 + 1; ++cy) {
+        for (int cx = x0 - 1; cx <= x1 + 1; ++cx) {
+            if (cx >= 0 && cx < columns && cy >= 0 && cy < rows && !inWindow(cx, cy)) {
+                ring.push_back(static_cast<uint32_t>(static_cast<size_t>(cy) * columns + cx));
+            }
+        }
+    }
+
+    // Along the road from the line points, whether or not their own cell
+    // reads as drivable
+    for (size_t i = 0; i < line.size(); ++i) {
+        int cx = std::clamp(static_cast<int>((line[i].x - originX) / cellSize), 0, columns - 1);
+        int cy = std::clamp(static_cast<int>((line[i].y - originY) / cellSize), 0, rows - 1);
+        size_t cell = static_cast<size_t>(cy) * columns + cx;
+        if (inWindow(cx, cy) && owner[cell] < 0) {
+            owner[cell] = static_cast<int32_t>(i);
+            ownerSteps[cell] = 0;
+            roadOwned[cell] = 1;
+            seeds.push_back({ 0, static_cast<uint32_t>(cell) });
+        }
+    }
+    for (uint32_t cell : ring) {
+        if (roadOwned[cell]) {
+            seeds.push_back({ ownerSteps[cell], cell });
+        }
+    }
+    flood(true);
+
+    // Then off the road, from the nearest cell the road flood reached
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            size_t cell = static_cast<size_t>(cy) * columns + cx;
+            if (roadOwned[cell]) {
+                seeds.push_back({ 0, static_cast<uint32_t>(cell) });
+            }
+        }
+    }
+    for (uint32_t cell : ring) {
+        if (owner[cell] >= 0) {
+            seeds.push_back({ roadOwned[cell] ? 0 : ownerSteps[cell], cell });
+        }
+    }
+    flood(false);
+}
+
+void FlowField::followLine(int x0, int y0, int x1, int y1) {
+    if (!hasLine) {
+        return;
+    }
+
+    auto edgeAt = [this](int cx, int cy) {
+        cx = std::clamp(cx, 0, columns - 1);
+        cy = std::clamp(cy, 0, rows - 1);
+        return edgeDistance[static_cast<size_t>(cy) * columns + cx];
+    };
+    auto following = [this](size_t index) { return index + 1 < line.size() ? index + 1 : 0; };
+
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            size_t cell = static_cast<size_t>(cy) * columns + cx;
+            float x = originX + (cx + 0.5f) * cellSize;
+            float y = originY + (cy + 0.5f) * cellSize;
+
+            // Aim LOOKAHEAD along the line from the nearest point
+            size_t target = static_cast<size_t>(std::max(owner[cell], 0));
+            for (size_t step = 0; step < line.size(); ++step) {
+                float dx = line[target].x - x;
+                float dy = line[target].y - y;
+                if (dx * dx + dy * dy >= LOOKAHEAD * LOOKAHEAD) {
+                    break;
+                }
+                target = following(target);
+            }
+
+            float dirX = line[target].x - x;
+            float dirY = line[target].y - y;
+            float length = std::hypot(dirX, dirY);
+            if (length > 0.0f) {
+                dirX /= length;
+                dirY /= length;
+            }
+
+            // Near an edge, lean towards open road, harder the closer it is
+            float edge = edgeDistance[cell];
+            if (drivable[cell] && edge < EDGE_RANGE) {
+                float gradX = edgeAt(cx + 1, cy) - edgeAt(cx - 1, cy);
+                float gradY = edgeAt(cx, cy + 1) - edgeAt(cx, cy - 1);
+                float gradLength = std::hypot(gradX, gradY);
+                if (gradLength > 0.0f) {
+                    float weight = EDGE_PUSH * (1.0f - edge / EDGE_RANGE);
+                    dirX += gradX / gradLength * weight;
+                    dirY += gradY / gradLength * weight;
+                    length = std::hypot(dirX, dirY);
+                    if (length > 0.0f) {
+                        dirX /= length;
+                        dirY /= length;
+                    }
+                }
+            }
+
+            directionX[cell] = dirX;
+            directionY[cell] = dirY;
+            speed[cell] = line[target].speed;
+        }
+    }
+}
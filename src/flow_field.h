@@ -0,0 +1,95 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "racing_line.h"
+
+class Track;
+
+// What a bot needs to know about the spot it is on
+struct FlowSample {
+    float directionX, directionY; // Unit vector to steer along
+    float speed;                  // Target speed here
+    float edgeDistance;           // Distance to the nearest non-drivable cell, up to EDGE_RANGE
+};
+
+// Grid over a track holding, per cell, the direction to drive and how far
+// the road edge is. Bots look up the cell under their car instead of
+// tracking a target on the racing line themselves.
+//
+// Edge distances come from a two-pass chamfer transform over a drivable
+// mask, capped at EDGE_RANGE so an edit only disturbs cells within that
+// range of it. Road cells are claimed by their nearest racing line point
+// with a breadth-first flood that never leaves the road, so a thin wall
+// keeps the roads either side of it apart; every other cell then takes
+// the owner of the nearest claimed cell. A cell's direction aims
+// LOOKAHEAD further along the line, bent away from an edge that is closer
+// than EDGE_RANGE.
+//
+// Cells start at CELL_SIZE and grow on tracks too big to cover in
+// MAX_CELLS of them.
+class FlowField {
+public:
+    static constexpr float CELL_SIZE = 10.0f;
+    static constexpr float EDGE_RANGE = 30.0f;
+    static constexpr float EDGE_PUSH = 0.5f; // Lean at the very edge, against 1 along the line
+    static constexpr float LOOKAHEAD = 120.0f;
+    static constexpr size_t MAX_CELLS = 1 << 21;
+
+    FlowField();
+
+    // Lays the grid over the drivable tiles and follows the track's racing
+    // line, keeping a copy of it for update()
+    void build(const Track& track);
+
+    // Refreshes the cells within getRefreshRange() of a change inside
+    // [minX, maxX] x [minY, maxY]: drivability, edge distances and which
+    // point of the kept line each cell follows. Cells farther away keep
+    // theirs, and the racing line is not rebuilt. Falls back to build()
+    // when the change reaches outside the grid.
+    void update(const Track& track, float minX, float minY, float maxX, float maxY);
+    float getRefreshRange() const { return refreshCells() * cellSize; }
+
+    void clear();
+
+    bool empty() const { return columns == 0; }
+
+    // Cell under (x, y), clamped to the grid; false if the field is empty
+    // or the track has no racing line
+    bool sample(float x, float y, FlowSample& out) const;
+
+    float getOriginX() const { return originX; }
+    float getOriginY() const { return originY; }
+    float getCellSize() const { return cellSize; }
+    int getColumns() const { return columns; }
+    int getRows() const { return rows; }
+
+private:
+    float originX, originY;
+    float cellSize;
+    int columns, rows;
+    bool hasLine;
+    std::vector<RacingPoint> line; // As of the last build()
+
+    std::vector<uint8_t> drivable;
+    std::vector<float> edgeDistance;
+    std::vector<float> directionX, directionY;
+    std::vector<float> speed;
+    // Nearest line point per cell, how many steps the flood took to get
+    // there, and whether it came along the road
+    std::vector<int32_t> owner;
+    std::vector<uint32_t> ownerSteps;
+    std::vector<uint8_t> roadOwned;
+
+    bool covers(float minX, float minY, float maxX, float maxY) const;
+    int edgeCells() const;
+    int refreshCells() const;
+    void rasterise(const Track& track, int x0, int y0, int x1, int y1);
+    void measureEdges(int x0, int y0, int x1, int y1);
+    void claimCells(int x0, int y0, int x1, int y1);
+    void followLine(int x0, int y0, int x1, int y1);
+};
+
+#endif // FLOW_FIELD_H
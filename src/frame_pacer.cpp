@@ -0,0 +1,127 @@
+#include "frame_pacer.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+// Bounds for the early-wake margin. The floor covers timer granularity on
+// good systems; the ceiling stops one descheduled sleep costing a frame of
+// spinning.
+const std::chrono::microseconds MIN_SPIN_MARGIN(200);
+const std::chrono::microseconds MAX_SPIN_MARGIN(4000);
+const std::chrono::microseconds INITIAL_SPIN_MARGIN(1000);
+
+double toMilliseconds(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+// Nearest-rank percentile of the first n values, which it reorders
+double percentile(std::vector<float>& values, size_t n, double fraction) {
+    size_t rank = static_cast<size_t>(std::ceil(fraction * n));
+    size_t index = rank > 0 ? std::min(rank, n) - 1 : 0;
+    std::nth_element(values.begin(), values.begin() + index, values.begin() + n);
+    return values[index];
+}
+
+} // namespace
+
+FramePacer::FramePacer(double targetFps)
+    : targetFps(0.0)
+    , vsync(false)
+    , framePeriod(0)
+    , started(false)
+    , spinMargin(INITIAL_SPIN_MARGIN)
+    , samples(SAMPLE_COUNT)
+    , nextSample(0)
+    , sampleCount(0)
+{
+    setTargetFps(targetFps);
+}
+
+void FramePacer::setTargetFps(double fps) {
+    targetFps = fps > 0.0 ? fps : 0.0;
+    framePeriod = targetFps > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFps))
+        : Clock::duration(0);
+    started = false; // Restart the cadence from the next frame
+}
+
+void FramePacer::endFrame() {
+    const bool paced = targetFps > 0.0 && !vsync;
+    if (!started) {
+        lastFrame = Clock::now();
+        deadline = lastFrame + framePeriod;
+        started = true;
+        return;
+    }
+
+    if (paced) {
+        sleepUntil(deadline);
+    }
+
+    Clock::time_point now = Clock::now();
+    samples[nextSample] = static_cast<float>(toMilliseconds(now - lastFrame));
+    nextSample = (nextSample + 1) % SAMPLE_COUNT;
+    sampleCount = std::min(sampleCount + 1, SAMPLE_COUNT);
+    lastFrame = now;
+
+    if (paced) {
+        // Keep the cadence, unless this frame ran more than a period late
+        deadline += framePeriod;
+        if (deadline < now) {
+            deadline = now + framePeriod;
+        }
+    }
+}
+
+void FramePacer::sleepUntil(Clock::time_point wakeTime) {
+    Clock::time_point now = Clock::now();
+    if (wakeTime - now > spinMargin) {
+        Clock::duration requested = wakeTime - spinMargin - now;
+        std::this_thread::sleep_for(requested);
+
+        // Widen the margin straight away when the OS oversleeps, narrow it
+        // slowly when it is on time
+        Clock::duration overshoot = Clock::now() - now - requested;
+        Clock::duration wanted = overshoot + overshoot / 4;
+        if (wanted > spinMargin) {
+            spinMargin = wanted;
+        } else {
+            spinMargin -= (spinMargin - wanted) / 16;
+        }
+        spinMargin = std::min<Clock::duration>(std::max<Clock::duration>(spinMargin, MIN_SPIN_MARGIN),
+                                               MAX_SPIN_MARGIN);
+    }
+
+    while (Clock::now() < wakeTime) {
+        std::this_thread::yield();
+    }
+}
+
+FrameTimeStats FramePacer::getStats() const {
+    FrameTimeStats stats = {};
+    stats.frames = sampleCount;
+    if (sampleCount == 0) {
+        return stats;
+    }
+
+    std::vector<float> sorted(samples.begin(), samples.begin() + sampleCount);
+    stats.p50 = percentile(sorted, sampleCount, 0.50);
+    stats.p99 = percentile(sorted, sampleCount, 0.99);
+    stats.max = *std::max_element(sorted.begin(), sorted.end());
+
+    const double expected = framePeriod.count() > 0 && !vsync ? toMilliseconds(framePeriod) : stats.p50;
+    stats.hitches = std::count_if(sorted.begin(), sorted.end(),
+                                  [expected](float ms) { return ms > 2.0 * expected; });
+    return stats;
+}
+
+void FramePacer::resetStats() {
+    nextSample = 0;
+    sampleCount = 0;
+}
+
+double FramePacer::getSpinMargin() const {
+    return toMilliseconds(spinMargin);
+}
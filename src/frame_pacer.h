@@ -0,0 +1,68 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+struct FrameTimeStats {
+    size_t frames;  // Frames in the sample window
+    double p50;     // Milliseconds
+    double p99;
+    double max;
+    size_t hitches; // Frames over twice the target period (the median when not paced)
+};
+
+// Ends each main loop iteration at a steady rate and records frame times.
+//
+// With a target rate, endFrame() sleeps until the next deadline, waking
+// early by a margin learned from how far past its request the OS has been
+// oversleeping, and spins the rest of the way. A frame more than a period
+// late moves the deadline on instead of rushing frames to catch up. With
+// vsync the present call already waits, so nothing is added; uncapped
+// (target 0) never waits, for benchmarks and headless runs.
+class FramePacer {
+public:
+    static constexpr double DEFAULT_FPS = 60.0;
+    static constexpr size_t SAMPLE_COUNT = 1024; // Frame times kept for stats
+
+    explicit FramePacer(double targetFps = DEFAULT_FPS);
+
+    // 0 runs uncapped
+    void setTargetFps(double fps);
+    double getTargetFps() const { return targetFps; }
+
+    // Present blocks on the display, so the pacer only measures
+    void setVSync(bool enabled) { vsync = enabled; }
+    bool isVSync() const { return vsync; }
+
+    // Waits out the rest of the frame, then starts timing the next one
+    void endFrame();
+
+    // Percentiles over the last SAMPLE_COUNT frames
+    FrameTimeStats getStats() const;
+    void resetStats();
+
+    // Current early-wake margin, in milliseconds
+    double getSpinMargin() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    double targetFps;
+    bool vsync;
+    Clock::duration framePeriod;
+    Clock::time_point deadline;
+    Clock::time_point lastFrame;
+    bool started;
+
+    Clock::duration spinMargin;
+
+    std::vector<float> samples; // Ring buffer of frame times in ms
+    size_t nextSample;
+    size_t sampleCount;
+
+    void sleepUntil(Clock::time_point wakeTime);
+};
+
+#endif // FRAME_PACER_H
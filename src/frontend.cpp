@@ -1,4 +1,5 @@
 #include "frontend.h"
+#include <algorithm>
 #include <iostream>
 
 SDLFrontend::SDLFrontend()
@@ -39,8 +40,12 @@ bool SDLFrontend::pollEvent(SDL_Event& event) {
     return SDL_PollEvent(&event);
 }
 
-void SDLFrontend::delay(Uint32 ms) {
-    SDL_Delay(ms);
+bool SDLFrontend::setVSync(bool enabled) {
+    return renderer && SDL_SetRenderVSync(renderer, enabled ? 1 : SDL_RENDERER_VSYNC_DISABLED);
+}
+
+double SDLFrontend::getTime() {
+    return SDL_GetTicksNS() / 1e9;
 }
 
 void SDLFrontend::clear(int r, int g, int b, int a) {
@@ -69,3 +74,112 @@ void SDLFrontend::cleanup() {
 
     SDL_Quit();
 }
+
+HeadlessFrontend::HeadlessFrontend(double frameSeconds, bool offscreen)
+    : frameSeconds(frameSeconds)
+    , offscreen(offscreen)
+    , frame(0)
+    , nextEvent(0)
+    , surface(nullptr)
+    , renderer(nullptr)
+{
+}
+
+HeadlessFrontend::~HeadlessFrontend() {
+    cleanup();
+}
+
+void HeadlessFrontend::scriptEvent(uint64_t eventFrame, const SDL_Event& event) {
+    // Keep the script ordered by frame; events on the same frame stay in
+    // the order they were added
+    auto it = std::upper_bound(script.begin() + nextEvent, script.end(), eventFrame,
+        [](uint64_t f, const ScriptedEvent& e) { return f < e.frame; });
+    script.insert(it, { eventFrame, event });
+}
+
+void HeadlessFrontend::scriptKey(uint64_t eventFrame, SDL_Keycode key, SDL_Scancode scancode, bool down) {
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = down ? SDL_EVENT_KEY_DOWN : SDL_EVENT_KEY_UP;
+    event.key.key = key;
+    event.key.scancode = scancode;
+    event.key.down = down;
+    scriptEvent(eventFrame, event);
+}
+
+bool HeadlessFrontend::initialize() {
+    // No video subsystem: this must work without a display
+    if (!SDL_Init(SDL_INIT_EVENTS)) {
+        std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool HeadlessFrontend::createWindow(const std::string& title, int width, int height, bool resizable) {
+    if (!offscreen) {
+        return true;
+    }
+
+    surface = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_ARGB8888);
+    if (!surface) {
+        std::cerr << "Offscreen surface creation failed: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    renderer = SDL_CreateSoftwareRenderer(surface);
+    if (!renderer) {
+        std::cerr << "Software renderer creation failed: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool HeadlessFrontend::pollEvent(SDL_Event& event) {
+    if (nextEvent < script.size() && script[nextEvent].frame <= frame) {
+        event = script[nextEvent++].event;
+        return true;
+    }
+    return false;
+}
+
+bool HeadlessFrontend::setVSync(bool enabled) {
+    // No display to wait on
+    return false;
+}
+
+double HeadlessFrontend::getTime() {
+    return frame * frameSeconds;
+}
+
+void HeadlessFrontend::clear(int r, int g, int b, int a) {
+    if (renderer) {
+        SDL_SetRenderDrawColor(renderer, r, g, b, a);
+        SDL_RenderClear(renderer);
+    }
+}
+
+void HeadlessFrontend::present() {
+    if (renderer) {
+        SDL_RenderPresent(renderer);
+    }
+    ++frame;
+}
+
+SDL_Renderer* HeadlessFrontend::getRenderer() {
+    return renderer;
+}
+
+void HeadlessFrontend::cleanup() {
+    if (renderer) {
+        SDL_DestroyRenderer(renderer);
+        renderer = nullptr;
+    }
+
+    if (surface) {
+        SDL_DestroySurface(surface);
+        surface = nullptr;
+    }
+
+    SDL_Quit();
+}
@@ -3,6 +3,7 @@
 
 #include <SDL3/SDL.h>
 #include <string>
+#include <vector>
 
 class Frontend {
 public:
@@ -11,7 +12,8 @@ public:
     virtual bool initialize() = 0;
     virtual bool createWindow(const std::string& title, int width, int height, bool resizable) = 0;
     virtual bool pollEvent(SDL_Event& event) = 0;
-    virtual void delay(Uint32 ms) = 0;
+    virtual bool setVSync(bool enabled) = 0; // False if unsupported
+    virtual double getTime() = 0; // Seconds, drives the game clock
     virtual void clear(int r, int g, int b, int a) = 0;
     virtual void present() = 0;
     virtual SDL_Renderer* getRenderer() = 0;
@@ -26,7 +28,8 @@ public:
     bool initialize() override;
     bool createWindow(const std::string& title, int width, int height, bool resizable) override;
     bool pollEvent(SDL_Event& event) override;
-    void delay(Uint32 ms) override;
+    bool setVSync(bool enabled) override;
+    double getTime() override;
     void clear(int r, int g, int b, int a) override;
     void present() override;
     SDL_Renderer* getRenderer() override;
@@ -37,4 +40,46 @@ private:
     SDL_Renderer* renderer;
 };
 
+// Frontend without a window, for CI, servers and benchmarks. Events come from
+// a script keyed by frame number and the clock advances by a fixed step per
+// presented frame, so runs are reproducible and never wait on vsync. With
+// offscreen rendering enabled, frames are drawn by SDL's software renderer
+// into a surface; otherwise getRenderer() returns null and drawing is a no-op.
+class HeadlessFrontend : public Frontend {
+public:
+    HeadlessFrontend(double frameSeconds, bool offscreen = false);
+    ~HeadlessFrontend() override;
+
+    // Queues an event to be returned by pollEvent() once frame is reached
+    void scriptEvent(uint64_t frame, const SDL_Event& event);
+    void scriptKey(uint64_t frame, SDL_Keycode key, SDL_Scancode scancode, bool down);
+
+    bool initialize() override;
+    bool createWindow(const std::string& title, int width, int height, bool resizable) override;
+    bool pollEvent(SDL_Event& event) override;
+    bool setVSync(bool enabled) override;
+    double getTime() override;
+    void clear(int r, int g, int b, int a) override;
+    void present() override;
+    SDL_Renderer* getRenderer() override;
+    void cleanup() override;
+
+    uint64_t getFrame() const { return frame; }
+
+private:
+    struct ScriptedEvent {
+        uint64_t frame;
+        SDL_Event event;
+    };
+
+    double frameSeconds;
+    bool offscreen;
+    uint64_t frame;
+    std::vector<ScriptedEvent> script;
+    size_t nextEvent;
+
+    SDL_Surface* surface;
+    SDL_Renderer* renderer;
+};
+
 #endif // FRONTEND_H
@@ -1,10 +1,16 @@
 #include "game.h"
 #include <iostream>
 #include <chrono>
+#include <iomanip>
+#include <cstdio>
 
 Game::Game()
     : state(GameState::MENU)
     , running(false)
+    , tickAccumulator(0)
+    , tickLimit(0)
+    , vsyncRequested(false)
+    , showProfiler(false)
     , screenWidth(1280)
     , screenHeight(720)
     , soundEnabled(true)
@@ -16,8 +22,8 @@ Game::~Game() {
     cleanup();
 }
 
-bool Game::initialize() {
-    frontend = std::make_unique<SDLFrontend>();
+bool Game::initialize(std::unique_ptr<Frontend> gameFrontend) {
+    frontend = std::move(gameFrontend);
     if (!frontend->initialize()) {
         return false;
     }
@@ -25,11 +31,22 @@ bool Game::initialize() {
     if (!frontend->createWindow("Micro Racing Game", screenWidth, screenHeight, true)) {
         return false;
     }
+    if (vsyncRequested) {
+        pacer.setVSync(frontend->setVSync(true));
+    }
     
     // Initialize subsystems
     renderer = std::make_unique<Renderer>(frontend->getRenderer());
+    trackChunks = std::make_unique<TrackChunks>(*renderer);
+    textRenderer = std::make_unique<TextRenderer>(frontend->getRenderer());
+    if (textRenderer->loadFont()) {
+        renderer->setTextBackend(textRenderer.get());
+    }
     menu = std::make_unique<Menu>(renderer.get());
-    input = std::make_unique<Input>();
+    if (!tracePath.empty()) {
+        Profiler::setEnabled(true);
+    }
+    input = std::make_unique<KeyboardInput>();
     camera = std::make_unique<Camera>(screenWidth, screenHeight);
     
     running = true;
@@ -37,11 +54,12 @@ bool Game::initialize() {
 }
 
 void Game::run() {
-    auto lastTime = std::chrono::high_resolution_clock::now();
+    auto wallStart = std::chrono::steady_clock::now();
+    double lastTime = frontend->getTime();
 
     while (running) {
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        float deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
+        double currentTime = frontend->getTime();
+        float deltaTime = static_cast<float>(currentTime - lastTime);
         lastTime = currentTime;
         
         // Cap delta time to avoid large jumps
@@ -49,13 +67,48 @@ void Game::run() {
 
         handleEvents();
         update(deltaTime);
-        render();
+        render(tickAccumulator / Simulation::TICK_SECONDS);
 
-        frontend->delay(1); // Small delay to prevent 100% CPU usage
+        Profiler::endFrame();
+        pacer.endFrame();
+    }
+
+    saveRecording();
+
+    FrameTimeStats frames = pacer.getStats();
+    std::cout << "Frame times over the last " << frames.frames << " frames: p50 " << frames.p50
+              << " ms, p99 " << frames.p99 << " ms, max " << frames.max << " ms, "
+              << frames.hitches << " hitches" << std::endl;
+
+    if (!tracePath.empty()) {
+        if (Profiler::writeTrace(tracePath)) {
+            std::cout << "Wrote profiler trace to " << tracePath << std::endl;
+        } else {
+            std::cerr << "Failed to write profiler trace: " << tracePath << std::endl;
+        }
+    }
+
+    if (tickLimit > 0 && simulation) {
+        double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        uint64_t ticks = simulation->getTick();
+        std::cout << "Ran " << ticks << " ticks (" << ticks * Simulation::TICK_SECONDS
+                  << " simulated s) in " << wallSeconds << " s, "
+                  << static_cast<uint64_t>(ticks / wallSeconds) << " ticks/s, state hash "
+                  << std::hex << std::setw(16) << std::setfill('0') << simulation->stateHash()
+                  << std::dec << std::endl;
+        
+        if (frontend->getRenderer()) {
+            const RenderStats& stats = renderer->getStats();
+            std::cout << "Rendered " << stats.chunksSubmitted << " track chunks, cars "
+                      << stats.carsSubmitted << " drawn / " << stats.carsCulled << " culled, overlays "
+                      << stats.overlaysSubmitted << " drawn / " << stats.overlaysCulled << " culled, tiles "
+                      << stats.tilesSubmitted << " drawn / " << stats.tilesCulled << " culled" << std::endl;
+        }
     }
 }
 
 void Game::handleEvents() {
+    PROFILE_ZONE("Game::handleEvents");
     SDL_Event event;
     while (frontend->pollEvent(event)) {
         if (event.type == SDL_EVENT_QUIT) {
@@ -63,11 +116,17 @@ void Game::handleEvents() {
             return;
         }
         
+        if (event.type == SDL_EVENT_KEY_DOWN && event.key.key == SDLK_F3 && !event.key.repeat) {
+            showProfiler = !showProfiler;
+            Profiler::setEnabled(showProfiler || !tracePath.empty());
+        }
+        
+        // Track keys in every state so nothing sticks across menu/pause
+        input->handleEvent(event);
+        
         if (state == GameState::MENU) {
             menu->handleEvent(event);
         } else if (state == GameState::PLAYING) {
-            input->handleEvent(event);
-            
             // Pause with Escape key
             if (event.type == SDL_EVENT_KEY_DOWN && event.key.key == SDLK_ESCAPE) {
                 state = GameState::PAUSED;
@@ -81,6 +140,7 @@ void Game::handleEvents() {
 }
 
 void Game::update(float deltaTime) {
+    PROFILE_ZONE("Game::update");
     if (state == GameState::MENU) {
         MenuAction action = menu->update();
         
@@ -99,47 +159,60 @@ void Game::update(float deltaTime) {
                 break;
         }
     } else if (state == GameState::PLAYING) {
-        if (playerCar && track) {
-            // Update player car
-            playerCar->update(deltaTime, *input);
-            
-            // Update AI bots
-            for (auto& bot : aiBots) {
-                bot->update(deltaTime, *track);
+        if (simulation) {
+            // Run as many fixed ticks as real time allows; the remainder is
+            // carried over and used to interpolate the rendered poses
+            tickAccumulator += deltaTime;
+            while (tickAccumulator >= Simulation::TICK_SECONDS) {
+                simulation->step(*input);
+                recorder.record(readInput(*input), *simulation);
+                tickAccumulator -= Simulation::TICK_SECONDS;
+                
+                if (tickLimit > 0 && simulation->getTick() >= tickLimit) {
+                    running = false;
+                    break;
+                }
             }
             
             // Update camera to follow player
-            camera->followTarget(playerCar->getX(), playerCar->getY());
+            PROFILE_ZONE("camera");
+            const Car& playerCar = simulation->getPlayerCar();
+            float alpha = tickAccumulator / Simulation::TICK_SECONDS;
+            camera->followTarget(playerCar.getInterpolatedX(alpha), playerCar.getInterpolatedY(alpha));
             camera->update(deltaTime);
-            
-            // Check collisions with track boundaries
-            track->checkCollisions(*playerCar);
-            for (auto& bot : aiBots) {
-                track->checkCollisions(bot->getCar());
-            }
         }
     }
 }
 
-void Game::render() {
+void Game::render(float alpha) {
+    PROFILE_ZONE("Game::render");
     frontend->clear(20, 20, 20, 255);
     
     if (state == GameState::MENU) {
         menu->render();
     } else if (state == GameState::PLAYING || state == GameState::PAUSED) {
-        if (track && playerCar) {
+        if (simulation) {
+            // Cull against the window as it is now, not as it was created
+            int outputWidth, outputHeight;
+            if (SDL_GetCurrentRenderOutputSize(frontend->getRenderer(), &outputWidth, &outputHeight)) {
+                camera->setScreenSize(outputWidth, outputHeight);
+            }
+            
             // Apply camera transform
             camera->apply(frontend->getRenderer());
             
             // Render track
-            track->render(*renderer, *camera);
+            trackChunks->render(simulation->getTrack(), *camera);
             
             // Render cars
-            playerCar->render(*renderer, *camera);
-            for (auto& bot : aiBots) {
-                bot->render(*renderer, *camera);
+            simulation->getPlayerCar().render(*renderer, *camera, alpha);
+            for (auto& bot : simulation->getBots()) {
+                bot->render(*renderer, *camera, alpha);
             }
             
+            // The world goes out as one batch, the HUD as another
+            renderer->flush();
+            
             // Reset camera transform
             camera->reset(frontend->getRenderer());
             
@@ -153,44 +226,79 @@ void Game::render() {
         }
     }
 
+    if (showProfiler) {
+        renderProfiler();
+    }
+
+    renderer->flush();
     frontend->present();
 }
 
+void Game::renderProfiler() {
+    // Last frame's zones on this thread, nested by indentation
+    const auto& zones = Profiler::getFrameStats();
+    float y = 40.0f;
+    renderer->drawRect(6, y - 4, 300, zones.size() * 14.0f + 8, 0, 0, 0, true);
+    for (const auto& zone : zones) {
+        char line[96];
+        std::snprintf(line, sizeof(line), "%*s%-24s %6.2f ms x%u", zone.depth * 2, "",
+                      zone.name, zone.milliseconds, zone.calls);
+        renderer->renderText(line, 10, static_cast<int>(y), 200, 255, 200, 0.9f);
+        y += 14.0f;
+    }
+#ifndef PROFILER_ENABLED
+    renderer->renderText("Profiler compiled out (ENABLE_PROFILER=OFF)", 10, static_cast<int>(y), 255, 200, 0, 0.9f);
+#endif
+}
+
 void Game::startGame(const std::string& trackName) {
     // Load track
-    track = std::make_unique<Track>();
-    if (!track->loadFromFile("tracks/" + trackName)) {
+    simulation = std::make_unique<Simulation>();
+    if (!simulation->loadTrack("tracks/" + trackName)) {
         std::cerr << "Failed to load track: " << trackName << std::endl;
         returnToMenu();
         return;
     }
     
-    // Create player car
-    auto startPos = track->getStartPosition(0);
-    playerCar = std::make_unique<Car>(startPos.x, startPos.y, 0, 255, 0);
-    
-    // Create AI bots
-    aiBots.clear();
-    for (int i = 1; i <= 3; ++i) {
-        auto aiStartPos = track->getStartPosition(i);
-        auto bot = std::make_unique<AIBot>(aiStartPos.x, aiStartPos.y, difficulty);
-        aiBots.push_back(std::move(bot));
+    // Create player car and AI bots
+    const int botCount = 3;
+    simulation->spawnCars(botCount, difficulty);
+    tickAccumulator = 0;
+    if (!recordPath.empty()) {
+        recorder.begin("tracks/" + trackName, botCount, difficulty);
     }
     
     // Initialize camera at player position
-    camera->setPosition(playerCar->getX(), playerCar->getY());
+    const Car& playerCar = simulation->getPlayerCar();
+    camera->setPosition(playerCar.getX(), playerCar.getY());
     
     state = GameState::PLAYING;
 }
 
 void Game::returnToMenu() {
-    playerCar.reset();
-    track.reset();
-    aiBots.clear();
+    saveRecording();
+    simulation.reset();
     state = GameState::MENU;
 }
 
+void Game::saveRecording() {
+    if (!recorder.isRecording() || !simulation) {
+        return;
+    }
+    recorder.finish(*simulation);
+    const Replay& replay = recorder.getReplay();
+    if (replay.save(recordPath)) {
+        std::cout << "Recorded " << replay.ticks << " ticks to " << recordPath << std::endl;
+    }
+}
+
 void Game::cleanup() {
+    // Chunk and glyph textures go before the SDL renderer that owns them
+    trackChunks.reset();
+    if (renderer) {
+        renderer->setTextBackend(nullptr);
+    }
+    textRenderer.reset();
     if (frontend) {
         frontend->cleanup();
         frontend.reset();
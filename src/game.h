@@ -4,13 +4,16 @@
 #include <memory>
 #include <vector>
 #include "menu.h"
-#include "car.h"
-#include "track.h"
+#include "simulation.h"
 #include "camera.h"
-#include "ai_bot.h"
 #include "renderer.h"
-#include "input.h"
+#include "track_chunks.h"
+#include "text_renderer.h"
+#include "keyboard_input.h"
 #include "frontend.h"
+#include "frame_pacer.h"
+#include "profiler.h"
+#include "replay.h"
 
 enum class GameState {
     MENU,
@@ -25,27 +28,54 @@ public:
     Game();
     ~Game();
     
-    bool initialize();
+    bool initialize(std::unique_ptr<Frontend> gameFrontend);
     void run();
+    
+    // Stops the game after this many simulation ticks (0 = run until quit)
+    void setTickLimit(uint64_t ticks) { tickLimit = ticks; }
+    // Frame rate cap (0 = uncapped); vsync, when the display supports it,
+    // takes over from the cap. Set before initialize().
+    void setFrameRate(double fps) { pacer.setTargetFps(fps); }
+    void setVSync(bool enabled) { vsyncRequested = enabled; }
+    // Records profiler zones from the start and writes them to path as a
+    // Chrome trace on exit
+    void setTracePath(const std::string& path) { tracePath = path; }
+    // Records every race's controls and writes the last one to path when
+    // it ends, for playReplay()
+    void setRecordPath(const std::string& path) { recordPath = path; }
     void cleanup();
     
 private:
     void handleEvents();
     void update(float deltaTime);
-    void render();
+    void render(float alpha);
+    void renderProfiler();
     
     std::unique_ptr<Frontend> frontend;
     std::unique_ptr<Renderer> renderer;
+    std::unique_ptr<TrackChunks> trackChunks;
+    std::unique_ptr<TextRenderer> textRenderer;
     std::unique_ptr<Menu> menu;
-    std::unique_ptr<Input> input;
-    std::unique_ptr<Track> track;
+    std::unique_ptr<KeyboardInput> input;
     std::unique_ptr<Camera> camera;
-    std::unique_ptr<Car> playerCar;
-    std::vector<std::unique_ptr<AIBot>> aiBots;
+    std::unique_ptr<Simulation> simulation;
     
     GameState state;
     bool running;
     
+    // Real time not yet consumed by fixed simulation ticks
+    float tickAccumulator;
+    uint64_t tickLimit;
+    
+    FramePacer pacer;
+    bool vsyncRequested;
+    
+    bool showProfiler; // F3
+    std::string tracePath;
+    
+    ReplayRecorder recorder;
+    std::string recordPath;
+    
     int screenWidth;
     int screenHeight;
     
@@ -55,6 +85,7 @@ private:
     
     void startGame(const std::string& trackName);
     void returnToMenu();
+    void saveRecording();
 };
 
 #endif // GAME_H
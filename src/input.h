@@ -1,22 +1,44 @@
 #ifndef INPUT_H
 #define INPUT_H
 
-#include <SDL3/SDL.h>
-
+// Driving controls read by Car::update. Implemented by the keyboard, the AI
+// and anything else that steers a car; has no SDL dependency.
 class Input {
 public:
-    Input();
     virtual ~Input() = default;
     
-    virtual void handleEvent(const SDL_Event& event);
-    
-    virtual bool isForward() const;
-    virtual bool isBackward() const;
-    virtual bool isLeft() const;
-    virtual bool isRight() const;
+    virtual bool isForward() const = 0;
+    virtual bool isBackward() const = 0;
+    virtual bool isLeft() const = 0;
+    virtual bool isRight() const = 0;
+};
+
+struct InputState {
+    bool forward = false;
+    bool backward = false;
+    bool left = false;
+    bool right = false;
+};
+
+// What an Input reports right now, e.g. to record it
+inline InputState readInput(const Input& input) {
+    InputState state;
+    state.forward = input.isForward();
+    state.backward = input.isBackward();
+    state.left = input.isLeft();
+    state.right = input.isRight();
+    return state;
+}
+
+// Input driven by a plain InputState, e.g. set by the AI each tick
+class StateInput : public Input {
+public:
+    InputState state;
     
-protected:
-    const Uint8* keyState;
+    bool isForward() const override { return state.forward; }
+    bool isBackward() const override { return state.backward; }
+    bool isLeft() const override { return state.left; }
+    bool isRight() const override { return state.right; }
 };
 
 #endif // INPUT_H
@@ -0,0 +1,136 @@
+#include "job_system.h"
+#include "profiler.h"
+#include <algorithm>
+
+JobSystem::JobSystem(unsigned workerCount)
+    : generation(0)
+    , stopping(false)
+    , currentBody(nullptr)
+    , remaining(0)
+{
+    for (unsigned i = 0; i <= workerCount; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 1; i <= workerCount; ++i) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned JobSystem::defaultWorkerCount() {
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 0;
+}
+
+JobSystem& JobSystem::shared() {
+    static JobSystem instance;
+    return instance;
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+    if (workers.empty() || count <= grain) {
+        body(0, count);
+        return;
+    }
+
+    // Deal out contiguous runs of chunks so each thread starts on its own
+    // slice of the range, and stealing only kicks in to even out the tail
+    const size_t chunks = (count + grain - 1) / grain;
+    currentBody = &body;
+    remaining.store(chunks);
+
+    for (size_t q = 0; q < queues.size(); ++q) {
+        size_t first = chunks * q / queues.size();
+        size_t last = chunks * (q + 1) / queues.size();
+        std::lock_guard<std::mutex> lock(queues[q]->mutex);
+        for (size_t c = first; c < last; ++c) {
+            queues[q]->jobs.push_back({ c * grain, std::min(count, (c + 1) * grain) });
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        ++generation;
+    }
+    wake.notify_all();
+
+    while (runOne(0)) {
+    }
+
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    done.wait(lock, [this] { return remaining.load() == 0; });
+    currentBody = nullptr;
+}
+
+void JobSystem::workerLoop(size_t self) {
+    uint64_t seen = 0;
+    for (;;) {
+        while (runOne(self)) {
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) {
+            return;
+        }
+        seen = generation;
+    }
+}
+
+bool JobSystem::runOne(size_t self) {
+    Job job;
+    if (!popLocal(self, job) && !steal(self, job)) {
+        return false;
+    }
+
+    {
+        PROFILE_ZONE("job");
+        (*currentBody)(job.begin, job.end);
+    }
+
+    if (remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        done.notify_all();
+    }
+    return true;
+}
+
+bool JobSystem::popLocal(size_t self, Job& job) {
+    Queue& queue = *queues[self];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) {
+        return false;
+    }
+    job = queue.jobs.back();
+    queue.jobs.pop_back();
+    return true;
+}
+
+bool JobSystem::steal(size_t self, Job& job) {
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        Queue& victim = *queues[(self + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,73 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads running data-parallel loops. parallelFor()
+// cuts a range into chunks and deals them out to per-thread queues; each
+// thread drains its own queue from the back and, once empty, steals from
+// the front of the others. The calling thread works too and only returns
+// once every chunk has finished.
+//
+// Chunks must write disjoint data. Given that, a parallel loop leaves
+// exactly the state the serial loop would, whatever the scheduling.
+class JobSystem {
+public:
+    // Zero workers runs everything on the calling thread
+    explicit JobSystem(unsigned workerCount = defaultWorkerCount());
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Calls body(begin, end) over [0, count) in chunks of at most grain
+    // items. Runs serially when the range fits in one chunk. Must not be
+    // called from inside a job.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    unsigned getWorkerCount() const { return static_cast<unsigned>(workers.size()); }
+
+    // One less than the hardware thread count, leaving a core for the caller
+    static unsigned defaultWorkerCount();
+
+    // Process-wide instance with the default worker count
+    static JobSystem& shared();
+
+private:
+    struct Job {
+        size_t begin, end;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues; // [0] is the calling thread's
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation;
+    bool stopping;
+
+    const std::function<void(size_t, size_t)>* currentBody;
+    std::atomic<size_t> remaining;
+
+    void workerLoop(size_t self);
+    bool runOne(size_t self);
+    bool popLocal(size_t self, Job& job);
+    bool steal(size_t self, Job& job);
+};
+
+#endif // JOB_SYSTEM_H
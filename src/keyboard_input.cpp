@@ -0,0 +1,31 @@
+#include "keyboard_input.h"
+#include <algorithm>
+#include <iterator>
+
+KeyboardInput::KeyboardInput() {
+    std::fill(std::begin(pressed), std::end(pressed), false);
+}
+
+void KeyboardInput::handleEvent(const SDL_Event& event) {
+    // Update key state
+    if ((event.type == SDL_EVENT_KEY_DOWN || event.type == SDL_EVENT_KEY_UP) &&
+        event.key.scancode >= 0 && event.key.scancode < SDL_SCANCODE_COUNT) {
+        pressed[event.key.scancode] = event.type == SDL_EVENT_KEY_DOWN;
+    }
+}
+
+bool KeyboardInput::isForward() const {
+    return pressed[SDL_SCANCODE_UP] || pressed[SDL_SCANCODE_W];
+}
+
+bool KeyboardInput::isBackward() const {
+    return pressed[SDL_SCANCODE_DOWN] || pressed[SDL_SCANCODE_S];
+}
+
+bool KeyboardInput::isLeft() const {
+    return pressed[SDL_SCANCODE_LEFT] || pressed[SDL_SCANCODE_A];
+}
+
+bool KeyboardInput::isRight() const {
+    return pressed[SDL_SCANCODE_RIGHT] || pressed[SDL_SCANCODE_D];
+}
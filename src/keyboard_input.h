@@ -0,0 +1,24 @@
+#ifndef KEYBOARD_INPUT_H
+#define KEYBOARD_INPUT_H
+
+#include <SDL3/SDL.h>
+#include "input.h"
+
+class KeyboardInput : public Input {
+public:
+    KeyboardInput();
+    
+    void handleEvent(const SDL_Event& event);
+    
+    bool isForward() const override;
+    bool isBackward() const override;
+    bool isLeft() const override;
+    bool isRight() const override;
+    
+private:
+    // Tracked from key events rather than SDL_GetKeyboardState, so scripted
+    // events drive the car exactly like a real keyboard
+    bool pressed[SDL_SCANCODE_COUNT];
+};
+
+#endif // KEYBOARD_INPUT_H
@@ -0,0 +1,60 @@
+#include "lap_counter.h"
+#include "racing_line.h"
+#include <limits>
+
+LapCounter::LapCounter()
+    : point(0)
+    , pastHalfway(false)
+    , lapStart(0)
+{
+}
+
+void LapCounter::reset(const RacingLine& line, float x, float y, uint64_t tick) {
+    point = line.empty() ? 0 : line.nearest(x, y);
+    pastHalfway = false;
+    lapStart = tick;
+    lapTicks.clear();
+}
+
+bool LapCounter::update(const RacingLine& line, float x, float y, uint64_t tick) {
+    const size_t count = line.size();
+    if (count < 4 || !line.isClosed()) {
+        return false;
+    }
+
+    const auto& points = line.getPoints();
+    size_t best = point;
+    float bestDistance = std::numeric_limits<float>::infinity();
+    size_t bestOffset = 0;
+    for (size_t offset = 0; offset <= 2 * SEARCH_RANGE; ++offset) {
+        size_t i = (point + count + offset - SEARCH_RANGE) % count;
+        float dx = points[i].x - x;
+        float dy = points[i].y - y;
+        float d = dx * dx + dy * dy;
+        if (d < bestDistance) {
+            bestDistance = d;
+            best = i;
+            bestOffset = offset;
+        }
+    }
+    // Still improving at the edge of the window: the car has been knocked
+    // further than a tick's travel, so look along the whole line
+    if (bestOffset == 0 || bestOffset == 2 * SEARCH_RANGE) {
+        best = line.nearest(x, y);
+    }
+
+    const size_t previous = point;
+    point = best;
+
+    if (point >= count / 2 && point < count * 3 / 4) {
+        pastHalfway = true;
+    }
+    bool crossed = previous >= count * 3 / 4 && point < count / 4;
+    if (crossed && pastHalfway) {
+        lapTicks.push_back(tick - lapStart);
+        lapStart = tick;
+        pastHalfway = false;
+        return true;
+    }
+    return false;
+}
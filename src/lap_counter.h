@@ -0,0 +1,42 @@
+#ifndef LAP_COUNTER_H
+#define LAP_COUNTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class RacingLine;
+
+// Counts one car's laps by its progress along a closed racing line.
+//
+// Each tick the car is matched to the nearest line point around the one it
+// was at last, so following it costs a few distance checks. A lap is
+// complete when the car crosses from the last quarter of the line into the
+// first, having been past the half-way point since the previous lap;
+// reversing over the line, or turning back before half-way, counts
+// nothing. Open lines have no laps.
+class LapCounter {
+public:
+    // Points either side of the last match searched each tick. Cars cover
+    // a few px per tick against RacingLine::SPACING between points.
+    static constexpr size_t SEARCH_RANGE = 4;
+
+    LapCounter();
+
+    void reset(const RacingLine& line, float x, float y, uint64_t tick);
+
+    // True when this tick completed a lap
+    bool update(const RacingLine& line, float x, float y, uint64_t tick);
+
+    int getLaps() const { return static_cast<int>(lapTicks.size()); }
+    const std::vector<uint64_t>& getLapTicks() const { return lapTicks; } // Length of each lap
+    size_t getLinePoint() const { return point; }
+
+private:
+    size_t point;
+    bool pastHalfway;
+    uint64_t lapStart;
+    std::vector<uint64_t> lapTicks;
+};
+
+#endif // LAP_COUNTER_H
@@ -1,10 +1,105 @@
 #include "game.h"
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <string>
+
+namespace {
+
+// Re-simulates a recorded race without a window, optionally under the
+// profiler, and checks it ends where the recording did
+int runReplay(const std::string& path, const std::string& tracePath) {
+    Replay replay;
+    if (!replay.load(path)) {
+        return 1;
+    }
+    if (!tracePath.empty()) {
+        Profiler::setEnabled(true);
+    }
+
+    ReplayResult result = playReplay(replay);
+    if (!result.started) {
+        return 1;
+    }
+
+    double simulated = result.ticks * static_cast<double>(Simulation::TICK_SECONDS);
+    std::cout << "Replayed " << result.ticks << " ticks (" << simulated << " simulated s) of "
+              << replay.trackPath << " in " << result.seconds << " s, "
+              << static_cast<uint64_t>(simulated / result.seconds) << "x real time" << std::endl;
+    std::cout << "Final state " << (result.hashMatches ? "matches" : "DIFFERS FROM") << " the recording";
+    if (result.firstDesync >= 0) {
+        std::cout << ", bots first chose different controls on tick " << result.firstDesync;
+    }
+    std::cout << std::endl;
+
+    if (!tracePath.empty() && Profiler::writeTrace(tracePath)) {
+        std::cout << "Wrote profiler trace to " << tracePath << std::endl;
+    }
+    return result.hashMatches && result.firstDesync < 0 ? 0 : 1;
+}
+
+} // namespace
 
 int main(int argc, char* argv[]) {
+    bool headless = false;
+    bool offscreen = false;
+    uint64_t ticks = 0;
+    double fps = -1.0; // Default: capped in a window, uncapped headless
+    bool vsync = false;
+    std::string tracePath;
+    std::string recordPath;
+    std::string replayPath;
+    
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (std::strcmp(argv[i], "--offscreen") == 0) {
+            headless = true;
+            offscreen = true;
+        } else if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            fps = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--vsync") == 0) {
+            vsync = true;
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else {
+            std::cerr << "Usage: racing_game [--headless [--offscreen] [--ticks N]] [--fps N] [--vsync] [--trace FILE] [--record FILE]\n"
+                      << "       racing_game --replay FILE [--trace FILE]" << std::endl;
+            return 1;
+        }
+    }
+    
+    if (!replayPath.empty()) {
+        return runReplay(replayPath, tracePath);
+    }
+    
+    std::unique_ptr<Frontend> frontend;
+    if (headless) {
+        // Start the race from the menu and hold the throttle
+        auto script = std::make_unique<HeadlessFrontend>(Simulation::TICK_SECONDS, offscreen);
+        script->scriptKey(1, SDLK_RETURN, SDL_SCANCODE_RETURN, true);
+        script->scriptKey(2, SDLK_RETURN, SDL_SCANCODE_RETURN, false);
+        script->scriptKey(3, SDLK_UP, SDL_SCANCODE_UP, true);
+        frontend = std::move(script);
+    } else {
+        frontend = std::make_unique<SDLFrontend>();
+    }
+    
     Game game;
+    game.setTickLimit(headless && ticks == 0 ? 120 * 60 : ticks);
+    game.setFrameRate(fps >= 0.0 ? fps : headless ? 0.0 : FramePacer::DEFAULT_FPS);
+    game.setVSync(vsync);
+    game.setTracePath(tracePath);
+    game.setRecordPath(recordPath);
     
-    if (!game.initialize()) {
+    if (!game.initialize(std::move(frontend))) {
         std::cerr << "Failed to initialize game" << std::endl;
         return 1;
     }
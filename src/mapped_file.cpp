@@ -0,0 +1,120 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : bytes(nullptr)
+    , length(0)
+    , fileHandle(INVALID_HANDLE_VALUE)
+    , mappingHandle(nullptr)
+{
+}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+    
+    fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        return false;
+    }
+    
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle) {
+        close();
+        return false;
+    }
+    
+    bytes = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!bytes) {
+        close();
+        return false;
+    }
+    
+    length = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes) {
+        UnmapViewOfFile(bytes);
+        bytes = nullptr;
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+    length = 0;
+}
+
+#else
+
+MappedFile::MappedFile()
+    : bytes(nullptr)
+    , length(0)
+    , fd(-1)
+{
+}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+    
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close();
+        return false;
+    }
+    
+    void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        close();
+        return false;
+    }
+    
+    bytes = static_cast<const unsigned char*>(mapping);
+    length = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes) {
+        munmap(const_cast<unsigned char*>(bytes), length);
+        bytes = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    length = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
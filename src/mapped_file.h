@@ -0,0 +1,34 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool open(const std::string& filename);
+    void close();
+    
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+    
+private:
+    const unsigned char* bytes;
+    size_t length;
+    
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+};
+
+#endif // MAPPED_FILE_H
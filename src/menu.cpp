@@ -3,6 +3,7 @@
 Menu::Menu(Renderer* renderer)
     : renderer(renderer)
     , selectedIndex(0)
+    , pendingAction(MenuAction::NONE)
 {
     menuItems = {
         "Start Game",
@@ -23,6 +24,10 @@ void Menu::handleEvent(const SDL_Event& event) {
             case SDLK_S:
                 selectNext();
                 break;
+            case SDLK_RETURN:
+            case SDLK_SPACE:
+                pendingAction = activate();
+                break;
             default:
                 break;
         }
@@ -30,13 +35,10 @@ void Menu::handleEvent(const SDL_Event& event) {
 }
 
 MenuAction Menu::update() {
-    const Uint8* keyState = SDL_GetKeyboardState(nullptr);
-    
-    if (keyState[SDL_SCANCODE_RETURN] || keyState[SDL_SCANCODE_SPACE]) {
-        return activate();
-    }
-    
-    return MenuAction::NONE;
+    // Activation comes from key events, so scripted (headless) input works too
+    MenuAction action = pendingAction;
+    pendingAction = MenuAction::NONE;
+    return action;
 }
 
 void Menu::render() {
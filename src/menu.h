@@ -27,6 +27,7 @@ private:
     
     std::vector<std::string> menuItems;
     int selectedIndex;
+    MenuAction pendingAction;
     
     void selectNext();
     void selectPrevious();
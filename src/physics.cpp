@@ -1,4 +1,5 @@
 #include "physics.h"
+#include <algorithm>
 
 bool Physics::circleCollision(float x1, float y1, float r1, 
                              float x2, float y2, float r2) {
@@ -30,3 +31,163 @@ void Physics::normalize(float& x, float& y) {
         y /= length;
     }
 }
+
+bool Physics::sweepCircleRect(float x, float y, float dx, float dy, float r,
+                              float rx, float ry, float rw, float rh,
+                              float& t, float& nx, float& ny) {
+    bool hit = false;
+    t = 1.0f;
+    
+    // Most calls miss the grown rectangle's bounds altogether
+    float endX = x + dx;
+    float endY = y + dy;
+    if (std::max(x, endX) <= rx - r || std::min(x, endX) >= rx + rw + r ||
+        std::max(y, endY) <= ry - r || std::min(y, endY) >= ry + rh + r) {
+        return false;
+    }
+    
+    // The rectangle grown by r has straight sides (two rectangles) and
+    // rounded corners (four circles); the circle's centre hits that shape
+    auto sweepRect = [&](float minX, float minY, float maxX, float maxY) {
+        float enter = 0.0f;
+        float exit = 1.0f;
+        float hx = 0.0f, hy = 0.0f;
+        if (dx != 0.0f) {
+            float a = (minX - x) / dx;
+            float b = (maxX - x) / dx;
+            if (a > b) {
+                std::swap(a, b);
+            }
+            if (a >= enter) {
+                enter = a;
+                hx = dx > 0.0f ? -1.0f : 1.0f;
+                hy = 0.0f;
+            }
+            exit = std::min(exit, b);
+        } else if (x <= minX || x >= maxX) {
+            return;
+        }
+        if (dy != 0.0f) {
+            float a = (minY - y) / dy;
+            float b = (maxY - y) / dy;
+            if (a > b) {
+                std::swap(a, b);
+            }
+            if (a >= enter) {
+                enter = a;
+                hx = 0.0f;
+                hy = dy > 0.0f ? -1.0f : 1.0f;
+            }
+            exit = std::min(exit, b);
+        } else if (y <= minY || y >= maxY) {
+            return;
+        }
+        // No normal means the centre started inside
+        if (enter < exit && (hx != 0.0f || hy != 0.0f) && (!hit || enter < t)) {
+            hit = true;
+            t = enter;
+            nx = hx;
+            ny = hy;
+        }
+    };
+    
+    auto sweepCorner = [&](float cx, float cy) {
+        float ox = x - cx;
+        float oy = y - cy;
+        float a = dx * dx + dy * dy;
+        float b = ox * dx + oy * dy;
+        float c = ox * ox + oy * oy - r * r;
+        if (a == 0.0f || c <= 0.0f || b >= 0.0f) {
+            return;
+        }
+        float discriminant = b * b - a * c;
+        if (discriminant < 0.0f) {
+            return;
+        }
+        float enter = (-b - std::sqrt(discriminant)) / a;
+        if (enter >= 0.0f && enter <= 1.0f && (!hit || enter < t)) {
+            hit = true;
+            t = enter;
+            nx = (ox + dx * enter) / r;
+            ny = (oy + dy * enter) / r;
+        }
+    };
+    
+    sweepRect(rx - r, ry, rx + rw + r, ry + rh);
+    sweepRect(rx, ry - r, rx + rw, ry + rh + r);
+    sweepCorner(rx, ry);
+    sweepCorner(rx + rw, ry);
+    sweepCorner(rx, ry + rh);
+    sweepCorner(rx + rw, ry + rh);
+    return hit;
+}
+
+bool Physics::circleRectPenetration(float x, float y, float r,
+                                    float rx, float ry, float rw, float rh,
+                                    float& nx, float& ny, float& depth) {
+    float qx = std::max(rx, std::min(x, rx + rw));
+    float qy = std::max(ry, std::min(y, ry + rh));
+    float ox = x - qx;
+    float oy = y - qy;
+    float distanceSq = ox * ox + oy * oy;
+    if (distanceSq >= r * r) {
+        return false;
+    }
+    
+    if (distanceSq > 0.0f) {
+        float distance = std::sqrt(distanceSq);
+        nx = ox / distance;
+        ny = oy / distance;
+        depth = r - distance;
+        return true;
+    }
+    
+    // Centre inside: out through the nearest side
+    float left = x - rx;
+    float right = rx + rw - x;
+    float top = y - ry;
+    float bottom = ry + rh - y;
+    float nearest = std::min(std::min(left, right), std::min(top, bottom));
+    nx = nearest == left ? -1.0f : nearest == right ? 1.0f : 0.0f;
+    ny = nx != 0.0f ? 0.0f : nearest == top ? -1.0f : 1.0f;
+    depth = nearest + r;
+    return true;
+}
+
+bool Physics::sweepCircleBox(float x, float y, float dx, float dy, float r, const TileShape& box,
+                             float& t, float& nx, float& ny) {
+    if (!box.rotated) {
+        return sweepCircleRect(x, y, dx, dy, r, box.minX, box.minY,
+                               box.maxX - box.minX, box.maxY - box.minY, t, nx, ny);
+    }
+    float localX, localY;
+    box.toLocal(x, y, localX, localY);
+    float localDX = dx * box.cosA + dy * box.sinA;
+    float localDY = dy * box.cosA - dx * box.sinA;
+    float localNX, localNY;
+    if (!sweepCircleRect(localX, localY, localDX, localDY, r, -box.halfWidth, -box.halfHeight,
+                         2 * box.halfWidth, 2 * box.halfHeight, t, localNX, localNY)) {
+        return false;
+    }
+    nx = localNX * box.cosA - localNY * box.sinA;
+    ny = localNX * box.sinA + localNY * box.cosA;
+    return true;
+}
+
+bool Physics::circleBoxPenetration(float x, float y, float r, const TileShape& box,
+                                   float& nx, float& ny, float& depth) {
+    if (!box.rotated) {
+        return circleRectPenetration(x, y, r, box.minX, box.minY,
+                                     box.maxX - box.minX, box.maxY - box.minY, nx, ny, depth);
+    }
+    float localX, localY;
+    box.toLocal(x, y, localX, localY);
+    float localNX, localNY;
+    if (!circleRectPenetration(localX, localY, r, -box.halfWidth, -box.halfHeight,
+                               2 * box.halfWidth, 2 * box.halfHeight, localNX, localNY, depth)) {
+        return false;
+    }
+    nx = localNX * box.cosA - localNY * box.sinA;
+    ny = localNX * box.sinA + localNY * box.cosA;
+    return true;
+}
@@ -2,6 +2,7 @@
 #define PHYSICS_H
 
 #include <cmath>
+#include "tile.h"
 
 class Physics {
 public:
@@ -14,6 +15,28 @@ public:
     static float distance(float x1, float y1, float x2, float y2);
     
     static void normalize(float& x, float& y);
+    
+    // Earliest fraction t of the move (dx, dy) at which a circle of radius r
+    // starting at (x, y) touches the rectangle, and the rectangle's outward
+    // normal there. False if the circle stays clear or starts overlapping.
+    static bool sweepCircleRect(float x, float y, float dx, float dy, float r,
+                                float rx, float ry, float rw, float rh,
+                                float& t, float& nx, float& ny);
+    
+    // Shortest way out for a circle overlapping a rectangle: push it depth
+    // along (nx, ny). False if they do not overlap.
+    static bool circleRectPenetration(float x, float y, float r,
+                                      float rx, float ry, float rw, float rh,
+                                      float& nx, float& ny, float& depth);
+    
+    // The same two tests against a tile that may be rotated. A circle
+    // against an oriented box separates along the box's two axes or the
+    // line to its nearest corner, so both are done in the box's own frame
+    // by the rectangle versions above and the normal turned back.
+    static bool sweepCircleBox(float x, float y, float dx, float dy, float r, const TileShape& box,
+                               float& t, float& nx, float& ny);
+    static bool circleBoxPenetration(float x, float y, float r, const TileShape& box,
+                                     float& nx, float& ny, float& depth);
 };
 
 #endif // PHYSICS_H
@@ -0,0 +1,149 @@
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+struct Event {
+    const char* name;
+    int64_t start; // Nanoseconds since the profiler's epoch
+    int64_t end;
+    int depth;
+};
+
+struct ThreadEvents {
+    unsigned threadIndex; // In order of first zone, 0 is usually the main thread
+    std::vector<Event> events;
+    std::atomic<uint64_t> written{ 0 };
+    int depth = 0;
+    uint64_t frameStart = 0; // First event of the frame, for endFrame()
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadEvents>> registry; // Outlives the threads
+thread_local ThreadEvents* localEvents = nullptr;
+
+std::vector<Profiler::ZoneStats> frameStats;
+
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+// Weight of the newest frame in the smoothed per-zone times
+const double SMOOTHING = 0.1;
+
+ThreadEvents& threadEvents() {
+    if (!localEvents) {
+        auto events = std::make_unique<ThreadEvents>();
+        events->events.resize(Profiler::EVENTS_PER_THREAD);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        events->threadIndex = static_cast<unsigned>(registry.size());
+        localEvents = events.get();
+        registry.push_back(std::move(events));
+    }
+    return *localEvents;
+}
+
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+// Names are literals, but keep the JSON valid whatever they hold
+void writeJsonString(std::FILE* file, const char* text) {
+    std::fputc('"', file);
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            std::fputc('\\', file);
+        }
+        if (static_cast<unsigned char>(*c) >= 0x20) {
+            std::fputc(*c, file);
+        }
+    }
+    std::fputc('"', file);
+}
+
+} // namespace
+
+int64_t Profiler::beginZone() {
+    ++threadEvents().depth;
+    return now();
+}
+
+void Profiler::endZone(const char* name, int64_t start) {
+    ThreadEvents& local = *localEvents; // Set by beginZone
+    int depth = --local.depth;
+    uint64_t index = local.written.load(std::memory_order_relaxed);
+    local.events[index % EVENTS_PER_THREAD] = { name, start, now(), depth };
+    local.written.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::endFrame() {
+    ThreadEvents& local = threadEvents();
+    uint64_t written = local.written.load(std::memory_order_relaxed);
+    uint64_t first = std::max(local.frameStart, written > EVENTS_PER_THREAD ? written - EVENTS_PER_THREAD : 0);
+    local.frameStart = written;
+
+    // Zones are stored as they end, children first; list them as they began
+    std::vector<Event> frame;
+    frame.reserve(written - first);
+    for (uint64_t i = first; i < written; ++i) {
+        frame.push_back(local.events[i % EVENTS_PER_THREAD]);
+    }
+    std::sort(frame.begin(), frame.end(), [](const Event& a, const Event& b) { return a.start < b.start; });
+
+    std::vector<ZoneStats> stats;
+    for (const Event& event : frame) {
+        auto same = [&event](const ZoneStats& zone) { return zone.name == event.name && zone.depth == event.depth; };
+        auto it = std::find_if(stats.begin(), stats.end(), same);
+        if (it == stats.end()) {
+            it = stats.insert(stats.end(), { event.name, event.depth, 0, 0.0 });
+        }
+        ++it->calls;
+        it->milliseconds += (event.end - event.start) / 1e6;
+    }
+
+    // Zones missing from this frame drop out of the list straight away
+    for (ZoneStats& zone : stats) {
+        auto previous = std::find_if(frameStats.begin(), frameStats.end(), [&zone](const ZoneStats& old) {
+            return old.name == zone.name && old.depth == zone.depth;
+        });
+        if (previous != frameStats.end()) {
+            zone.milliseconds = previous->milliseconds + SMOOTHING * (zone.milliseconds - previous->milliseconds);
+        }
+    }
+    frameStats = std::move(stats);
+}
+
+const std::vector<Profiler::ZoneStats>& Profiler::getFrameStats() {
+    return frameStats;
+}
+
+bool Profiler::writeTrace(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::fputs("{\"traceEvents\":[\n", file);
+    bool first = true;
+    for (const auto& thread : registry) {
+        std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                     "\"args\":{\"name\":\"thread %u\"}}",
+                     first ? "" : ",\n", thread->threadIndex, thread->threadIndex);
+        first = false;
+
+        uint64_t written = thread->written.load(std::memory_order_acquire);
+        uint64_t begin = written > EVENTS_PER_THREAD ? written - EVENTS_PER_THREAD : 0;
+        for (uint64_t i = begin; i < written; ++i) {
+            const Event& event = thread->events[i % EVENTS_PER_THREAD];
+            std::fputs(",\n{\"name\":", file);
+            writeJsonString(file, event.name);
+            std::fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                         thread->threadIndex, event.start / 1e3, (event.end - event.start) / 1e3);
+        }
+    }
+    std::fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,76 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped-zone profiler for the hot paths.
+//
+// PROFILE_ZONE("name") times the rest of the enclosing scope. Finished
+// zones go into a fixed ring buffer owned by the recording thread, so
+// recording takes no lock and the oldest events are overwritten when a
+// buffer fills. Nothing is recorded until setEnabled(true); a disabled
+// zone costs one relaxed load. Building without PROFILER_ENABLED (the
+// ENABLE_PROFILER CMake option) removes the zones entirely.
+//
+// Zone names must be string literals: only the pointer is stored.
+class Profiler {
+public:
+    static constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+
+    // One zone's share of recent frames on the thread calling endFrame()
+    struct ZoneStats {
+        const char* name;
+        int depth;            // Nesting level, 0 for outermost zones
+        unsigned calls;       // In the last frame
+        double milliseconds;  // Per frame, smoothed
+    };
+
+    class Zone {
+    public:
+        explicit Zone(const char* name) : name(name), start(isEnabled() ? beginZone() : -1) {}
+        ~Zone() {
+            if (start >= 0) {
+                endZone(name, start);
+            }
+        }
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* name;
+        int64_t start;
+    };
+
+    static void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // Folds the calling thread's zones since the last call into
+    // getFrameStats(). Call once per frame from the main loop.
+    static void endFrame();
+    static const std::vector<ZoneStats>& getFrameStats();
+
+    // Writes every thread's buffered zones as Chrome trace-event JSON
+    // (chrome://tracing, Perfetto). Call while no other thread is
+    // recording.
+    static bool writeTrace(const std::string& path);
+
+private:
+    static inline std::atomic<bool> enabled{ false };
+
+    static int64_t beginZone();
+    static void endZone(const char* name, int64_t start);
+};
+
+#ifdef PROFILER_ENABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+#endif // PROFILER_H
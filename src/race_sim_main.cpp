@@ -0,0 +1,339 @@
+#include "simulation.h"
+#include "lap_counter.h"
+#include "job_system.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs many complete bot-only races without rendering, spread over worker
+// threads, and reports lap times, time off the track and wall hits per bot,
+// for tuning the AI. Each race jitters the grid from its own seed so races
+// differ, and rotates the difficulties through the grid slots. Each worker
+// loads the track once and restarts the race on it, and only the
+// simulation steps are timed.
+
+namespace {
+
+struct Options {
+    std::string trackPath = "tracks/track1.json";
+    int races = 1000;
+    int bots = 3;
+    std::vector<int> difficulties = { 1, 2, 3 };
+    int laps = 3;
+    double maxSeconds = 300.0;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed = 1;
+    std::string csvPath;
+    std::string jsonPath;
+};
+
+struct BotResult {
+    int race;
+    int slot;
+    int difficulty;
+    std::vector<uint64_t> lapTicks;
+    uint64_t finishTick; // 0 if the laps were not completed
+    uint64_t offTrackTicks;
+    int wallHits;        // Separate contacts, not ticks spent touching
+};
+
+struct RaceResult {
+    uint64_t ticks;
+    std::vector<BotResult> bots;
+};
+
+const float GRID_JITTER = 8.0f;    // px either way
+const float ANGLE_JITTER = 0.1f;   // Radians either way
+
+double toSeconds(uint64_t ticks) {
+    return ticks * static_cast<double>(Simulation::TICK_SECONDS);
+}
+
+// Restarts the race on a simulation whose track is already loaded; adds the
+// time spent in Simulation::step() to stepSeconds
+void runRace(const Options& options, int race, Simulation& simulation, RaceResult& result, double& stepSeconds) {
+    std::vector<int> difficulties(options.bots);
+    for (int i = 0; i < options.bots; ++i) {
+        difficulties[i] = options.difficulties[(race + i) % options.difficulties.size()];
+    }
+    simulation.spawnBots(difficulties);
+
+    std::mt19937_64 rng(options.seed * 1000003u + race);
+    std::uniform_real_distribution<float> offset(-GRID_JITTER, GRID_JITTER);
+    std::uniform_real_distribution<float> turn(-ANGLE_JITTER, ANGLE_JITTER);
+    for (auto& bot : simulation.getBots()) {
+        Car& car = bot->getCar();
+        car.setPosition(car.getX() + offset(rng), car.getY() + offset(rng));
+        car.setAngle(car.getAngle() + turn(rng));
+    }
+
+    const RacingLine& line = simulation.getTrack().getRacingLine();
+    const auto& bots = simulation.getBots();
+    std::vector<LapCounter> counters(bots.size());
+    std::vector<bool> touchingWall(bots.size(), false);
+    result.bots.assign(bots.size(), BotResult());
+    for (size_t i = 0; i < bots.size(); ++i) {
+        const Car& car = bots[i]->getCar();
+        counters[i].reset(line, car.getX(), car.getY(), 0);
+        result.bots[i].race = race;
+        result.bots[i].slot = static_cast<int>(i);
+        result.bots[i].difficulty = difficulties[i];
+    }
+
+    const uint64_t maxTicks = static_cast<uint64_t>(options.maxSeconds * Simulation::TICK_RATE);
+    size_t finished = 0;
+    StateInput noPlayer;
+    while (simulation.getTick() < maxTicks && finished < bots.size()) {
+        auto stepStart = std::chrono::steady_clock::now();
+        simulation.step(noPlayer);
+        stepSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count();
+        const uint64_t tick = simulation.getTick();
+        const auto& collisions = simulation.getCollisions();
+
+        for (size_t i = 0; i < bots.size(); ++i) {
+            const Car& car = bots[i]->getCar();
+            const CollisionResult& contact = collisions[car.getIndex()];
+            BotResult& bot = result.bots[i];
+
+            bot.offTrackTicks += contact.offTrack;
+            if (contact.wallHits > 0 && !touchingWall[i]) {
+                ++bot.wallHits;
+            }
+            touchingWall[i] = contact.wallHits > 0;
+
+            if (counters[i].update(line, car.getX(), car.getY(), tick) &&
+                counters[i].getLaps() == options.laps) {
+                bot.finishTick = tick;
+                ++finished;
+            }
+        }
+    }
+
+    result.ticks = simulation.getTick();
+    for (size_t i = 0; i < bots.size(); ++i) {
+        result.bots[i].lapTicks = counters[i].getLapTicks();
+    }
+}
+
+std::vector<int> parseList(const char* text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        values.push_back(std::atoi(item.c_str()));
+    }
+    return values;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--track") == 0 && hasValue) {
+            options.trackPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--races") == 0 && hasValue) {
+            options.races = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--bots") == 0 && hasValue) {
+            options.bots = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--difficulties") == 0 && hasValue) {
+            options.difficulties = parseList(argv[++i]);
+        } else if (std::strcmp(argv[i], "--laps") == 0 && hasValue) {
+            options.laps = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-seconds") == 0 && hasValue) {
+            options.maxSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--csv") == 0 && hasValue) {
+            options.csvPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--json") == 0 && hasValue) {
+            options.jsonPath = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    auto positive = [](int d) { return d > 0; };
+    return options.races > 0 && options.bots > 0 && options.laps > 0 && !options.difficulties.empty() &&
+           std::all_of(options.difficulties.begin(), options.difficulties.end(), positive);
+}
+
+void writeCsv(const std::string& path, const std::vector<RaceResult>& races) {
+    std::ofstream out(path);
+    out << "race,slot,difficulty,laps,best_lap_s,mean_lap_s,finish_s,off_track_s,wall_hits\n";
+    for (const auto& race : races) {
+        for (const auto& bot : race.bots) {
+            uint64_t best = 0, total = 0;
+            for (uint64_t lap : bot.lapTicks) {
+                best = best == 0 ? lap : std::min(best, lap);
+                total += lap;
+            }
+            out << bot.race << ',' << bot.slot << ',' << bot.difficulty << ',' << bot.lapTicks.size() << ','
+                << (best ? std::to_string(toSeconds(best)) : "") << ','
+                << (bot.lapTicks.empty() ? "" : std::to_string(toSeconds(total) / bot.lapTicks.size())) << ','
+                << (bot.finishTick ? std::to_string(toSeconds(bot.finishTick)) : "") << ','
+                << toSeconds(bot.offTrackTicks) << ',' << bot.wallHits << '\n';
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: race_sim [--track FILE] [--races N] [--bots N] [--difficulties 1,2,3]\n"
+                     "                [--laps N] [--max-seconds S] [--threads N] [--seed N]\n"
+                     "                [--csv FILE] [--json FILE]" << std::endl;
+        return 1;
+    }
+
+    // One race per thread at a time; each race runs its bots serially
+    std::vector<RaceResult> races(options.races);
+    std::vector<double> workerStepSeconds(options.threads, 0.0);
+    std::atomic<int> nextRace(0);
+    std::atomic<bool> failed(false);
+    auto worker = [&](unsigned index) {
+        JobSystem serial(0);
+        Simulation simulation;
+        simulation.setJobSystem(serial);
+        if (!simulation.loadTrack(options.trackPath)) {
+            failed = true;
+            return;
+        }
+        // Build what every race shares before the clock starts
+        simulation.getTrack().getRacingLine();
+        simulation.getTrack().getFlowField();
+
+        for (int race = nextRace++; race < options.races && !failed; race = nextRace++) {
+            runRace(options, race, simulation, races[race], workerStepSeconds[index]);
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < options.threads; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (failed) {
+        return 1;
+    }
+
+    uint64_t totalTicks = 0;
+    for (const auto& race : races) {
+        totalTicks += race.ticks;
+    }
+    double stepSeconds = 0.0;
+    for (double seconds : workerStepSeconds) {
+        stepSeconds += seconds;
+    }
+    double simulated = toSeconds(totalTicks);
+    // Stepping speed of one thread, then throughput of the whole run, which
+    // also covers each worker's track load
+    double realtimePerThread = simulated / stepSeconds;
+    double realtime = simulated / wallSeconds;
+
+    // Per-difficulty summary
+    struct Summary {
+        int bots = 0, finished = 0, wallHits = 0;
+        double bestLapTotal = 0.0, finishTotal = 0.0, offTrackTotal = 0.0;
+        int lapped = 0;
+    };
+    std::map<int, Summary> summaries;
+    for (const auto& race : races) {
+        for (const auto& bot : race.bots) {
+            Summary& summary = summaries[bot.difficulty];
+            ++summary.bots;
+            summary.wallHits += bot.wallHits;
+            summary.offTrackTotal += toSeconds(bot.offTrackTicks);
+            if (!bot.lapTicks.empty()) {
+                ++summary.lapped;
+                summary.bestLapTotal += toSeconds(*std::min_element(bot.lapTicks.begin(), bot.lapTicks.end()));
+            }
+            if (bot.finishTick) {
+                ++summary.finished;
+                summary.finishTotal += toSeconds(bot.finishTick);
+            }
+        }
+    }
+
+    std::printf("%d races of %d laps on %s, %d bots each, %u threads\n", options.races, options.laps,
+                options.trackPath.c_str(), options.bots, options.threads);
+    std::printf("simulated %.0f s in %.2f s of steps (%.2f s wall): %.0fx real time, %.0fx per thread\n\n",
+                simulated, stepSeconds, wallSeconds, realtime, realtimePerThread);
+    std::printf("%-11s %6s %9s %13s %12s %13s %10s\n", "difficulty", "bots", "finished", "mean best lap",
+                "mean finish", "off track/bot", "walls/bot");
+    nlohmann::json summaryJson = nlohmann::json::array();
+    for (const auto& entry : summaries) {
+        const Summary& s = entry.second;
+        double bestLap = s.lapped ? s.bestLapTotal / s.lapped : 0.0;
+        double finish = s.finished ? s.finishTotal / s.finished : 0.0;
+        std::printf("%-11d %6d %8.1f%% %12.2fs %11.2fs %12.2fs %10.2f\n", entry.first, s.bots,
+                    100.0 * s.finished / s.bots, bestLap, finish, s.offTrackTotal / s.bots,
+                    static_cast<double>(s.wallHits) / s.bots);
+        summaryJson.push_back({
+            { "difficulty", entry.first },
+            { "bots", s.bots },
+            { "finished", s.finished },
+            { "mean_best_lap_s", bestLap },
+            { "mean_finish_s", finish },
+            { "mean_off_track_s", s.offTrackTotal / s.bots },
+            { "mean_wall_hits", static_cast<double>(s.wallHits) / s.bots },
+        });
+    }
+
+    if (!options.csvPath.empty()) {
+        writeCsv(options.csvPath, races);
+    }
+    if (!options.jsonPath.empty()) {
+        nlohmann::json bots = nlohmann::json::array();
+        for (const auto& race : races) {
+            for (const auto& bot : race.bots) {
+                std::vector<double> laps;
+                for (uint64_t lap : bot.lapTicks) {
+                    laps.push_back(toSeconds(lap));
+                }
+                bots.push_back({
+                    { "race", bot.race },
+                    { "slot", bot.slot },
+                    { "difficulty", bot.difficulty },
+                    { "lap_s", laps },
+                    { "finish_s", bot.finishTick ? nlohmann::json(toSeconds(bot.finishTick)) : nlohmann::json() },
+                    { "off_track_s", toSeconds(bot.offTrackTicks) },
+                    { "wall_hits", bot.wallHits },
+                });
+            }
+        }
+        nlohmann::json report = {
+            { "track", options.trackPath },
+            { "races", options.races },
+            { "laps", options.laps },
+            { "seed", options.seed },
+            { "threads", options.threads },
+            { "simulated_s", simulated },
+            { "step_s", stepSeconds },
+            { "wall_s", wallSeconds },
+            { "realtime_factor", realtime },
+            { "realtime_factor_per_thread", realtimePerThread },
+            { "summary", summaryJson },
+            { "bots", bots },
+        };
+        std::ofstream(options.jsonPath) << report.dump(2) << "\n";
+    }
+    return 0;
+}
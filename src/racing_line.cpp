@@ -0,0 +1,340 @@
+#include "racing_line.h"
+#include "track.h"
+#include "car_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace {
+
+Point2D centreOf(const Tile& tile) {
+    return { tile.x + tile.width / 2, tile.y + tile.height / 2 };
+}
+
+// Drivable tiles sharing an edge with each tile, found by probing just
+// outside each edge at a few points along it, in the tile's own frame
+std::vector<std::vector<uint32_t>> linkTiles(const Track& track) {
+    const auto& tiles = track.getTiles();
+    std::vector<std::vector<uint32_t>> links(tiles.size());
+    const float fractions[] = { 0.25f, 0.5f, 0.75f };
+
+    for (uint32_t i = 0; i < tiles.size(); ++i) {
+        const Tile& tile = tiles[i];
+        if (!isDrivable(tile.type)) {
+            continue;
+        }
+        const TileShape shape = shapeOf(tile);
+        for (float f : fractions) {
+            Point2D probes[] = {
+                { tile.x - 1.0f, tile.y + tile.height * f },
+                { tile.x + tile.width + 1.0f, tile.y + tile.height * f },
+                { tile.x + tile.width * f, tile.y - 1.0f },
+                { tile.x + tile.width * f, tile.y + tile.height + 1.0f },
+            };
+            for (auto& probe : probes) {
+                if (shape.rotated) {
+                    // The same point relative to the centre, turned with the tile
+                    shape.toWorld(probe.x - shape.centerX, probe.y - shape.centerY, probe.x, probe.y);
+                }
+                int other = track.drivableTileAt(probe.x, probe.y);
+                if (other >= 0 && static_cast<uint32_t>(other) != i) {
+                    links[i].push_back(static_cast<uint32_t>(other));
+                    links[other].push_back(i);
+                }
+            }
+        }
+    }
+
+    for (auto& list : links) {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+    }
+    return links;
+}
+
+// Shortest paths between tile centres from the sources, never entering
+// blocked tiles. Stops once target (if any) is settled. Ties resolve by
+// tile index, so the result only depends on the track.
+void shortestPaths(const std::vector<Tile>& tiles, const std::vector<std::vector<uint32_t>>& links,
+                   const std::vector<std::pair<uint32_t, float>>& sources, const std::vector<bool>& blocked,
+                   int target, std::vector<float>& distance, std::vector<int>& previous) {
+    const float infinity = std::numeric_limits<float>::infinity();
+    distance.assign(tiles.size(), infinity);
+    previous.assign(tiles.size(), -1);
+
+    using Entry = std::pair<float, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    for (const auto& source : sources) {
+        distance[source.first] = source.second;
+        open.push({ source.second, source.first });
+    }
+
+    while (!open.empty()) {
+        auto [d, tile] = open.top();
+        open.pop();
+        if (d > distance[tile]) {
+            continue;
+        }
+        if (static_cast<int>(tile) == target) {
+            return;
+        }
+        Point2D from = centreOf(tiles[tile]);
+        for (uint32_t next : links[tile]) {
+            if (blocked[next]) {
+                continue;
+            }
+            Point2D to = centreOf(tiles[next]);
+            float nd = d + std::hypot(to.x - from.x, to.y - from.y);
+            if (nd < distance[next]) {
+                distance[next] = nd;
+                previous[next] = static_cast<int>(tile);
+                open.push({ nd, next });
+            }
+        }
+    }
+}
+
+} // namespace
+
+RacingLine::RacingLine()
+    : closed(false)
+{
+}
+
+void RacingLine::clear() {
+    points.clear();
+    closed = false;
+}
+
+void RacingLine::build(const Track& track) {
+    clear();
+
+    const auto& tiles = track.getTiles();
+    const auto& starts = track.getStartPositions();
+
+    // Start on the tile under the first grid slot, else the first drivable one
+    int start = starts.empty() ? -1 : track.drivableTileAt(starts[0].x, starts[0].y);
+    for (uint32_t i = 0; start < 0 && i < tiles.size(); ++i) {
+        if (isDrivable(tiles[i].type)) {
+            start = static_cast<int>(i);
+        }
+    }
+    if (start < 0) {
+        return;
+    }
+
+    auto links = linkTiles(track);
+    const Point2D origin = centreOf(tiles[start]);
+
+    // Neighbour most directly ahead (+x) leads out, the one most directly
+    // behind leads back in
+    auto heading = [&](uint32_t tile) {
+        Point2D c = centreOf(tiles[tile]);
+        float dx = c.x - origin.x;
+        float dy = c.y - origin.y;
+        float length = std::hypot(dx, dy);
+        return length > 0.0f ? dx / length : 0.0f;
+    };
+    int ahead = -1;
+    int behind = -1;
+    for (uint32_t n : links[start]) {
+        if (ahead < 0 || heading(n) > heading(ahead)) {
+            ahead = static_cast<int>(n);
+        }
+    }
+    for (uint32_t n : links[start]) {
+        if (static_cast<int>(n) != ahead && (behind < 0 || heading(n) < heading(behind))) {
+            behind = static_cast<int>(n);
+        }
+    }
+
+    std::vector<float> distance;
+    std::vector<int> previous;
+    std::vector<int> route;
+
+    if (ahead >= 0 && behind >= 0) {
+        // Close the start tile and its other neighbours off, so the loop
+        // cannot just circle round the start on a wide road
+        std::vector<bool> blocked(tiles.size(), false);
+        blocked[start] = true;
+        for (uint32_t n : links[start]) {
+            blocked[n] = static_cast<int>(n) != ahead && static_cast<int>(n) != behind;
+        }
+        Point2D a = centreOf(tiles[ahead]);
+        shortestPaths(tiles, links, { { static_cast<uint32_t>(ahead), std::hypot(a.x - origin.x, a.y - origin.y) } },
+                      blocked, behind, distance, previous);
+
+        if (std::isfinite(distance[behind])) {
+            for (int tile = behind; tile >= 0; tile = previous[tile]) {
+                route.push_back(tile);
+            }
+            route.push_back(start);
+            std::reverse(route.begin(), route.end());
+            closed = true;
+        }
+    }
+
+    if (!closed) {
+        // No loop: run out to the farthest reachable tile
+        std::vector<bool> blocked(tiles.size(), false);
+        shortestPaths(tiles, links, { { static_cast<uint32_t>(start), 0.0f } }, blocked, -1, distance, previous);
+
+        int farthest = start;
+        for (uint32_t i = 0; i < tiles.size(); ++i) {
+            if (std::isfinite(distance[i]) && distance[i] > distance[farthest]) {
+                farthest = static_cast<int>(i);
+            }
+        }
+        for (int tile = farthest; tile >= 0; tile = previous[tile]) {
+            route.push_back(tile);
+        }
+        std::reverse(route.begin(), route.end());
+    }
+
+    std::vector<RacingPoint> centres;
+    for (int tile : route) {
+        Point2D c = centreOf(tiles[tile]);
+        centres.push_back({ c.x, c.y, 0.0f });
+    }
+
+    resample(centres);
+    relax(track);
+    assignSpeeds();
+}
+
+size_t RacingLine::next(size_t index) const {
+    return index + 1 < points.size() ? index + 1 : 0;
+}
+
+size_t RacingLine::nearest(float x, float y) const {
+    size_t best = 0;
+    float bestDistance = std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < points.size(); ++i) {
+        float dx = points[i].x - x;
+        float dy = points[i].y - y;
+        float d = dx * dx + dy * dy;
+        if (d < bestDistance) {
+            bestDistance = d;
+            best = i;
+        }
+    }
+    return best;
+}
+
+void RacingLine::resample(const std::vector<RacingPoint>& centres) {
+    points.clear();
+    if (centres.size() < 2) {
+        points = centres;
+        return;
+    }
+
+    const size_t segments = closed ? centres.size() : centres.size() - 1;
+    float carry = 0.0f; // Distance into the current segment of the next sample
+    for (size_t i = 0; i < segments; ++i) {
+        const RacingPoint& a = centres[i];
+        const RacingPoint& b = centres[(i + 1) % centres.size()];
+        float length = std::hypot(b.x - a.x, b.y - a.y);
+
+        for (float along = carry; along < length; along += SPACING) {
+            float t = along / length;
+            points.push_back({ a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, 0.0f });
+        }
+        carry = std::fmod(carry - length, SPACING);
+        if (carry < 0.0f) {
+            carry += SPACING;
+        }
+    }
+
+    if (!closed) {
+        points.push_back(centres.back());
+    }
+}
+
+void RacingLine::relax(const Track& track) {
+    const size_t count = points.size();
+    if (count < 5) {
+        return;
+    }
+
+    // The whole car circle has to stay on drivable tiles
+    const float margin = CarPool::RADIUS;
+    auto clear = [&](float x, float y) {
+        return track.isOnTrack(x, y) &&
+               track.isOnTrack(x - margin, y) && track.isOnTrack(x + margin, y) &&
+               track.isOnTrack(x, y - margin) && track.isOnTrack(x, y + margin);
+    };
+
+    const size_t first = closed ? 0 : 2;
+    const size_t last = closed ? count : count - 2;
+
+    for (int pass = 0; pass < SMOOTHING_PASSES; ++pass) {
+        for (size_t i = first; i < last; ++i) {
+            const RacingPoint& a = points[(i + count - 2) % count];
+            const RacingPoint& b = points[(i + count - 1) % count];
+            const RacingPoint& c = points[(i + 1) % count];
+            const RacingPoint& d = points[(i + 2) % count];
+            RacingPoint& p = points[i];
+
+            // Where p would make the turn through its neighbours change
+            // evenly; stepping there spreads each bend along the line
+            // instead of just shortening it
+            float goalX = (4.0f * (b.x + c.x) - a.x - d.x) / 6.0f;
+            float goalY = (4.0f * (b.y + c.y) - a.y - d.y) / 6.0f;
+
+            // Shorter steps near the edges; points that start too close to
+            // one may still move as long as they stay on the road
+            bool wasClear = clear(p.x, p.y);
+            for (float step = 0.5f; step > 0.05f; step *= 0.5f) {
+                float x = p.x + (goalX - p.x) * step;
+                float y = p.y + (goalY - p.y) * step;
+                if (clear(x, y) || (!wasClear && track.isOnTrack(x, y))) {
+                    p.x = x;
+                    p.y = y;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void RacingLine::assignSpeeds() {
+    const size_t count = points.size();
+    if (count == 0) {
+        return;
+    }
+
+    // Cornering limit from the circle through each point and the points two
+    // samples either side
+    for (size_t i = 0; i < count; ++i) {
+        float speed = CarPool::MAX_SPEED;
+        bool interior = closed || (i >= 2 && i + 2 < count);
+        if (count >= 5 && interior) {
+            const RacingPoint& a = points[(i + count - 2) % count];
+            const RacingPoint& b = points[i];
+            const RacingPoint& c = points[(i + 2) % count];
+            float ab = std::hypot(b.x - a.x, b.y - a.y);
+            float bc = std::hypot(c.x - b.x, c.y - b.y);
+            float ca = std::hypot(a.x - c.x, a.y - c.y);
+            float cross = std::fabs((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+            if (cross > 1e-3f) {
+                float radius = ab * bc * ca / (2.0f * cross);
+                speed = std::min(speed, std::sqrt(LATERAL_GRIP * radius));
+            }
+        }
+        points[i].speed = speed;
+    }
+
+    // Brake in time for slower points ahead. Twice round a closed line lets
+    // the limits carry across the wrap.
+    const size_t steps = closed ? 2 * count : count - 1;
+    for (size_t s = 0; s < steps; ++s) {
+        size_t i = closed ? (2 * count - 1 - s) % count : count - 2 - s;
+        const RacingPoint& next = points[(i + 1) % count];
+        float gap = std::hypot(next.x - points[i].x, next.y - points[i].y);
+        float reachable = std::sqrt(next.speed * next.speed + 2.0f * CarPool::BRAKE_FORCE * gap);
+        points[i].speed = std::min(points[i].speed, reachable);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef RACING_LINE_H
+#define RACING_LINE_H
+
+#include <cstddef>
+#include <vector>
+
+class Track;
+
+struct RacingPoint {
+    float x, y;
+    float speed; // Target speed through this point
+};
+
+// Line the AI drives around a track, derived from its tiles alone.
+//
+// build() links drivable tiles that share an edge, walks the shortest loop
+// of tile centres that leaves the start tile forwards (+x, the way cars
+// spawn facing) and comes back into it from behind, and resamples that
+// loop every SPACING px. The loop is then relaxed towards lower curvature,
+// each point moving only while the car's whole circle stays on the track,
+// so it cuts corners as far as the road allows. Finally every point gets
+// the highest speed the corner ahead allows under LATERAL_GRIP, lowered
+// where the car would otherwise be unable to brake for the next one.
+//
+// Tracks whose tiles do not close into a loop get an open line from the
+// start tile to the farthest reachable tile, which bots drive end to end
+// and then start again.
+class RacingLine {
+public:
+    static constexpr float SPACING = 20.0f;
+    static constexpr float LATERAL_GRIP = 300.0f; // px/s^2 of cornering
+    static constexpr int SMOOTHING_PASSES = 150;
+
+    RacingLine();
+
+    void build(const Track& track);
+    void clear();
+
+    const std::vector<RacingPoint>& getPoints() const { return points; }
+    bool empty() const { return points.empty(); }
+    size_t size() const { return points.size(); }
+    bool isClosed() const { return closed; }
+
+    // Following point, wrapping from the last back to the first
+    size_t next(size_t index) const;
+
+    // Point closest to (x, y); the line must not be empty
+    size_t nearest(float x, float y) const;
+
+private:
+    std::vector<RacingPoint> points;
+    bool closed;
+
+    void resample(const std::vector<RacingPoint>& centres);
+    void relax(const Track& track);
+    void assignSpeeds();
+};
+
+#endif // RACING_LINE_H
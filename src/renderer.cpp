@@ -1,92 +1,442 @@
 #include "renderer.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+namespace {
+
+std::vector<SDL_FPoint> makeRing(int segments) {
+    std::vector<SDL_FPoint> ring(segments);
+    for (int i = 0; i < segments; ++i) {
+        double angle = 6.283185307179586 * i / segments;
+        ring[i] = { static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)) };
+    }
+    return ring;
+}
+
+// Cohen-Sutherland clip of a whole-pixel line to a width x height output,
+// with the same integer arithmetic as SDL_GetRectAndLineIntersection, so
+// the clipped ends land where SDL's own line drawing puts them
+bool clipLine(int width, int height, int& x1, int& y1, int& x2, int& y2) {
+    enum { BOTTOM = 1, TOP = 2, LEFT = 4, RIGHT = 8 };
+    const int right = width - 1;
+    const int bottom = height - 1;
+    auto outcode = [&](int x, int y) {
+        int code = 0;
+        if (y < 0) {
+            code |= TOP;
+        } else if (y > bottom) {
+            code |= BOTTOM;
+        }
+        if (x < 0) {
+            code |= LEFT;
+        } else if (x > right) {
+            code |= RIGHT;
+        }
+        return code;
+    };
+
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    int code1 = outcode(x1, y1);
+    int code2 = outcode(x2, y2);
+    while (code1 || code2) {
+        if (code1 & code2) {
+            return false;
+        }
+        int& code = code1 ? code1 : code2;
+        int x, y;
+        if (code & TOP) {
+            y = 0;
+            x = static_cast<int>(x1 + static_cast<int64_t>(x2 - x1) * (y - y1) / (y2 - y1));
+        } else if (code & BOTTOM) {
+            y = bottom;
+            x = static_cast<int>(x1 + static_cast<int64_t>(x2 - x1) * (y - y1) / (y2 - y1));
+        } else if (code & LEFT) {
+            x = 0;
+            y = static_cast<int>(y1 + static_cast<int64_t>(y2 - y1) * (x - x1) / (x2 - x1));
+        } else {
+            x = right;
+            y = static_cast<int>(y1 + static_cast<int64_t>(y2 - y1) * (x - x1) / (x2 - x1));
+        }
+        (code1 ? x1 : x2) = x;
+        (code1 ? y1 : y2) = y;
+        code = outcode(x, y);
+    }
+    return true;
+}
+
+} // namespace
 
 Renderer::Renderer(SDL_Renderer* sdlRenderer)
     : renderer(sdlRenderer)
+    , batching(true)
+    , drawCalls(0)
+    , textBackend(nullptr)
+    , color{ 1.0f, 1.0f, 1.0f, 1.0f }
 {
 }
 
 Renderer::~Renderer() {
 }
 
+void Renderer::setBatching(bool enabled) {
+    if (enabled != batching) {
+        flush();
+        batching = enabled;
+    }
+}
+
+void Renderer::setColor(int r, int g, int b) {
+    if (batching) {
+        color = { r / 255.0f, g / 255.0f, b / 255.0f, 1.0f };
+    } else {
+        SDL_SetRenderDrawColor(renderer, r, g, b, 255);
+    }
+}
+
+void Renderer::flush() {
+    if (!indices.empty() && renderer) {
+        SDL_RenderGeometry(renderer, nullptr, vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+        ++drawCalls;
+    }
+    if (textBackend && textBackend->flushText()) {
+        ++drawCalls;
+    }
+    // Capacity is kept for the next layer
+    vertices.clear();
+    indices.clear();
+}
+
+void Renderer::queueQuad(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3) {
+    // Triangles (0, 1, 2) and (0, 2, 3): the layout the software renderer
+    // recognises as a rectangle when the corners are axis-aligned
+    int base = static_cast<int>(vertices.size());
+    vertices.push_back({ { x0, y0 }, color, { 0.0f, 0.0f } });
+    vertices.push_back({ { x1, y1 }, color, { 0.0f, 0.0f } });
+    vertices.push_back({ { x2, y2 }, color, { 0.0f, 0.0f } });
+    vertices.push_back({ { x3, y3 }, color, { 0.0f, 0.0f } });
+    indices.push_back(base);
+    indices.push_back(base + 1);
+    indices.push_back(base + 2);
+    indices.push_back(base);
+    indices.push_back(base + 2);
+    indices.push_back(base + 3);
+}
+
+void Renderer::queueFillRect(float x, float y, float w, float h) {
+    queueQuad(x, y, x + w, y, x + w, y + h, x, y + h);
+}
+
+void Renderer::queueLine(float x1, float y1, float x2, float y2) {
+    // The pixels SDL_RenderLine plots by default: straight lines as one
+    // rectangle covering both ends, anything else rounded to whole pixels,
+    // clipped to the output and stepped with Bresenham. Each run of pixels
+    // along the main axis goes in as one span.
+    if (y1 == y2) {
+        queueFillRect(std::fmin(x1, x2), y1, std::fabs(x2 - x1) + 1.0f, 1.0f);
+        return;
+    }
+    if (x1 == x2) {
+        queueFillRect(x1, std::fmin(y1, y2), 1.0f, std::fabs(y2 - y1) + 1.0f);
+        return;
+    }
+
+    int ax = static_cast<int>(std::round(x1));
+    int ay = static_cast<int>(std::round(y1));
+    int bx = static_cast<int>(std::round(x2));
+    int by = static_cast<int>(std::round(y2));
+    int width = 0, height = 0;
+    SDL_GetCurrentRenderOutputSize(renderer, &width, &height);
+    if (!clipLine(width, height, ax, ay, bx, by)) {
+        return;
+    }
+
+    const int dx = std::abs(bx - ax);
+    const int dy = std::abs(by - ay);
+    const bool alongX = dx >= dy;
+    const int major = alongX ? dx : dy;
+    const int minor = alongX ? dy : dx;
+    const int stepX = bx < ax ? -1 : 1;
+    const int stepY = by < ay ? -1 : 1;
+    int d = 2 * minor - major;
+    int x = ax, y = ay;
+    int runX = x, runY = y, runLength = 0;
+    for (int i = 0; i <= major; ++i) {
+        ++runLength;
+        bool stepsMinor = d >= 0;
+        d += stepsMinor ? 2 * (minor - major) : 2 * minor;
+        if (alongX) {
+            x += stepX;
+        } else {
+            y += stepY;
+        }
+        if (stepsMinor || i == major) {
+            if (alongX) {
+                queueFillRect(static_cast<float>(std::min(runX, runX + stepX * (runLength - 1))),
+                              static_cast<float>(runY), static_cast<float>(runLength), 1.0f);
+            } else {
+                queueFillRect(static_cast<float>(runX),
+                              static_cast<float>(std::min(runY, runY + stepY * (runLength - 1))),
+                              1.0f, static_cast<float>(runLength));
+            }
+            if (stepsMinor) {
+                if (alongX) {
+                    y += stepY;
+                } else {
+                    x += stepX;
+                }
+            }
+            runX = x;
+            runY = y;
+            runLength = 0;
+        }
+    }
+}
+
 void Renderer::drawLine(float x1, float y1, float x2, float y2, int r, int g, int b) {
-    SDL_SetRenderDrawColor(renderer, r, g, b, 255);
+    if (!renderer) {
+        return;
+    }
+    setColor(r, g, b);
+    if (batching) {
+        queueLine(x1, y1, x2, y2);
+        return;
+    }
     SDL_RenderLine(renderer, x1, y1, x2, y2);
+    ++drawCalls;
 }
 
 void Renderer::drawRect(float x, float y, float w, float h, int r, int g, int b, bool filled) {
-    SDL_SetRenderDrawColor(renderer, r, g, b, 255);
+    if (!renderer) {
+        return;
+    }
+    setColor(r, g, b);
+
+    if (batching) {
+        if (filled) {
+            queueFillRect(x, y, w, h);
+        } else if (w > 0.0f && h > 0.0f) {
+            // Four one-pixel strips, as SDL_RenderRect outlines the pixels
+            // from x to x + w - 1
+            queueFillRect(x, y, w, 1.0f);
+            if (h > 1.0f) {
+                queueFillRect(x, y + h - 1.0f, w, 1.0f);
+            }
+            if (h > 2.0f) {
+                queueFillRect(x, y + 1.0f, 1.0f, h - 2.0f);
+                if (w > 1.0f) {
+                    queueFillRect(x + w - 1.0f, y + 1.0f, 1.0f, h - 2.0f);
+                }
+            }
+        }
+        return;
+    }
+
     SDL_FRect rect = { x, y, w, h };
-    
+
     if (filled) {
         SDL_RenderFillRect(renderer, &rect);
     } else {
         SDL_RenderRect(renderer, &rect);
     }
+    ++drawCalls;
 }
 
-void Renderer::drawCircle(float cx, float cy, float radius, int r, int g, int b) {
-    SDL_SetRenderDrawColor(renderer, r, g, b, 255);
-    
+void Renderer::drawCircle(float cx, float cy, float radius, int r, int g, int b, bool filled) {
+    if (!renderer || !(radius >= 0.0f)) {
+        return;
+    }
+
+    if (filled) {
+        // Fan around the centre; immediate mode sends just this one batch
+        color = { r / 255.0f, g / 255.0f, b / 255.0f, 1.0f };
+        const std::vector<SDL_FPoint>& ring = unitCircle(radius);
+        int centre = static_cast<int>(vertices.size());
+        vertices.push_back({ { cx, cy }, color, { 0.0f, 0.0f } });
+        for (const SDL_FPoint& p : ring) {
+            vertices.push_back({ { cx + p.x * radius, cy + p.y * radius }, color, { 0.0f, 0.0f } });
+        }
+        int count = static_cast<int>(ring.size());
+        for (int i = 0; i < count; ++i) {
+            indices.push_back(centre);
+            indices.push_back(centre + 1 + i);
+            indices.push_back(centre + 1 + (i + 1) % count);
+        }
+        if (!batching) {
+            flush();
+        }
+        return;
+    }
+
+    setColor(r, g, b);
+
+    // Same truncation as the old per-point midpoint code
+    const int x = static_cast<int>(cx);
+    const int y = static_cast<int>(cy);
+    const std::vector<CircleSpan>& spans = circleOutline(static_cast<int>(radius));
+
+    if (batching) {
+        for (const CircleSpan& span : spans) {
+            queueFillRect(static_cast<float>(x + span.dx), static_cast<float>(y + span.dy),
+                          static_cast<float>(span.length), 1.0f);
+        }
+        return;
+    }
+
+    pointScratch.clear();
+    for (const CircleSpan& span : spans) {
+        for (int i = 0; i < span.length; ++i) {
+            pointScratch.push_back({ static_cast<float>(x + span.dx + i), static_cast<float>(y + span.dy) });
+        }
+    }
+    SDL_RenderPoints(renderer, pointScratch.data(), static_cast<int>(pointScratch.size()));
+    ++drawCalls;
+}
+
+const std::vector<Renderer::CircleSpan>& Renderer::circleOutline(int radius) {
+    if (radius > MAX_CACHED_RADIUS) {
+        buildCircleOutline(radius, spanScratch);
+        return spanScratch;
+    }
+    if (circleOutlines.size() <= static_cast<size_t>(radius)) {
+        circleOutlines.resize(radius + 1);
+    }
+    std::vector<CircleSpan>& spans = circleOutlines[radius];
+    if (spans.empty()) {
+        buildCircleOutline(radius, spans);
+    }
+    return spans;
+}
+
+void Renderer::buildCircleOutline(int radius, std::vector<CircleSpan>& out) {
+    // Midpoint circle, mirrored into all eight octants
+    std::vector<std::pair<int, int>> pixels; // (dy, dx)
     int x = radius;
     int y = 0;
     int err = 0;
-    
+
     while (x >= y) {
-        drawCirclePoints(cx, cy, x, y);
-        
+        const int offsets[8][2] = {
+            { y, x }, { y, -x }, { -y, x }, { -y, -x },
+            { x, y }, { x, -y }, { -x, y }, { -x, -y }
+        };
+        for (const auto& o : offsets) {
+            pixels.push_back({ o[0], o[1] });
+        }
+
         if (err <= 0) {
             y += 1;
             err += 2 * y + 1;
         }
-        
+
         if (err > 0) {
             x -= 1;
             err -= 2 * x + 1;
         }
     }
+
+    // Octants meet on shared pixels; keep each once and join neighbours
+    // on a row into spans
+    std::sort(pixels.begin(), pixels.end());
+    pixels.erase(std::unique(pixels.begin(), pixels.end()), pixels.end());
+
+    out.clear();
+    for (const auto& pixel : pixels) {
+        if (!out.empty() && out.back().dy == pixel.first &&
+            out.back().dx + out.back().length == pixel.second) {
+            ++out.back().length;
+        } else {
+            out.push_back({ pixel.first, pixel.second, 1 });
+        }
+    }
 }
 
-void Renderer::drawCirclePoints(int cx, int cy, int x, int y) {
-    SDL_RenderPoint(renderer, cx + x, cy + y);
-    SDL_RenderPoint(renderer, cx - x, cy + y);
-    SDL_RenderPoint(renderer, cx + x, cy - y);
-    SDL_RenderPoint(renderer, cx - x, cy - y);
-    SDL_RenderPoint(renderer, cx + y, cy + x);
-    SDL_RenderPoint(renderer, cx - y, cy + x);
-    SDL_RenderPoint(renderer, cx + y, cy - x);
-    SDL_RenderPoint(renderer, cx - y, cy - x);
+const std::vector<SDL_FPoint>& Renderer::unitCircle(float radius) {
+    // Radius buckets and their segment counts: edges stay a few pixels long
+    static const float limits[] = { 4.0f, 16.0f, 64.0f, 256.0f };
+    static const std::vector<SDL_FPoint> rings[] = {
+        makeRing(12), makeRing(24), makeRing(48), makeRing(96), makeRing(192)
+    };
+
+    size_t bucket = 0;
+    while (bucket < 4 && radius > limits[bucket]) {
+        ++bucket;
+    }
+    return rings[bucket];
 }
 
 void Renderer::drawPolygon(SDL_FPoint* points, int count, int r, int g, int b) {
-    SDL_SetRenderDrawColor(renderer, r, g, b, 255);
-    
+    if (!renderer || count <= 0) {
+        return;
+    }
+    setColor(r, g, b);
+
     // Draw filled polygon using scanline algorithm (simplified)
     // For now, just draw the outline
-    for (int i = 0; i < count - 1; ++i) {
-        SDL_RenderLine(renderer, points[i].x, points[i].y, 
-                      points[i + 1].x, points[i + 1].y);
+    for (int i = 0; i < count; ++i) {
+        const SDL_FPoint& from = points[i];
+        const SDL_FPoint& to = points[(i + 1) % count];
+        if (batching) {
+            queueLine(from.x, from.y, to.x, to.y);
+        } else {
+            SDL_RenderLine(renderer, from.x, from.y, to.x, to.y);
+            ++drawCalls;
+        }
+    }
+}
+
+void Renderer::drawQuad(const SDL_FPoint corners[4], int r, int g, int b, bool filled) {
+    if (!renderer) {
+        return;
+    }
+
+    if (filled) {
+        // Two triangles; immediate mode sends just this one batch
+        color = { r / 255.0f, g / 255.0f, b / 255.0f, 1.0f };
+        queueQuad(corners[0].x, corners[0].y, corners[1].x, corners[1].y,
+                  corners[2].x, corners[2].y, corners[3].x, corners[3].y);
+        if (!batching) {
+            flush();
+        }
+        return;
+    }
+
+    setColor(r, g, b);
+    for (int i = 0; i < 4; ++i) {
+        const SDL_FPoint& from = corners[i];
+        const SDL_FPoint& to = corners[(i + 1) % 4];
+        if (batching) {
+            queueLine(from.x, from.y, to.x, to.y);
+        } else {
+            SDL_RenderLine(renderer, from.x, from.y, to.x, to.y);
+            ++drawCalls;
+        }
     }
-    SDL_RenderLine(renderer, points[count - 1].x, points[count - 1].y,
-                  points[0].x, points[0].y);
 }
 
 void Renderer::renderText(const std::string& text, int x, int y, int r, int g, int b, float scale) {
-    // Simple bitmap-style text rendering
-    // For a real game, use SDL_ttf
-    // For now, just draw a placeholder rectangle
-    SDL_SetRenderDrawColor(renderer, r, g, b, 255);
-    
+    if (!renderer) {
+        return;
+    }
+
+    SDL_FColor textColor = { r / 255.0f, g / 255.0f, b / 255.0f, 1.0f };
+    if (textBackend && textBackend->queueText(text, x, y, textColor, scale)) {
+        if (!batching && textBackend->flushText()) {
+            ++drawCalls;
+        }
+        return;
+    }
+
+    // Placeholder without a font: one outline box per character
     int charWidth = 8 * scale;
     int charHeight = 12 * scale;
-    
+
     for (size_t i = 0; i < text.length(); ++i) {
-        SDL_FRect rect = { 
-            x + i * charWidth, 
-            y, 
-            charWidth - 2, 
-            charHeight 
-        };
-        SDL_RenderRect(renderer, &rect);
+        drawRect(x + i * charWidth, y, charWidth - 2, charHeight, r, g, b, false);
     }
 }
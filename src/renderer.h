@@ -2,24 +2,109 @@
 #define RENDERER_H
 
 #include <SDL3/SDL.h>
+#include <cstddef>
 #include <string>
+#include <vector>
 
+// What the render paths drew and skipped as off-screen, counted until the
+// next resetStats()
+struct RenderStats {
+    size_t tilesSubmitted = 0, tilesCulled = 0;
+    size_t carsSubmitted = 0, carsCulled = 0;
+    size_t overlaysSubmitted = 0, overlaysCulled = 0;
+    size_t chunksSubmitted = 0;
+};
+
+// Draws text for Renderer::renderText in place of the placeholder boxes
+// (see TextRenderer). Queued text goes out in flushText(), above the shapes
+// of the same layer.
+class TextBackend {
+public:
+    virtual ~TextBackend() = default;
+
+    // False if the string cannot be drawn, so the placeholder is used
+    virtual bool queueText(const std::string& text, float x, float y, SDL_FColor color, float scale) = 0;
+    // Draws everything queued; true if that took a draw call
+    virtual bool flushText() = 0;
+};
+
+// 2D drawing on top of an SDL renderer.
+//
+// With batching on (the default) every primitive becomes coloured
+// triangles in one reusable vertex/index buffer, and flush() hands the
+// whole layer to SDL_RenderGeometry in a single call, in submission order.
+// Rectangles become axis-aligned quads, which the software renderer turns
+// back into exact fill rects; lines become one-pixel-wide quads. Call
+// flush() before anything draws straight through SDL (clear, present,
+// textures). With batching off, every primitive is drawn immediately.
 class Renderer {
 public:
+    // Outline pixel layouts up to this radius are kept once computed
+    static constexpr int MAX_CACHED_RADIUS = 256;
+
     Renderer(SDL_Renderer* sdlRenderer);
     ~Renderer();
-    
+
     void drawLine(float x1, float y1, float x2, float y2, int r, int g, int b);
     void drawRect(float x, float y, float w, float h, int r, int g, int b, bool filled = true);
-    void drawCircle(float x, float y, float radius, int r, int g, int b);
+    // The outline is the midpoint circle's pixels, the fill a triangle fan
+    void drawCircle(float x, float y, float radius, int r, int g, int b, bool filled = false);
     void drawPolygon(SDL_FPoint* points, int count, int r, int g, int b);
-    
+    // Any four corners in order around the edge, e.g. a rotated rectangle
+    void drawQuad(const SDL_FPoint corners[4], int r, int g, int b, bool filled = true);
+
     void renderText(const std::string& text, int x, int y, int r, int g, int b, float scale = 1.0f);
-    
+
+    // Optional; without one, text is drawn as one outline box per character
+    void setTextBackend(TextBackend* backend) { textBackend = backend; }
+
+    // Submits everything queued since the last flush
+    void flush();
+
+    void setBatching(bool enabled);
+    bool isBatching() const { return batching; }
+
+    // Null when there is nothing to draw to (headless without --offscreen)
+    SDL_Renderer* getSDLRenderer() const { return renderer; }
+
+    // SDL draw calls issued since the last resetDrawCalls()
+    size_t getDrawCalls() const { return drawCalls; }
+    void resetDrawCalls() { drawCalls = 0; }
+
+    RenderStats& getStats() { return stats; }
+    const RenderStats& getStats() const { return stats; }
+    void resetStats() { stats = RenderStats(); }
+
 private:
     SDL_Renderer* renderer;
-    
-    void drawCirclePoints(int cx, int cy, int x, int y);
+    bool batching;
+    size_t drawCalls;
+    TextBackend* textBackend;
+    RenderStats stats;
+
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+
+    // Run of outline pixels on row dy, from dx to dx + length - 1,
+    // relative to the centre
+    struct CircleSpan {
+        int dy, dx, length;
+    };
+    std::vector<std::vector<CircleSpan>> circleOutlines; // By radius
+    std::vector<CircleSpan> spanScratch;
+    std::vector<SDL_FPoint> pointScratch;
+
+    const std::vector<CircleSpan>& circleOutline(int radius);
+    static void buildCircleOutline(int radius, std::vector<CircleSpan>& out);
+    // Unit circle with a segment count suited to the radius
+    static const std::vector<SDL_FPoint>& unitCircle(float radius);
+
+    // Batched primitives in the current colour
+    void queueQuad(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3);
+    void queueFillRect(float x, float y, float w, float h);
+    void queueLine(float x1, float y1, float x2, float y2);
+    void setColor(int r, int g, int b);
+    SDL_FColor color;
 };
 
 #endif // RENDERER_H
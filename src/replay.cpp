@@ -0,0 +1,254 @@
+#include "replay.h"
+#include "simulation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+constexpr char REPLAY_MAGIC[4] = { 'M', 'R', 'R', 'P' };
+
+// Explicit little-endian bytes, so replays move between machines
+void writeUint(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+class Reader {
+public:
+    explicit Reader(const std::vector<uint8_t>& data) : data(data), offset(0), failed(false) {}
+
+    uint64_t readUint(int bytes) {
+        if (data.size() - offset < static_cast<size_t>(bytes)) {
+            failed = true;
+            return 0;
+        }
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(data[offset++]) << (8 * i);
+        }
+        return value;
+    }
+
+    uint64_t readVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (offset >= data.size()) {
+                break;
+            }
+            uint8_t byte = data[offset++];
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        failed = true;
+        return 0;
+    }
+
+    std::string readString(size_t length) {
+        if (data.size() - offset < length) {
+            failed = true;
+            return std::string();
+        }
+        std::string text(reinterpret_cast<const char*>(data.data() + offset), length);
+        offset += length;
+        return text;
+    }
+
+    bool ok() const { return !failed; }
+
+private:
+    const std::vector<uint8_t>& data;
+    size_t offset;
+    bool failed;
+};
+
+} // namespace
+
+uint8_t Replay::pack(const InputState& state) {
+    return static_cast<uint8_t>(state.forward | state.backward << 1 | state.left << 2 | state.right << 3);
+}
+
+InputState Replay::unpack(uint8_t controls) {
+    InputState state;
+    state.forward = controls & 1;
+    state.backward = controls & 2;
+    state.left = controls & 4;
+    state.right = controls & 8;
+    return state;
+}
+
+bool Replay::save(const std::string& filename) const {
+    std::vector<uint8_t> out(REPLAY_MAGIC, REPLAY_MAGIC + sizeof(REPLAY_MAGIC));
+    writeUint(out, VERSION, 2);
+    writeUint(out, trackPath.size(), 2);
+    out.insert(out.end(), trackPath.begin(), trackPath.end());
+    writeUint(out, botCount, 2);
+    writeUint(out, difficulty, 1);
+    writeUint(out, ticks, 8);
+    writeUint(out, finalHash, 8);
+
+    for (const auto& runs : cars) {
+        writeUint(out, runs.size(), 4);
+        uint64_t previous = 0;
+        for (const Run& run : runs) {
+            writeVarint(out, (run.tick - previous) << 4 | run.controls);
+            previous = run.tick;
+        }
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()))) {
+        std::cerr << "Failed to save replay: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Replay::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open replay: " << filename << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Reader in(data);
+    if (in.readString(sizeof(REPLAY_MAGIC)) != std::string(REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) ||
+        in.readUint(2) != VERSION) {
+        std::cerr << "Not a replay, or from another version: " << filename << std::endl;
+        return false;
+    }
+
+    trackPath = in.readString(in.readUint(2));
+    botCount = static_cast<int>(in.readUint(2));
+    difficulty = static_cast<int>(in.readUint(1));
+    ticks = in.readUint(8);
+    finalHash = in.readUint(8);
+
+    cars.assign(botCount + 1, {});
+    for (auto& runs : cars) {
+        uint64_t count = in.readUint(4);
+        uint64_t tick = 0;
+        for (uint64_t i = 0; i < count && in.ok(); ++i) {
+            uint64_t packed = in.readVarint();
+            tick += packed >> 4;
+            runs.push_back({ tick, static_cast<uint8_t>(packed & 0x0f) });
+        }
+    }
+
+    if (!in.ok()) {
+        std::cerr << "Truncated replay: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Replay::start(Simulation& simulation) const {
+    if (!simulation.loadTrack(trackPath)) {
+        std::cerr << "Failed to load replay track: " << trackPath << std::endl;
+        return false;
+    }
+    simulation.spawnCars(botCount, difficulty);
+    return true;
+}
+
+InputState Replay::controls(size_t car, uint64_t tick) const {
+    if (car >= cars.size()) {
+        return InputState();
+    }
+    const auto& runs = cars[car];
+    auto after = std::upper_bound(runs.begin(), runs.end(), tick,
+        [](uint64_t t, const Run& run) { return t < run.tick; });
+    return after == runs.begin() ? InputState() : unpack(std::prev(after)->controls);
+}
+
+void ReplayRecorder::begin(const std::string& trackPath, int botCount, int difficulty) {
+    replay = Replay();
+    replay.trackPath = trackPath;
+    replay.botCount = botCount;
+    replay.difficulty = difficulty;
+    replay.cars.assign(botCount + 1, {});
+    recording = true;
+}
+
+void ReplayRecorder::record(const InputState& player, const Simulation& simulation) {
+    if (!recording) {
+        return;
+    }
+    append(0, Replay::pack(player));
+    const auto& bots = simulation.getBots();
+    for (size_t i = 0; i < bots.size() && i + 1 < replay.cars.size(); ++i) {
+        append(i + 1, Replay::pack(bots[i]->getInput()));
+    }
+    ++replay.ticks;
+}
+
+void ReplayRecorder::append(size_t car, uint8_t controls) {
+    auto& runs = replay.cars[car];
+    if (runs.empty() || runs.back().controls != controls) {
+        runs.push_back({ replay.ticks, controls });
+    }
+}
+
+void ReplayRecorder::finish(const Simulation& simulation) {
+    replay.finalHash = simulation.stateHash();
+    recording = false;
+}
+
+ReplayResult playReplay(const Replay& replay) {
+    ReplayResult result = {};
+    result.firstDesync = -1;
+
+    Simulation simulation;
+    if (!replay.start(simulation)) {
+        return result;
+    }
+    result.started = true;
+
+    // One cursor per car, so each tick is a comparison rather than a search
+    std::vector<size_t> next(replay.cars.size(), 0);
+    std::vector<uint8_t> current(replay.cars.size(), 0);
+    StateInput player;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t tick = 0; tick < replay.ticks; ++tick) {
+        for (size_t car = 0; car < replay.cars.size(); ++car) {
+            const auto& runs = replay.cars[car];
+            while (next[car] < runs.size() && runs[next[car]].tick <= tick) {
+                current[car] = runs[next[car]++].controls;
+            }
+        }
+
+        player.state = Replay::unpack(current[0]);
+        simulation.step(player);
+
+        if (result.firstDesync < 0) {
+            const auto& bots = simulation.getBots();
+            for (size_t i = 0; i < bots.size() && i + 1 < current.size(); ++i) {
+                if (Replay::pack(bots[i]->getInput()) != current[i + 1]) {
+                    result.firstDesync = static_cast<int64_t>(tick);
+                    break;
+                }
+            }
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.ticks = simulation.getTick();
+    result.hash = simulation.stateHash();
+    result.hashMatches = result.hash == replay.finalHash;
+    return result;
+}
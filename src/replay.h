@@ -0,0 +1,85 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "input.h"
+
+class Simulation;
+
+// Per-tick controls of every car in a race, player first, then the bots
+// in spawn order. A car's controls are stored as runs: one entry each time
+// they change, so a held key costs nothing however long the race.
+//
+// File format (little-endian): "MRRP", u16 version, u16 track path length
+// and the path, u16 bot count, u8 difficulty, u64 ticks, u64 final state
+// hash, then for each car a u32 run count and the runs, each a varint of
+// (ticks since the previous change << 4 | control bits).
+class Replay {
+public:
+    // Bumped whenever the simulation changes so old races no longer play
+    // back: 2 for swept wall collisions
+    static constexpr uint16_t VERSION = 2;
+
+    struct Run {
+        uint64_t tick; // First tick with these controls
+        uint8_t controls;
+    };
+
+    static uint8_t pack(const InputState& state);
+    static InputState unpack(uint8_t controls);
+
+    bool load(const std::string& filename);
+    bool save(const std::string& filename) const;
+
+    // Sets up a race the way it was recorded: loads the track and spawns
+    // the same cars
+    bool start(Simulation& simulation) const;
+
+    // Controls of car on tick, read from its runs
+    InputState controls(size_t car, uint64_t tick) const;
+
+    std::string trackPath;
+    int botCount = 0;
+    int difficulty = 1;
+    uint64_t ticks = 0;
+    uint64_t finalHash = 0;
+    std::vector<std::vector<Run>> cars;
+};
+
+// Builds a Replay from a race as it runs: call begin() once the cars are
+// spawned and record() after every Simulation::step().
+class ReplayRecorder {
+public:
+    void begin(const std::string& trackPath, int botCount, int difficulty);
+    void record(const InputState& player, const Simulation& simulation);
+
+    // Stamps the final hash and tick count
+    void finish(const Simulation& simulation);
+
+    bool isRecording() const { return recording; }
+    const Replay& getReplay() const { return replay; }
+
+private:
+    Replay replay;
+    bool recording = false;
+
+    void append(size_t car, uint8_t controls);
+};
+
+// Re-simulates a replay without rendering, as fast as the simulation goes,
+// feeding the player's controls through a StateInput and checking the bots
+// still choose the recorded ones.
+struct ReplayResult {
+    bool started;
+    uint64_t ticks;
+    double seconds;
+    uint64_t hash;
+    bool hashMatches;
+    int64_t firstDesync; // First tick a bot's controls differ, -1 if none
+};
+
+ReplayResult playReplay(const Replay& replay);
+
+#endif // REPLAY_H
@@ -0,0 +1,122 @@
+#include "simulation.h"
+#include "profiler.h"
+#include <cstring>
+
+Simulation::Simulation()
+    : track(std::make_unique<Track>())
+    , tick(0)
+    , jobs(&JobSystem::shared())
+{
+}
+
+bool Simulation::loadTrack(const std::string& filename) {
+    return track->load(filename);
+}
+
+void Simulation::spawnCars(int botCount, int difficulty) {
+    bots.clear();
+    cars.clear();
+    cars.reserve(botCount + 1);
+    
+    auto startPos = track->getStartPosition(0);
+    playerCar = cars.add(startPos.x, startPos.y, 0, 255, 0);
+    
+    for (int i = 1; i <= botCount; ++i) {
+        auto botStartPos = track->getStartPosition(i);
+        bots.push_back(std::make_unique<AIBot>(cars, botStartPos.x, botStartPos.y, difficulty));
+    }
+    collisions.assign(cars.size(), CollisionResult());
+    tick = 0;
+}
+
+void Simulation::spawnBots(const std::vector<int>& difficulties) {
+    bots.clear();
+    cars.clear();
+    playerCar.reset();
+    cars.reserve(difficulties.size());
+    
+    for (size_t i = 0; i < difficulties.size(); ++i) {
+        auto startPos = track->getStartPosition(static_cast<int>(i));
+        bots.push_back(std::make_unique<AIBot>(cars, startPos.x, startPos.y, difficulties[i]));
+    }
+    collisions.assign(cars.size(), CollisionResult());
+    tick = 0;
+}
+
+void Simulation::step(const Input& playerInput) {
+    PROFILE_ZONE("Simulation::step");
+    cars.beginTick();
+    
+    if (playerCar) {
+        playerCar->setInput(playerInput);
+    }
+    
+    {
+        PROFILE_ZONE("bots");
+        // Bots share the track's flow field; any rebuild happens here,
+        // and the parallel steering jobs only read it
+        const FlowField& field = track->getFlowField();
+        forEachBot([&field](AIBot& bot) {
+            bot.steer(field);
+        });
+    }
+    {
+        PROFILE_ZONE("integrate");
+        cars.integrate(TICK_SECONDS);
+    }
+    {
+        PROFILE_ZONE("car collisions");
+        // Car-vs-car first, so the walls get the final say on position
+        carCollisions.resolve(cars);
+    }
+    {
+        PROFILE_ZONE("wall collisions");
+        if (playerCar) {
+            collisions[playerCar->getIndex()] = track->checkCollisions(*playerCar, TICK_SECONDS);
+        }
+        forEachBot([this](AIBot& bot) {
+            collisions[bot.getCar().getIndex()] = track->checkCollisions(bot.getCar(), TICK_SECONDS);
+        });
+    }
+    
+    ++tick;
+}
+
+template <typename Fn>
+void Simulation::forEachBot(Fn&& fn) {
+    if (bots.size() < PARALLEL_MIN_BOTS) {
+        for (auto& bot : bots) {
+            fn(*bot);
+        }
+        return;
+    }
+    
+    jobs->parallelFor(bots.size(), BOTS_PER_JOB, [this, &fn](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            fn(*bots[i]);
+        }
+    });
+}
+
+uint64_t Simulation::stateHash() const {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    auto mixCar = [&mix](const Car& car) {
+        float state[5] = { car.getX(), car.getY(), car.getVelocityX(), car.getVelocityY(), car.getAngle() };
+        mix(state, sizeof(state));
+    };
+    
+    mix(&tick, sizeof(tick));
+    if (playerCar) {
+        mixCar(*playerCar);
+    }
+    for (const auto& bot : bots) {
+        mixCar(bot->getCar());
+    }
+    return hash;
+}
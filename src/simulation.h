@@ -0,0 +1,86 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "track.h"
+#include "car.h"
+#include "car_pool.h"
+#include "car_collisions.h"
+#include "ai_bot.h"
+#include "job_system.h"
+#include "input.h"
+
+// Race state advanced in fixed ticks: the track, the player car and the AI
+// bots, whose cars all live in one CarPool and are integrated as a batch,
+// then pushed apart where they overlap. Has no SDL or rendering dependency,
+// so the same track and the same per-tick inputs always produce
+// bit-identical state on a given build.
+//
+// Bot steering and per-car wall checks each touch only one car, so large
+// fields fan them out over a JobSystem; the result matches a serial step.
+class Simulation {
+public:
+    static constexpr int TICK_RATE = 120;
+    static constexpr float TICK_SECONDS = 1.0f / TICK_RATE;
+    
+    // Below this many bots a tick is cheaper than waking the workers
+    static constexpr size_t PARALLEL_MIN_BOTS = 128;
+    static constexpr size_t BOTS_PER_JOB = 64;
+    
+    Simulation();
+    
+    // Cars and bots hold references into the pool
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+    
+    bool loadTrack(const std::string& filename);
+    void spawnCars(int botCount, int difficulty);
+    
+    // A race of bots alone, one per entry with its own difficulty; step()
+    // then ignores the player input
+    void spawnBots(const std::vector<int>& difficulties);
+    bool hasPlayer() const { return playerCar.has_value(); }
+    
+    // Advances the race by one TICK_SECONDS step
+    void step(const Input& playerInput);
+    
+    uint64_t getTick() const { return tick; }
+    
+    // Wall and off-track results of the last step, by car pool index
+    const std::vector<CollisionResult>& getCollisions() const { return collisions; }
+    
+    // Defaults to JobSystem::shared(); the system must outlive the simulation
+    void setJobSystem(JobSystem& system) { jobs = &system; }
+    
+    // FNV-1a over the exact bits of every car's state, for replay and
+    // determinism checks
+    uint64_t stateHash() const;
+    
+    Track& getTrack() { return *track; }
+    const Track& getTrack() const { return *track; }
+    Car& getPlayerCar() { return *playerCar; }
+    const Car& getPlayerCar() const { return *playerCar; }
+    std::vector<std::unique_ptr<AIBot>>& getBots() { return bots; }
+    const std::vector<std::unique_ptr<AIBot>>& getBots() const { return bots; }
+    CarPool& getCars() { return cars; }
+    const CarPool& getCars() const { return cars; }
+    
+private:
+    std::unique_ptr<Track> track;
+    CarPool cars;
+    CarCollisions carCollisions;
+    std::optional<Car> playerCar;
+    std::vector<std::unique_ptr<AIBot>> bots;
+    std::vector<CollisionResult> collisions;
+    uint64_t tick;
+    JobSystem* jobs;
+    
+    template <typename Fn>
+    void forEachBot(Fn&& fn);
+};
+
+#endif // SIMULATION_H
@@ -0,0 +1,191 @@
+#include "spatial_grid.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+SpatialGrid::SpatialGrid()
+    : originX(0), originY(0)
+    , cellSize(1.0f)
+    , columns(0), rows(0)
+    , cellStart(1, 0)
+    , pendingCount(0)
+{
+}
+
+void SpatialGrid::build(const std::vector<Tile>& tiles) {
+    double extentSum = 0;
+    for (const auto& tile : tiles) {
+        extentSum += std::max(tile.width, tile.height);
+    }
+    
+    // Cells roughly the size of an average tile, so most tiles touch at most
+    // four cells. Sparse layouts get coarser cells to bound memory.
+    float averageExtent = tiles.empty() ? 1.0f : static_cast<float>(extentSum / tiles.size());
+    build(tiles, averageExtent, 4 * tiles.size() + 64);
+}
+
+void SpatialGrid::build(const std::vector<Tile>& tiles, float size, size_t maxCells) {
+    pendingCells.clear();
+    pendingCount = 0;
+    cellItems.clear();
+    cellStart.assign(1, 0);
+    columns = 0;
+    rows = 0;
+
+    if (tiles.empty()) {
+        return;
+    }
+
+    float minX, minY, maxX, maxY;
+    tileBounds(tiles[0], minX, minY, maxX, maxY);
+
+    for (const auto& tile : tiles) {
+        float tileMinX, tileMinY, tileMaxX, tileMaxY;
+        tileBounds(tile, tileMinX, tileMinY, tileMaxX, tileMaxY);
+        minX = std::min(minX, tileMinX);
+        minY = std::min(minY, tileMinY);
+        maxX = std::max(maxX, tileMaxX);
+        maxY = std::max(maxY, tileMaxY);
+    }
+
+    cellSize = std::max(1.0f, size);
+    originX = minX;
+    originY = minY;
+
+    for (;;) {
+        double cols = std::floor((static_cast<double>(maxX) - minX) / cellSize) + 1;
+        double rws = std::floor((static_cast<double>(maxY) - minY) / cellSize) + 1;
+        // Non-finite bounds never fit; leave the grid empty
+        if (!std::isfinite(cols * rws)) {
+            clear();
+            return;
+        }
+        if (cols * rws <= maxCells) {
+            columns = static_cast<int>(cols);
+            rows = static_cast<int>(rws);
+            break;
+        }
+        cellSize *= static_cast<float>(std::max(1.1, std::sqrt(cols * rws / maxCells)));
+    }
+
+    // Counting sort of (cell, tile) pairs into a compact layout
+    const size_t cellCount = static_cast<size_t>(columns) * rows;
+    cellStart.assign(cellCount + 1, 0);
+
+    int x0, y0, x1, y1;
+    for (const auto& tile : tiles) {
+        cellRange(tile, x0, y0, x1, y1);
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                ++cellStart[cy * columns + cx + 1];
+            }
+        }
+    }
+
+    for (size_t i = 0; i < cellCount; ++i) {
+        cellStart[i + 1] += cellStart[i];
+    }
+
+    cellItems.resize(cellStart[cellCount]);
+    std::vector<uint32_t> fill(cellStart.begin(), cellStart.end() - 1);
+
+    for (uint32_t index = 0; index < tiles.size(); ++index) {
+        cellRange(tiles[index], x0, y0, x1, y1);
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                cellItems[fill[cy * columns + cx]++] = index;
+            }
+        }
+    }
+}
+
+void SpatialGrid::insert(const std::vector<Tile>& tiles, uint32_t index) {
+    const Tile& tile = tiles[index];
+    
+    if (columns == 0 && pendingCount == 0) {
+        // First tile of an empty grid picks the cell size
+        float ignoredX, ignoredY;
+        tileBounds(tile, originX, originY, ignoredX, ignoredY);
+        cellSize = std::max(1.0f, std::max(tile.width, tile.height));
+    }
+    
+    if (pendingCount >= std::max<size_t>(256, tiles.size() / 2)) {
+        build(tiles);
+        return;
+    }
+    
+    // Same arithmetic as visitPoint(), so a point strictly inside the tile
+    // always hashes to one of the cells it was added to
+    float minX, minY, maxX, maxY;
+    tileBounds(tile, minX, minY, maxX, maxY);
+    int x0 = cellCoord((minX - originX) / cellSize);
+    int y0 = cellCoord((minY - originY) / cellSize);
+    int x1 = cellCoord((maxX - originX) / cellSize);
+    int y1 = cellCoord((maxY - originY) / cellSize);
+    
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            pendingCells[cellKey(cx, cy)].push_back(index);
+        }
+    }
+    ++pendingCount;
+}
+
+bool SpatialGrid::assign(float newOriginX, float newOriginY, float newCellSize,
+                         int newColumns, int newRows,
+                         std::vector<uint32_t> newCellStart, std::vector<uint32_t> newCellItems,
+                         size_t tileCount) {
+    if (!(newCellSize > 0.0f) || !std::isfinite(newCellSize) || !std::isfinite(newOriginX) ||
+        !std::isfinite(newOriginY) || newColumns < 0 || newRows < 0 ||
+        newCellStart.size() != static_cast<size_t>(newColumns) * newRows + 1 ||
+        newCellStart.front() != 0 || newCellStart.back() != newCellItems.size()) {
+        return false;
+    }
+    
+    for (size_t i = 1; i < newCellStart.size(); ++i) {
+        if (newCellStart[i] < newCellStart[i - 1]) {
+            return false;
+        }
+    }
+    for (uint32_t index : newCellItems) {
+        if (index >= tileCount) {
+            return false;
+        }
+    }
+    
+    originX = newOriginX;
+    originY = newOriginY;
+    cellSize = newCellSize;
+    columns = newColumns;
+    rows = newRows;
+    cellStart = std::move(newCellStart);
+    cellItems = std::move(newCellItems);
+    pendingCells.clear();
+    pendingCount = 0;
+    return true;
+}
+
+void SpatialGrid::clear() {
+    pendingCells.clear();
+    pendingCount = 0;
+    cellItems.clear();
+    cellStart.assign(1, 0);
+    columns = 0;
+    rows = 0;
+}
+
+void SpatialGrid::cellRange(const Tile& tile, int& x0, int& y0, int& x1, int& y1) const {
+    // Same arithmetic as visitPoint(), so a point strictly inside a tile
+    // always maps to a cell the tile was registered in
+    float minX, minY, maxX, maxY;
+    tileBounds(tile, minX, minY, maxX, maxY);
+    float fx0 = (minX - originX) / cellSize;
+    float fy0 = (minY - originY) / cellSize;
+    float fx1 = (maxX - originX) / cellSize;
+    float fy1 = (maxY - originY) / cellSize;
+
+    x0 = std::clamp(static_cast<int>(fx0), 0, columns - 1);
+    y0 = std::clamp(static_cast<int>(fy0), 0, rows - 1);
+    x1 = std::clamp(static_cast<int>(fx1), 0, columns - 1);
+    y1 = std::clamp(static_cast<int>(fy1), 0, rows - 1);
+}
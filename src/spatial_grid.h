@@ -0,0 +1,145 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "tile.h"
+
+// Uniform grid over tile bounds, rotation included (tileBounds()). Each
+// cell lists the indices of every tile whose bounds touch it, stored
+// contiguously (cellStart/cellItems), so a point query only looks at the
+// handful of tiles near that point.
+//
+// Tiles added after the last build() go to a hashed overflow grid with the
+// same cell size; the compact grid is rebuilt once the overflow holds about
+// as many tiles as it does, which keeps addTile() amortised O(1).
+class SpatialGrid {
+public:
+    SpatialGrid();
+
+    void build(const std::vector<Tile>& tiles);
+    
+    // Same with cells of a given size, coarsened only if there would be
+    // more than maxCells of them
+    void build(const std::vector<Tile>& tiles, float cellSize, size_t maxCells);
+    void insert(const std::vector<Tile>& tiles, uint32_t index);
+    void clear();
+
+    // Adopts a layout produced by an earlier build(), e.g. read back from a
+    // compiled track. Returns false if it is inconsistent with tileCount.
+    bool assign(float originX, float originY, float cellSize, int columns, int rows,
+                std::vector<uint32_t> cellStart, std::vector<uint32_t> cellItems,
+                size_t tileCount);
+
+    // Calls visit(index) for every tile whose bounds may contain (x, y).
+    // Stops early and returns true as soon as visit returns true.
+    template <typename Visitor>
+    bool visitPoint(float x, float y, Visitor&& visit) const {
+        float fx = (x - originX) / cellSize;
+        float fy = (y - originY) / cellSize;
+        
+        // Written so that NaN coordinates fall outside the grid
+        if (fx >= 0.0f && fx < columns && fy >= 0.0f && fy < rows) {
+            int cell = static_cast<int>(fy) * columns + static_cast<int>(fx);
+            for (uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+                if (visit(cellItems[i])) {
+                    return true;
+                }
+            }
+        }
+        
+        if (pendingCount > 0 && fx == fx && fy == fy) {
+            auto it = pendingCells.find(cellKey(cellCoord(fx), cellCoord(fy)));
+            if (it != pendingCells.end()) {
+                for (uint32_t index : it->second) {
+                    if (visit(index)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    // Calls visit(index) for every tile whose bounds may overlap the
+    // rectangle; tiles spanning several cells are visited once per cell
+    template <typename Visitor>
+    void visitRect(float minX, float minY, float maxX, float maxY, Visitor&& visit) const {
+        int x0 = cellCoord((minX - originX) / cellSize);
+        int y0 = cellCoord((minY - originY) / cellSize);
+        int x1 = cellCoord((maxX - originX) / cellSize);
+        int y1 = cellCoord((maxY - originY) / cellSize);
+
+        if (x1 >= 0 && x0 < columns && y1 >= 0 && y0 < rows) {
+            for (int cy = std::max(y0, 0); cy <= std::min(y1, rows - 1); ++cy) {
+                for (int cx = std::max(x0, 0); cx <= std::min(x1, columns - 1); ++cx) {
+                    int cell = cy * columns + cx;
+                    for (uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+                        visit(cellItems[i]);
+                    }
+                }
+            }
+        }
+
+        if (pendingCount == 0) {
+            return;
+        }
+        // Walk whichever is smaller, the cells in range or the overflow
+        double area = (static_cast<double>(x1) - x0 + 1) * (static_cast<double>(y1) - y0 + 1);
+        if (area > pendingCells.size()) {
+            for (const auto& entry : pendingCells) {
+                int cx = static_cast<int32_t>(entry.first >> 32);
+                int cy = static_cast<int32_t>(entry.first & 0xffffffffu);
+                if (cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1) {
+                    for (uint32_t index : entry.second) {
+                        visit(index);
+                    }
+                }
+            }
+            return;
+        }
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                auto it = pendingCells.find(cellKey(cx, cy));
+                if (it != pendingCells.end()) {
+                    for (uint32_t index : it->second) {
+                        visit(index);
+                    }
+                }
+            }
+        }
+    }
+
+    float getOriginX() const { return originX; }
+    float getOriginY() const { return originY; }
+    float getCellSize() const { return cellSize; }
+    int getColumns() const { return columns; }
+    int getRows() const { return rows; }
+    const std::vector<uint32_t>& getCellStart() const { return cellStart; }
+    const std::vector<uint32_t>& getCellItems() const { return cellItems; }
+
+private:
+    float originX, originY;
+    float cellSize;
+    int columns, rows;
+
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> cellItems;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> pendingCells;
+    size_t pendingCount;
+    
+    static int cellCoord(float f) {
+        return static_cast<int>(std::floor(std::max(-1.0e9f, std::min(f, 1.0e9f))));
+    }
+    
+    static uint64_t cellKey(int cx, int cy) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    }
+    
+    void cellRange(const Tile& tile, int& x0, int& y0, int& x1, int& y1) const;
+};
+
+#endif // SPATIAL_GRID_H
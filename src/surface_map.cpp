@@ -0,0 +1,283 @@
+#include "surface_map.h"
+#include "spatial_grid.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+// Coverage bits per cell while building: one per TileType, plus one for
+// the drivable area
+constexpr uint8_t DRIVABLE_BIT = 1u << 6;
+
+constexpr uint8_t bit(TileType type) {
+    return static_cast<uint8_t>(1u << static_cast<int>(type));
+}
+
+// full: covered all over by a tile; touched: overlapped at all
+uint8_t resolve(uint8_t full, uint8_t touched) {
+    static const TileType drivablePrecedence[] = {
+        TileType::JUMP, TileType::CHECKPOINT, TileType::START_FINISH, TileType::TRACK
+    };
+
+    if (full & DRIVABLE_BIT) {
+        for (TileType type : drivablePrecedence) {
+            if (full & bit(type)) {
+                return static_cast<uint8_t>(type);
+            }
+            if (touched & bit(type)) {
+                return SurfaceMap::MIXED;
+            }
+        }
+        // Drivable only where merged tiles close the seams between them
+        return static_cast<uint8_t>(TileType::TRACK);
+    }
+    if (touched & DRIVABLE_BIT) {
+        return SurfaceMap::MIXED;
+    }
+    if (full & bit(TileType::WALL)) {
+        return static_cast<uint8_t>(TileType::WALL);
+    }
+    if (touched & bit(TileType::WALL)) {
+        return SurfaceMap::MIXED;
+    }
+    return static_cast<uint8_t>(TileType::GRASS);
+}
+
+} // namespace
+
+SurfaceMap::SurfaceMap()
+    : originX(0), originY(0)
+    , cellSize(DEFAULT_CELL_SIZE), inverseCellSize(1.0f / DEFAULT_CELL_SIZE)
+    , columns(0), rows(0)
+    , outside(MIXED)
+    , mixedCells(0)
+    , visitedBlocks(0)
+    , slotMask(0)
+    , slotShift(64)
+{
+}
+
+void SurfaceMap::clear() {
+    columns = 0;
+    rows = 0;
+    outside = MIXED;
+    mixedCells = 0;
+    visitedBlocks = 0;
+    blocks.clear();
+    slotMask = 0;
+    slotShift = 64;
+    cells.clear();
+}
+
+void SurfaceMap::build(const std::vector<Tile>& tiles, const SpatialGrid& tileGrid,
+                       const std::vector<Tile>& drivable, const SpatialGrid& drivableGrid, float size) {
+    clear();
+    if (tiles.empty() || !(size > 0.0f)) {
+        return;
+    }
+
+    float minX, minY, maxX, maxY;
+    tileBounds(tiles[0], minX, minY, maxX, maxY);
+    for (const std::vector<Tile>* list : { &tiles, &drivable }) {
+        for (const Tile& tile : *list) {
+            float tileMinX, tileMinY, tileMaxX, tileMaxY;
+            tileBounds(tile, tileMinX, tileMinY, tileMaxX, tileMaxY);
+            minX = std::min(minX, tileMinX);
+            minY = std::min(minY, tileMinY);
+            maxX = std::max(maxX, tileMaxX);
+            maxY = std::max(maxY, tileMaxY);
+        }
+    }
+
+    // Sized in double so huge or non-finite bounds are caught, not wrapped
+    const double columnCount = std::ceil((static_cast<double>(maxX) - minX) / size) + 1;
+    const double rowCount = std::ceil((static_cast<double>(maxY) - minY) / size) + 1;
+    if (!(columnCount <= MAX_AXIS_CELLS && rowCount <= MAX_AXIS_CELLS)) {
+        return;
+    }
+
+    // A cell only counts as covered or clear with this much to spare, so
+    // rounding in lookup() can never put a point in the wrong kind of cell
+    const float extent = std::max({ std::fabs(minX), std::fabs(minY), std::fabs(maxX), std::fabs(maxY) });
+    const float margin = size * 1e-3f + extent * 4.0f * FLT_EPSILON;
+    const int blockColumns = (static_cast<int>(columnCount) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const int blockRows = (static_cast<int>(rowCount) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const double blockSize = static_cast<double>(size) * BLOCK_SIZE;
+
+    // The blocks each tile's bounds reach, grown by a cell so rounding in
+    // the rasterising below cannot stray past them. Grass is left out: it
+    // reads the same as no tile at all. Sorted and deduplicated whenever
+    // the list outgrows the budget, to keep it bounded.
+    std::vector<uint64_t> reached;
+    auto compact = [&reached] {
+        std::sort(reached.begin(), reached.end());
+        reached.erase(std::unique(reached.begin(), reached.end()), reached.end());
+    };
+    const double pad = static_cast<double>(margin) + size;
+    auto addReached = [&](const Tile& tile) {
+        float tileMinX, tileMinY, tileMaxX, tileMaxY;
+        tileBounds(tile, tileMinX, tileMinY, tileMaxX, tileMaxY);
+        // A NaN tile covers nothing
+        if (!(tileMinX <= tileMaxX && tileMinY <= tileMaxY)) {
+            return true;
+        }
+        int bx0 = std::max(0, static_cast<int>(std::floor((tileMinX - pad - minX) / blockSize)));
+        int by0 = std::max(0, static_cast<int>(std::floor((tileMinY - pad - minY) / blockSize)));
+        int bx1 = std::min(blockColumns - 1, static_cast<int>(std::floor((tileMaxX + pad - minX) / blockSize)));
+        int by1 = std::min(blockRows - 1, static_cast<int>(std::floor((tileMaxY + pad - minY) / blockSize)));
+        if (static_cast<double>(bx1 - bx0 + 1) * (by1 - by0 + 1) > MAX_BLOCKS) {
+            return false;
+        }
+        for (int by = by0; by <= by1; ++by) {
+            for (int bx = bx0; bx <= bx1; ++bx) {
+                reached.push_back(blockKey(bx, by));
+            }
+        }
+        if (reached.size() > 4 * MAX_BLOCKS) {
+            compact();
+        }
+        return reached.size() <= MAX_BLOCKS || (compact(), reached.size() <= MAX_BLOCKS);
+    };
+    for (const Tile& tile : tiles) {
+        if (tile.type != TileType::GRASS && !addReached(tile)) {
+            return;
+        }
+    }
+    for (const Tile& tile : drivable) {
+        if (!addReached(tile)) {
+            return;
+        }
+    }
+    compact();
+
+    cellSize = size;
+    inverseCellSize = 1.0f / size;
+    originX = minX;
+    originY = minY;
+    columns = static_cast<int>(columnCount);
+    rows = static_cast<int>(rowCount);
+    outside = static_cast<uint8_t>(TileType::GRASS);
+    visitedBlocks = reached.size();
+
+    std::vector<uint8_t> full(BLOCK_SIZE * BLOCK_SIZE);
+    std::vector<uint8_t> touched(BLOCK_SIZE * BLOCK_SIZE);
+    std::vector<uint8_t> codes(BLOCK_SIZE * BLOCK_SIZE);
+    std::vector<uint32_t> found;
+    std::vector<Block> kept;
+
+    for (uint64_t key : reached) {
+        const int bx = static_cast<int>(key & 0xffffffffu);
+        const int by = static_cast<int>(key >> 32);
+        const int cellX0 = bx * BLOCK_SIZE;
+        const int cellY0 = by * BLOCK_SIZE;
+        std::fill(full.begin(), full.end(), 0);
+        std::fill(touched.begin(), touched.end(), 0);
+
+        // A rotated tile touches a cell, grown by the margin, unless the
+        // two are apart along one of the tile's axes (they already
+        // overlap along the world's). It covers the cell fully when all
+        // four corners, pushed out by the margin, are inside it pulled
+        // in by the margin: it is convex.
+        auto cover = [&](const Tile& tile, uint8_t mask) {
+            const TileShape shape = shapeOf(tile);
+            int x0 = std::max(cellX0, static_cast<int>(std::floor((shape.minX - margin - originX) * inverseCellSize)));
+            int y0 = std::max(cellY0, static_cast<int>(std::floor((shape.minY - margin - originY) * inverseCellSize)));
+            int x1 = std::min(cellX0 + BLOCK_SIZE - 1,
+                              static_cast<int>(std::floor((shape.maxX + margin - originX) * inverseCellSize)));
+            int y1 = std::min(cellY0 + BLOCK_SIZE - 1,
+                              static_cast<int>(std::floor((shape.maxY + margin - originY) * inverseCellSize)));
+            auto inside = [&](float x, float y) {
+                float localX, localY;
+                shape.toLocal(x, y, localX, localY);
+                return std::fabs(localX) < shape.halfWidth - margin && std::fabs(localY) < shape.halfHeight - margin;
+            };
+            for (int cy = y0; cy <= y1; ++cy) {
+                float top = originY + cy * size;
+                bool fullY = tile.y < top - margin && tile.y + tile.height > top + size + margin;
+                for (int cx = x0; cx <= x1; ++cx) {
+                    float left = originX + cx * size;
+                    bool fullX = tile.x < left - margin && tile.x + tile.width > left + size + margin;
+                    int cell = (cy - cellY0) * BLOCK_SIZE + (cx - cellX0);
+                    if (shape.rotated) {
+                        float localX, localY;
+                        shape.toLocal(left + size / 2, top + size / 2, localX, localY);
+                        float reach = (size / 2 + margin) * (std::fabs(shape.cosA) + std::fabs(shape.sinA));
+                        if (std::fabs(localX) >= shape.halfWidth + reach ||
+                            std::fabs(localY) >= shape.halfHeight + reach) {
+                            continue;
+                        }
+                    }
+                    touched[cell] |= mask;
+                    bool covered = shape.rotated
+                        ? inside(left - margin, top - margin) && inside(left + size + margin, top - margin) &&
+                          inside(left + size + margin, top + size + margin) && inside(left - margin, top + size + margin)
+                        : fullX && fullY;
+                    if (covered) {
+                        full[cell] |= mask;
+                    }
+                }
+            }
+        };
+
+        const float left = originX + cellX0 * size - margin;
+        const float top = originY + cellY0 * size - margin;
+        const float right = left + BLOCK_SIZE * size + 2 * margin;
+        const float bottom = top + BLOCK_SIZE * size + 2 * margin;
+
+        // Grass adds nothing: it reads the same as no tile at all
+        found.clear();
+        tileGrid.visitRect(left, top, right, bottom, [&](uint32_t index) { found.push_back(index); });
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+        for (uint32_t index : found) {
+            if (tiles[index].type != TileType::GRASS) {
+                cover(tiles[index], bit(tiles[index].type));
+            }
+        }
+
+        found.clear();
+        drivableGrid.visitRect(left, top, right, bottom, [&](uint32_t index) { found.push_back(index); });
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+        for (uint32_t index : found) {
+            cover(drivable[index], DRIVABLE_BIT);
+        }
+
+        bool uniform = true;
+        for (size_t i = 0; i < codes.size(); ++i) {
+            codes[i] = resolve(full[i], touched[i]);
+            uniform = uniform && codes[i] == codes[0];
+            mixedCells += codes[i] == MIXED;
+        }
+
+        if (uniform && codes[0] == static_cast<uint8_t>(TileType::GRASS)) {
+            continue;
+        }
+        Block block = { key, 0, codes[0] };
+        if (!uniform) {
+            block.code = STORED;
+            block.offset = static_cast<uint32_t>(cells.size());
+            for (size_t i = 0; i < codes.size(); i += 2) {
+                cells.push_back(static_cast<uint8_t>(codes[i] | codes[i + 1] << 4));
+            }
+        }
+        kept.push_back(block);
+    }
+
+    size_t slots = 2;
+    slotShift = 63;
+    while (slots < 4 * kept.size()) {
+        slots *= 2;
+        --slotShift;
+    }
+    slotMask = slots - 1;
+    blocks.assign(slots, Block{ NO_BLOCK, 0, 0 });
+    for (const Block& block : kept) {
+        size_t slot = slotOf(block.key);
+        while (blocks[slot].key != NO_BLOCK) {
+            slot = (slot + 1) & slotMask;
+        }
+        blocks[slot] = block;
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef SURFACE_MAP_H
+#define SURFACE_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "tile.h"
+
+class SpatialGrid;
+
+// Fixed-resolution raster of the surface under a track, so the common
+// surface questions are one array read instead of a tile search.
+//
+// The surface at a point is the drivable type over it, if any (JUMP before
+// CHECKPOINT, START_FINISH and TRACK), else WALL if a wall is over it, else
+// GRASS, which also covers points off every tile. Each cell holds that
+// surface as a 4-bit code when it is the same everywhere in the cell, or
+// MIXED when a tile edge crosses it and the caller has to test the tiles.
+//
+// Cells are grouped into BLOCK_SIZE x BLOCK_SIZE blocks, and only the
+// blocks some tile's bounds reach are visited. Those that turn out to be
+// anything but plain grass go in a hash table keyed by block position;
+// every other block reads GRASS. A block that is the same all over (the
+// middle of a wide road) is stored as that one code, so memory follows
+// the length of tile edges, not the area of the world.
+//
+// A world more than MAX_AXIS_CELLS cells across, or whose tiles reach more
+// than MAX_BLOCKS blocks, leaves the map empty and callers test the tiles.
+class SurfaceMap {
+public:
+    static constexpr float DEFAULT_CELL_SIZE = 25.0f;
+    static constexpr int BLOCK_BITS = 6;
+    static constexpr int BLOCK_SIZE = 1 << BLOCK_BITS;
+    static constexpr uint8_t MIXED = 0x0f;
+    static constexpr double MAX_AXIS_CELLS = 1 << 30;
+    static constexpr size_t MAX_BLOCKS = 1 << 16;
+
+    SurfaceMap();
+
+    // tiles give each type's coverage (any layout, e.g. Track's draw
+    // tiles); drivable decides drivability and must cover exactly the area
+    // the caller's exact on-track test does. Each comes with a SpatialGrid
+    // built over it.
+    void build(const std::vector<Tile>& tiles, const SpatialGrid& tileGrid,
+               const std::vector<Tile>& drivable, const SpatialGrid& drivableGrid, float cellSize);
+    void clear();
+    bool empty() const { return columns == 0; }
+
+    // Surface code of the cell holding (x, y): a TileType, or MIXED. Every
+    // point reads MIXED while the map is empty.
+    uint8_t lookup(float x, float y) const {
+        float fx = (x - originX) * inverseCellSize;
+        float fy = (y - originY) * inverseCellSize;
+        // Written so that NaN coordinates fall outside the map
+        if (!(fx >= 0.0f && fx < columns && fy >= 0.0f && fy < rows)) {
+            return outside;
+        }
+        int cx = static_cast<int>(fx);
+        int cy = static_cast<int>(fy);
+        const uint64_t key = blockKey(cx >> BLOCK_BITS, cy >> BLOCK_BITS);
+        for (size_t slot = slotOf(key); ; slot = (slot + 1) & slotMask) {
+            const Block& block = blocks[slot];
+            if (block.key == NO_BLOCK) {
+                return static_cast<uint8_t>(TileType::GRASS);
+            }
+            if (block.key != key) {
+                continue;
+            }
+            if (block.code != STORED) {
+                return block.code;
+            }
+            int cell = ((cy & (BLOCK_SIZE - 1)) << BLOCK_BITS) | (cx & (BLOCK_SIZE - 1));
+            uint8_t pair = cells[block.offset + (cell >> 1)];
+            return (cell & 1) ? pair >> 4 : pair & 0x0f;
+        }
+    }
+
+    float getCellSize() const { return cellSize; }
+    // Blocks some tile reaches, kept or not
+    size_t getBlockCount() const { return visitedBlocks; }
+    size_t getStoredBlockCount() const { return cells.size() / BLOCK_BYTES; }
+    size_t getMixedCellCount() const { return mixedCells; }
+    size_t getMemoryBytes() const { return blocks.size() * sizeof(Block) + cells.size(); }
+
+private:
+    static constexpr uint8_t STORED = 0xff;
+    static constexpr size_t BLOCK_BYTES = BLOCK_SIZE * BLOCK_SIZE / 2;
+    static constexpr uint64_t NO_BLOCK = ~0ull;
+
+    struct Block {
+        uint64_t key;    // blockKey(), or NO_BLOCK for a free slot
+        uint32_t offset; // Into cells, when code is STORED
+        uint8_t code;    // Surface of the whole block, or STORED
+    };
+
+    static uint64_t blockKey(int blockX, int blockY) {
+        return static_cast<uint64_t>(blockY) << 32 | static_cast<uint32_t>(blockX);
+    }
+    size_t slotOf(uint64_t key) const {
+        return static_cast<size_t>((key * 0x9e3779b97f4a7c15ull) >> slotShift);
+    }
+
+    float originX, originY;
+    float cellSize, inverseCellSize;
+    int columns, rows;
+    uint8_t outside;
+    size_t mixedCells;
+    size_t visitedBlocks;
+
+    // Open addressing with linear probing, at most a quarter full
+    std::vector<Block> blocks;
+    size_t slotMask;
+    int slotShift;
+    std::vector<uint8_t> cells; // Two 4-bit codes per byte, BLOCK_BYTES per stored block
+};
+
+#endif // SURFACE_MAP_H
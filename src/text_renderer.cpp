@@ -0,0 +1,247 @@
+#include "text_renderer.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+namespace {
+
+// Tried in order after an explicit path
+const char* const FONT_CANDIDATES[] = {
+    "assets/fonts/font.ttf",
+    "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+    "/usr/share/fonts/TTF/DejaVuSans.ttf",
+    "/usr/share/fonts/dejavu/DejaVuSans.ttf",
+    "/System/Library/Fonts/Supplemental/Arial.ttf",
+    "C:/Windows/Fonts/arial.ttf",
+};
+
+} // namespace
+
+TextRenderer::TextRenderer(SDL_Renderer* renderer)
+    : renderer(renderer)
+    , atlasSurface(nullptr)
+    , atlasTexture(nullptr)
+    , shelfX(0), shelfY(0), shelfHeight(0)
+    , atlasFull(false)
+{
+}
+
+TextRenderer::~TextRenderer() {
+    if (atlasTexture) {
+        SDL_DestroyTexture(atlasTexture);
+    }
+    if (atlasSurface) {
+        SDL_DestroySurface(atlasSurface);
+    }
+    if (isReady()) {
+        TTF_Quit();
+    }
+}
+
+bool TextRenderer::loadFont(const std::string& path) {
+    if (!renderer || isReady()) {
+        return isReady();
+    }
+
+    std::vector<std::string> candidates;
+    if (!path.empty()) {
+        candidates.push_back(path);
+    }
+    candidates.insert(candidates.end(), std::begin(FONT_CANDIDATES), std::end(FONT_CANDIDATES));
+
+    std::string found;
+    std::error_code error;
+    for (const auto& candidate : candidates) {
+        if (std::filesystem::is_regular_file(candidate, error)) {
+            found = candidate;
+            break;
+        }
+    }
+    if (found.empty()) {
+        SDL_Log("No font found, text is drawn as placeholder boxes");
+        return false;
+    }
+
+    if (!TTF_Init()) {
+        SDL_Log("SDL_ttf initialization failed: %s", SDL_GetError());
+        return false;
+    }
+
+    atlasSurface = SDL_CreateSurface(ATLAS_SIZE, ATLAS_SIZE, SDL_PIXELFORMAT_ARGB8888);
+    atlasTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+                                     ATLAS_SIZE, ATLAS_SIZE);
+    if (!atlasSurface || !atlasTexture) {
+        SDL_Log("Glyph atlas creation failed: %s", SDL_GetError());
+        TTF_Quit();
+        return false;
+    }
+    SDL_FillSurfaceRect(atlasSurface, nullptr, 0);
+    SDL_SetTextureBlendMode(atlasTexture, SDL_BLENDMODE_BLEND);
+
+    fontPath = found;
+    return true;
+}
+
+const TextRenderer::GlyphSet* TextRenderer::glyphSet(int pixelSize) {
+    auto it = glyphSets.find(pixelSize);
+    if (it != glyphSets.end()) {
+        return &it->second;
+    }
+    if (atlasFull || !addGlyphSet(pixelSize)) {
+        return nullptr;
+    }
+    return &glyphSets[pixelSize];
+}
+
+bool TextRenderer::addGlyphSet(int pixelSize) {
+    TTF_Font* font = TTF_OpenFont(fontPath.c_str(), static_cast<float>(pixelSize));
+    if (!font) {
+        SDL_Log("Opening %s at %d px failed: %s", fontPath.c_str(), pixelSize, SDL_GetError());
+        atlasFull = true; // Don't retry every frame
+        return false;
+    }
+
+    // Packed into a copy of the shelf state, so a set that does not fit
+    // leaves the atlas as it was
+    GlyphSet set;
+    int x = shelfX, y = shelfY, rowHeight = shelfHeight;
+    bool fits = true;
+    const SDL_Color white = { 255, 255, 255, 255 };
+
+    for (int i = 0; i < GlyphSet::COUNT && fits; ++i) {
+        Uint32 ch = static_cast<Uint32>(GlyphSet::FIRST + i);
+        Glyph& glyph = set.glyphs[i];
+        glyph = {};
+
+        int minX, maxX, minY, maxY, advance = 0;
+        if (TTF_GetGlyphMetrics(font, ch, &minX, &maxX, &minY, &maxY, &advance)) {
+            glyph.advance = static_cast<float>(advance);
+        }
+
+        SDL_Surface* rendered = TTF_RenderGlyph_Blended(font, ch, white);
+        if (!rendered) {
+            continue; // Nothing to draw, e.g. the space
+        }
+
+        // One pixel of padding stops neighbours bleeding in when filtered
+        if (x + rendered->w + 1 > ATLAS_SIZE) {
+            x = 0;
+            y += rowHeight + 1;
+            rowHeight = 0;
+        }
+        if (y + rendered->h > ATLAS_SIZE) {
+            fits = false;
+        } else {
+            SDL_Rect dest = { x, y, rendered->w, rendered->h };
+            SDL_SetSurfaceBlendMode(rendered, SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(rendered, nullptr, atlasSurface, &dest);
+
+            glyph.u0 = static_cast<float>(x) / ATLAS_SIZE;
+            glyph.v0 = static_cast<float>(y) / ATLAS_SIZE;
+            glyph.u1 = static_cast<float>(x + rendered->w) / ATLAS_SIZE;
+            glyph.v1 = static_cast<float>(y + rendered->h) / ATLAS_SIZE;
+            glyph.width = static_cast<float>(rendered->w);
+            glyph.height = static_cast<float>(rendered->h);
+
+            x += rendered->w + 1;
+            rowHeight = std::max(rowHeight, rendered->h);
+        }
+        SDL_DestroySurface(rendered);
+    }
+    TTF_CloseFont(font);
+
+    if (!fits) {
+        SDL_Log("Glyph atlas full, %d px text is drawn as placeholder boxes", pixelSize);
+        atlasFull = true;
+        return false;
+    }
+
+    shelfX = x;
+    shelfY = y;
+    shelfHeight = rowHeight;
+    glyphSets[pixelSize] = set;
+
+    // Rare (once per size), so the whole atlas is simply uploaded again
+    SDL_UpdateTexture(atlasTexture, nullptr, atlasSurface->pixels, atlasSurface->pitch);
+    return true;
+}
+
+const std::vector<TextRenderer::GlyphQuad>* TextRenderer::layout(const std::string& text, int pixelSize) {
+    layoutKey.assign(reinterpret_cast<const char*>(&pixelSize), sizeof(pixelSize));
+    layoutKey += text;
+    auto it = layouts.find(layoutKey);
+    if (it != layouts.end()) {
+        return &it->second;
+    }
+
+    const GlyphSet* set = glyphSet(pixelSize);
+    if (!set) {
+        return nullptr;
+    }
+
+    std::vector<GlyphQuad> quads;
+    quads.reserve(text.size());
+    float penX = 0.0f;
+    for (unsigned char c : text) {
+        int i = c - GlyphSet::FIRST;
+        if (i < 0 || i >= GlyphSet::COUNT) {
+            i = '?' - GlyphSet::FIRST;
+        }
+        const Glyph& glyph = set->glyphs[i];
+        if (glyph.width > 0.0f) {
+            quads.push_back({ penX, 0.0f, glyph.width, glyph.height, glyph.u0, glyph.v0, glyph.u1, glyph.v1 });
+        }
+        penX += glyph.advance;
+    }
+
+    // Labels mostly repeat; anything else is dropped wholesale when full
+    if (layouts.size() >= MAX_CACHED_STRINGS) {
+        layouts.clear();
+    }
+    return &(layouts[layoutKey] = std::move(quads));
+}
+
+bool TextRenderer::queueText(const std::string& text, float x, float y, SDL_FColor color, float scale) {
+    if (!isReady()) {
+        return false;
+    }
+
+    int pixelSize = std::max(1, static_cast<int>(std::lround(BASE_SIZE * scale)));
+    const std::vector<GlyphQuad>* quads = layout(text, pixelSize);
+    if (!quads) {
+        return false;
+    }
+
+    for (const GlyphQuad& quad : *quads) {
+        // Whole pixels keep the glyphs sharp
+        float left = std::round(x + quad.x);
+        float top = std::round(y + quad.y);
+        float right = left + quad.width;
+        float bottom = top + quad.height;
+
+        int base = static_cast<int>(vertices.size());
+        vertices.push_back({ { left, top }, color, { quad.u0, quad.v0 } });
+        vertices.push_back({ { right, top }, color, { quad.u1, quad.v0 } });
+        vertices.push_back({ { right, bottom }, color, { quad.u1, quad.v1 } });
+        vertices.push_back({ { left, bottom }, color, { quad.u0, quad.v1 } });
+        indices.push_back(base);
+        indices.push_back(base + 1);
+        indices.push_back(base + 2);
+        indices.push_back(base);
+        indices.push_back(base + 2);
+        indices.push_back(base + 3);
+    }
+    return true;
+}
+
+bool TextRenderer::flushText() {
+    bool drew = false;
+    if (!indices.empty()) {
+        SDL_RenderGeometry(renderer, atlasTexture, vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+        drew = true;
+    }
+    vertices.clear();
+    indices.clear();
+    return drew;
+}
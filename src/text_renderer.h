@@ -0,0 +1,75 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "renderer.h"
+
+// TrueType text through SDL_ttf, drawn from a glyph atlas.
+//
+// The printable ASCII glyphs of each pixel size are rendered once, the
+// first time that size is asked for, and packed in shelves into a single
+// ATLAS_SIZE square texture shared by every size. Laid-out strings are
+// cached, since HUD, menu and editor labels rarely change, and queued
+// quads go out in one SDL_RenderGeometry call per flush().
+//
+// Textures belong to the SDL renderer: destroy this before it.
+class TextRenderer : public TextBackend {
+public:
+    static constexpr float BASE_SIZE = 12.0f; // Pixel size at scale 1
+    static constexpr int ATLAS_SIZE = 1024;
+    static constexpr size_t MAX_CACHED_STRINGS = 256;
+
+    explicit TextRenderer(SDL_Renderer* renderer);
+    ~TextRenderer() override;
+
+    // Opens the first font that exists: the given path, assets/fonts/font.ttf,
+    // then a few common system fonts
+    bool loadFont(const std::string& path = "");
+    bool isReady() const { return !fontPath.empty(); }
+
+    bool queueText(const std::string& text, float x, float y, SDL_FColor color, float scale) override;
+    bool flushText() override;
+
+private:
+    struct Glyph {
+        float u0, v0, u1, v1;
+        float width, height;
+        float advance;
+    };
+
+    struct GlyphSet {
+        static constexpr int FIRST = 32;
+        static constexpr int COUNT = 95; // ' ' to '~'
+        Glyph glyphs[COUNT];
+    };
+
+    struct GlyphQuad {
+        float x, y, width, height;
+        float u0, v0, u1, v1;
+    };
+
+    SDL_Renderer* renderer;
+    std::string fontPath;
+
+    SDL_Surface* atlasSurface;
+    SDL_Texture* atlasTexture;
+    int shelfX, shelfY, shelfHeight;
+    std::unordered_map<int, GlyphSet> glyphSets; // By pixel size
+    bool atlasFull;
+
+    std::unordered_map<std::string, std::vector<GlyphQuad>> layouts;
+    std::string layoutKey; // Reused to look layouts up without allocating
+
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+
+    const GlyphSet* glyphSet(int pixelSize);
+    bool addGlyphSet(int pixelSize);
+    const std::vector<GlyphQuad>* layout(const std::string& text, int pixelSize);
+};
+
+#endif // TEXT_RENDERER_H
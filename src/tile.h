@@ -0,0 +1,131 @@
+#ifndef TILE_H
+#define TILE_H
+
+#include <cfloat>
+#include <cmath>
+
+enum class TileType {
+    GRASS,
+    TRACK,
+    START_FINISH,
+    CHECKPOINT,
+    JUMP,
+    WALL
+};
+
+// Tiles a car can drive on at full grip
+inline bool isDrivable(TileType type) {
+    return type == TileType::TRACK ||
+           type == TileType::START_FINISH ||
+           type == TileType::CHECKPOINT ||
+           type == TileType::JUMP;
+}
+
+struct Point2D {
+    float x, y;
+};
+
+struct Tile {
+    TileType type;
+    float x, y;
+    float width, height;
+    float angle; // Degrees clockwise on screen, about the tile's centre
+};
+
+// Axis-aligned bounds of a tile, rotation included. Exactly the tile's
+// edges when it is not rotated; a hair loose otherwise, so no point the
+// rotated tile contains falls outside them through rounding.
+inline void tileBounds(const Tile& tile, float& minX, float& minY, float& maxX, float& maxY) {
+    if (tile.angle == 0.0f) {
+        minX = tile.x;
+        minY = tile.y;
+        maxX = tile.x + tile.width;
+        maxY = tile.y + tile.height;
+        return;
+    }
+    const float radians = tile.angle * 0.017453292519943295f;
+    const float c = std::fabs(std::cos(radians));
+    const float s = std::fabs(std::sin(radians));
+    const float centerX = tile.x + tile.width / 2;
+    const float centerY = tile.y + tile.height / 2;
+    const float pad = (std::fabs(centerX) + std::fabs(centerY) + tile.width + tile.height) * 4 * FLT_EPSILON;
+    const float extentX = (c * tile.width + s * tile.height) / 2 + pad;
+    const float extentY = (s * tile.width + c * tile.height) / 2 + pad;
+    minX = centerX - extentX;
+    minY = centerY - extentY;
+    maxX = centerX + extentX;
+    maxY = centerY + extentY;
+}
+
+// A tile's geometry worked out once, for the per-query tests. Unrotated
+// tiles are tested against their edges exactly as before; rotated ones in
+// their own frame, from the centre and half-extents.
+struct TileShape {
+    float minX, minY, maxX, maxY; // tileBounds()
+    float centerX, centerY;
+    float halfWidth, halfHeight;
+    float cosA, sinA;
+    bool rotated;
+
+    // Strictly inside, so points on an edge are outside
+    bool contains(float x, float y) const {
+        if (!rotated) {
+            return x > minX && x < maxX && y > minY && y < maxY;
+        }
+        float localX, localY;
+        toLocal(x, y, localX, localY);
+        return std::fabs(localX) < halfWidth && std::fabs(localY) < halfHeight;
+    }
+
+    // World point to offsets from the centre along the tile's own axes
+    void toLocal(float x, float y, float& localX, float& localY) const {
+        float dx = x - centerX;
+        float dy = y - centerY;
+        localX = dx * cosA + dy * sinA;
+        localY = dy * cosA - dx * sinA;
+    }
+
+    void toWorld(float localX, float localY, float& x, float& y) const {
+        x = centerX + localX * cosA - localY * sinA;
+        y = centerY + localX * sinA + localY * cosA;
+    }
+
+    // Corners in drawing order: top-left, top-right, bottom-right,
+    // bottom-left as the tile sits before it is turned
+    void corners(Point2D out[4]) const {
+        const float signX[] = { -1.0f, 1.0f, 1.0f, -1.0f };
+        const float signY[] = { -1.0f, -1.0f, 1.0f, 1.0f };
+        for (int i = 0; i < 4; ++i) {
+            if (rotated) {
+                toWorld(signX[i] * halfWidth, signY[i] * halfHeight, out[i].x, out[i].y);
+            } else {
+                out[i].x = signX[i] < 0 ? minX : maxX;
+                out[i].y = signY[i] < 0 ? minY : maxY;
+            }
+        }
+    }
+};
+
+inline TileShape shapeOf(const Tile& tile) {
+    TileShape shape;
+    tileBounds(tile, shape.minX, shape.minY, shape.maxX, shape.maxY);
+    shape.centerX = tile.x + tile.width / 2;
+    shape.centerY = tile.y + tile.height / 2;
+    shape.halfWidth = tile.width / 2;
+    shape.halfHeight = tile.height / 2;
+    shape.rotated = tile.angle != 0.0f;
+    const float radians = tile.angle * 0.017453292519943295f;
+    shape.cosA = shape.rotated ? std::cos(radians) : 1.0f;
+    shape.sinA = shape.rotated ? std::sin(radians) : 0.0f;
+    return shape;
+}
+
+// One-off containment test; hot paths keep TileShapes instead
+inline bool tileContains(const Tile& tile, float x, float y) {
+    if (tile.angle == 0.0f) {
+        return x > tile.x && x < tile.x + tile.width && y > tile.y && y < tile.y + tile.height;
+    }
+    return shapeOf(tile).contains(x, y);
+}
+
+#endif // TILE_H
@@ -0,0 +1,78 @@
+#include "tile_merge.h"
+#include "spatial_grid.h"
+#include <algorithm>
+#include <tuple>
+
+namespace {
+
+// Joins rectangles that line up along one axis. With byRows they must
+// share type, y and height and are joined along x; otherwise they share
+// type, x and width and are joined along y.
+std::vector<Tile> mergeRuns(std::vector<Tile> rects, bool byRows) {
+    auto key = [byRows](const Tile& t) {
+        return byRows ? std::make_tuple(static_cast<int>(t.type), t.y, t.height, t.x)
+                      : std::make_tuple(static_cast<int>(t.type), t.x, t.width, t.y);
+    };
+    std::sort(rects.begin(), rects.end(), [&](const Tile& a, const Tile& b) { return key(a) < key(b); });
+
+    std::vector<Tile> merged;
+    for (const Tile& rect : rects) {
+        if (!merged.empty()) {
+            Tile& last = merged.back();
+            if (byRows && last.type == rect.type && last.y == rect.y && last.height == rect.height &&
+                rect.x <= last.x + last.width) {
+                last.width = std::max(last.x + last.width, rect.x + rect.width) - last.x;
+                continue;
+            }
+            if (!byRows && last.type == rect.type && last.x == rect.x && last.width == rect.width &&
+                rect.y <= last.y + last.height) {
+                last.height = std::max(last.y + last.height, rect.y + rect.height) - last.y;
+                continue;
+            }
+        }
+        merged.push_back(rect);
+    }
+    return merged;
+}
+
+} // namespace
+
+std::vector<Tile> mergeTiles(const std::vector<Tile>& tiles, std::vector<uint32_t>* mergedSources) {
+    SpatialGrid grid;
+    grid.build(tiles);
+    if (mergedSources) {
+        mergedSources->clear();
+    }
+
+    std::vector<Tile> mergeable;
+    std::vector<Tile> kept;
+    for (uint32_t i = 0; i < tiles.size(); ++i) {
+        const Tile& tile = tiles[i];
+        float minX, minY, maxX, maxY;
+        tileBounds(tile, minX, minY, maxX, maxY);
+        bool overlapsOther = false;
+        grid.visitRect(minX, minY, maxX, maxY, [&](uint32_t j) {
+            const Tile& other = tiles[j];
+            if (overlapsOther || other.type == tile.type) {
+                return;
+            }
+            // Rotated tiles by their bounds, which can only keep more apart
+            float otherMinX, otherMinY, otherMaxX, otherMaxY;
+            tileBounds(other, otherMinX, otherMinY, otherMaxX, otherMaxY);
+            overlapsOther = otherMinX < maxX && otherMaxX > minX && otherMinY < maxY && otherMaxY > minY;
+        });
+
+        if (tile.angle == 0.0f && !overlapsOther && tile.width > 0.0f && tile.height > 0.0f) {
+            mergeable.push_back(tile);
+            if (mergedSources) {
+                mergedSources->push_back(i);
+            }
+        } else {
+            kept.push_back(tile);
+        }
+    }
+
+    std::vector<Tile> merged = mergeRuns(mergeRuns(std::move(mergeable), true), false);
+    merged.insert(merged.end(), kept.begin(), kept.end());
+    return merged;
+}
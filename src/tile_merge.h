@@ -0,0 +1,25 @@
+#ifndef TILE_MERGE_H
+#define TILE_MERGE_H
+
+#include <cstdint>
+#include <vector>
+#include "tile.h"
+
+// Coalesces tiles into fewer, larger rectangles covering the same area.
+//
+// Unrotated tiles of one type merge greedily: first into horizontal runs of
+// tiles with the same top and height that touch or overlap, then those runs
+// into columns with the same left and width. A grid of equal tiles ends up
+// as one rectangle per maximal block.
+//
+// A tile overlapping a tile of another type is left as it is, and these
+// keep their order after the merged rectangles, so anything drawn from the
+// result stacks the same way the original tiles did. Rotated tiles are
+// likewise kept as they are.
+//
+// mergedSources, if given, receives the indices of the tiles that went into
+// merged rectangles, in ascending order; the rest are the kept tiles at the
+// end of the result, one for one.
+std::vector<Tile> mergeTiles(const std::vector<Tile>& tiles, std::vector<uint32_t>* mergedSources = nullptr);
+
+#endif // TILE_MERGE_H
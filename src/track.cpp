@@ -1,53 +1,354 @@
 #include "track.h"
+#include "track_format.h"
+#include "tile_merge.h"
+#include "mapped_file.h"
+#include "renderer.h"
+#include "camera.h"
+#include "profiler.h"
+#include "physics.h"
 #include <fstream>
 #include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 
-Track::Track() {
+namespace {
+
+// Wall contacts resolved per car per tick
+const int MAX_WALL_CONTACTS = 4;
+// Share of the speed into a wall that a car bounces back with
+const float WALL_RESTITUTION = 0.5f;
+// Left between a car and the wall it stopped at, so the next sweep starts clear
+const float CONTACT_GAP = 0.01f;
+
+uint64_t nextGeneration() {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
 }
 
-bool Track::loadFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open track file: " << filename << std::endl;
+void boundsOf(const Tile& tile, float& minX, float& minY, float& maxX, float& maxY) {
+    tileBounds(tile, minX, minY, maxX, maxY);
+}
+
+void boundsOf(const TileShape& shape, float& minX, float& minY, float& maxX, float& maxY) {
+    minX = shape.minX;
+    minY = shape.minY;
+    maxX = shape.maxX;
+    maxY = shape.maxY;
+}
+
+// Over Tiles or, where they are kept, their TileShapes
+template <typename Item>
+void tilesOverlapping(const SpatialGrid& grid, const std::vector<Item>& items,
+                      float minX, float minY, float maxX, float maxY, std::vector<uint32_t>& out) {
+    out.clear();
+    grid.visitRect(minX, minY, maxX, maxY, [&](uint32_t index) {
+        float tileMinX, tileMinY, tileMaxX, tileMaxY;
+        boundsOf(items[index], tileMinX, tileMinY, tileMaxX, tileMaxY);
+        if (tileMinX < maxX && tileMaxX > minX && tileMinY < maxY && tileMaxY > minY) {
+            out.push_back(index);
+        }
+    });
+    // Multi-cell tiles are reported once per cell
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+// Road and the start line are outlined a shade darker, tile by tile
+bool isBordered(TileType type) {
+    return type == TileType::TRACK || type == TileType::START_FINISH;
+}
+
+std::vector<TileShape> shapesOf(const std::vector<Tile>& tiles) {
+    std::vector<TileShape> shapes;
+    shapes.reserve(tiles.size());
+    for (const Tile& tile : tiles) {
+        shapes.push_back(shapeOf(tile));
+    }
+    return shapes;
+}
+
+} // namespace
+
+Track::Track()
+    : mergedDrawCount(0)
+    , wallMinX(FLT_MAX), wallMinY(FLT_MAX), wallMaxX(-FLT_MAX), wallMaxY(-FLT_MAX)
+    , surfaceCellSize(SurfaceMap::DEFAULT_CELL_SIZE)
+    , generation(nextGeneration())
+    , racingLineDirty(true)
+    , flowFieldStale(true)
+    , flowFieldEdited(false)
+    , editMinX(0), editMinY(0), editMaxX(0), editMaxY(0)
+{
+}
+
+namespace {
+
+// Streams a JSON track straight into tile/start vectors through nlohmann's
+// SAX interface, so no DOM is built. Accepts the same documents as the old
+// DOM loader: unknown keys are skipped, "angle" is optional and numbers may
+// be integers, floats or booleans.
+class TrackSaxHandler : public json::json_sax_t {
+public:
+    TrackSaxHandler(std::vector<Tile>& tiles, std::vector<Point2D>& startPositions)
+        : tiles(tiles)
+        , startPositions(startPositions)
+        , depth(0)
+        , ignored(0)
+        , section(Section::NONE)
+        , field(Field::NONE)
+        , present(0)
+        , tile{}
+    {
+    }
+    
+    const std::string& getError() const { return error; }
+    
+    bool null() override { return scalar("null"); }
+    bool boolean(bool val) override { return number(val ? 1 : 0); }
+    bool number_integer(number_integer_t val) override { return number(val); }
+    bool number_unsigned(number_unsigned_t val) override { return number(val); }
+    bool number_float(number_float_t val, const string_t&) override { return number(val); }
+    bool string(string_t&) override { return scalar("string"); }
+    bool binary(binary_t&) override { return scalar("binary"); }
+    
+    bool start_object(std::size_t) override { return open(true); }
+    bool start_array(std::size_t) override { return open(false); }
+    bool end_object() override { return close(); }
+    bool end_array() override { return close(); }
+    
+    bool key(string_t& name) override {
+        if (ignored > 0) {
+            return true;
+        }
+        if (depth == 1) {
+            section = name == "tiles" ? Section::TILES
+                    : name == "startPositions" ? Section::START_POSITIONS
+                    : Section::OTHER;
+        } else if (depth == 3) {
+            field = lookupField(name);
+        }
+        return true;
+    }
+    
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        error = ex.what();
         return false;
     }
     
-    try {
-        json trackData;
-        file >> trackData;
+private:
+    enum class Section { NONE, TILES, START_POSITIONS, OTHER };
+    enum class Field { NONE, TYPE, X, Y, WIDTH, HEIGHT, ANGLE };
+    
+    std::vector<Tile>& tiles;
+    std::vector<Point2D>& startPositions;
+    std::string error;
+    
+    // depth 1: root object, 2: tiles/startPositions array, 3: one entry
+    int depth;
+    int ignored;
+    Section section;
+    Field field;
+    unsigned present;
+    Tile tile;
+    
+    static unsigned bit(Field f) { return 1u << static_cast<unsigned>(f); }
+    
+    Field lookupField(const std::string& name) const {
+        if (name == "x") return Field::X;
+        if (name == "y") return Field::Y;
+        if (section == Section::TILES) {
+            if (name == "type") return Field::TYPE;
+            if (name == "width") return Field::WIDTH;
+            if (name == "height") return Field::HEIGHT;
+            if (name == "angle") return Field::ANGLE;
+        }
+        return Field::NONE;
+    }
+    
+    static const char* fieldName(Field f) {
+        switch (f) {
+            case Field::TYPE: return "type";
+            case Field::X: return "x";
+            case Field::Y: return "y";
+            case Field::WIDTH: return "width";
+            case Field::HEIGHT: return "height";
+            case Field::ANGLE: return "angle";
+            default: return "";
+        }
+    }
+    
+    const char* sectionName() const {
+        return section == Section::TILES ? "tiles" : "startPositions";
+    }
+    
+    bool fail(const std::string& message) {
+        error = message;
+        return false;
+    }
+    
+    template <typename T>
+    bool number(T val) {
+        if (ignored > 0 || depth != 3) {
+            return scalar("number");
+        }
+        // A float that overflows (1e39) or a NaN would break every bounds
+        // computation downstream
+        if (field != Field::NONE && field != Field::TYPE && !std::isfinite(static_cast<float>(val))) {
+            return fail(std::string(sectionName()) + " \"" + fieldName(field) + "\" must be a finite number");
+        }
         
-        // Load tiles
-        tiles.clear();
-        if (trackData.contains("tiles")) {
-            for (const auto& tileData : trackData["tiles"]) {
-                Tile tile;
-                tile.type = static_cast<TileType>(tileData["type"].get<int>());
-                tile.x = tileData["x"].get<float>();
-                tile.y = tileData["y"].get<float>();
-                tile.width = tileData["width"].get<float>();
-                tile.height = tileData["height"].get<float>();
-                tile.angle = tileData.value("angle", 0.0f);
-                tiles.push_back(tile);
-            }
+        switch (field) {
+            case Field::TYPE: tile.type = static_cast<TileType>(static_cast<int>(val)); break;
+            case Field::X: tile.x = static_cast<float>(val); break;
+            case Field::Y: tile.y = static_cast<float>(val); break;
+            case Field::WIDTH: tile.width = static_cast<float>(val); break;
+            case Field::HEIGHT: tile.height = static_cast<float>(val); break;
+            case Field::ANGLE: tile.angle = static_cast<float>(val); break;
+            case Field::NONE: return true;
+        }
+        present |= bit(field);
+        return true;
+    }
+    
+    bool scalar(const char* typeName) {
+        if (ignored > 0) {
+            return true;
+        }
+        switch (depth) {
+            case 0:
+                return fail("track root must be an object");
+            case 1:
+                // Unknown keys are skipped and a null section reads as empty
+                if (section == Section::OTHER || std::strcmp(typeName, "null") == 0) {
+                    return true;
+                }
+                return fail(std::string(sectionName()) + " must be an array");
+            case 2:
+                return fail(std::string(sectionName()) + " entries must be objects");
+            default:
+                if (field == Field::NONE) {
+                    return true;
+                }
+                return fail(std::string(sectionName()) + " \"" + fieldName(field) +
+                            "\" must be a number, but is " + typeName);
+        }
+    }
+    
+    bool open(bool isObject) {
+        if (ignored > 0) {
+            ++ignored;
+            return true;
+        }
+        
+        switch (depth) {
+            case 0:
+                if (!isObject) {
+                    return fail("track root must be an object");
+                }
+                break;
+            case 1:
+                if (section == Section::OTHER) {
+                    ignored = 1;
+                    return true;
+                }
+                if (isObject) {
+                    return fail(std::string(sectionName()) + " must be an array");
+                }
+                break;
+            case 2:
+                if (!isObject) {
+                    return fail(std::string(sectionName()) + " entries must be objects");
+                }
+                tile = Tile{};
+                present = 0;
+                field = Field::NONE;
+                break;
+            default:
+                if (field != Field::NONE) {
+                    return scalar(isObject ? "object" : "array");
+                }
+                ignored = 1;
+                return true;
         }
         
-        // Load start positions
-        startPositions.clear();
-        if (trackData.contains("startPositions")) {
-            for (const auto& pos : trackData["startPositions"]) {
-                startPositions.push_back({
-                    pos["x"].get<float>(),
-                    pos["y"].get<float>()
-                });
+        ++depth;
+        return true;
+    }
+    
+    bool close() {
+        if (ignored > 0) {
+            --ignored;
+            return true;
+        }
+        
+        --depth;
+        if (depth == 2) {
+            return finishEntry();
+        }
+        return true;
+    }
+    
+    bool finishEntry() {
+        if (section == Section::START_POSITIONS) {
+            for (Field f : { Field::X, Field::Y }) {
+                if (!(present & bit(f))) {
+                    return fail(std::string("startPositions entry is missing \"") + fieldName(f) + "\"");
+                }
             }
+            startPositions.push_back({ tile.x, tile.y });
+            return true;
         }
         
+        for (Field f : { Field::TYPE, Field::X, Field::Y, Field::WIDTH, Field::HEIGHT }) {
+            if (!(present & bit(f))) {
+                return fail(std::string("tiles entry is missing \"") + fieldName(f) + "\"");
+            }
+        }
+        tiles.push_back(tile);
         return true;
+    }
+};
+
+} // namespace
+
+bool Track::loadFromFile(const std::string& filename) {
+    PROFILE_ZONE("Track::loadFromFile");
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open track file: " << filename << std::endl;
+        return false;
+    }
+    
+    // Reserve from the file size: saved tracks take roughly 60-130 bytes
+    // per tile depending on formatting
+    file.seekg(0, std::ios::end);
+    const auto fileSize = static_cast<size_t>(std::max<std::streamoff>(0, file.tellg()));
+    file.seekg(0, std::ios::beg);
+    
+    std::vector<Tile> newTiles;
+    std::vector<Point2D> newStarts;
+    newTiles.reserve(fileSize / 80);
+    
+    TrackSaxHandler handler(newTiles, newStarts);
+    bool parsed = false;
+    try {
+        parsed = json::sax_parse(file, &handler, json::input_format_t::json, false);
     } catch (const std::exception& e) {
         std::cerr << "Error parsing track file: " << e.what() << std::endl;
         return false;
     }
+    
+    if (!parsed) {
+        std::cerr << "Error parsing track file: " << handler.getError() << std::endl;
+        return false;
+    }
+    
+    setTiles(std::move(newTiles), std::move(newStarts));
+    return true;
 }
 
 bool Track::saveToFile(const std::string& filename) {
@@ -88,15 +389,204 @@ bool Track::saveToFile(const std::string& filename) {
     return true;
 }
 
-void Track::render(Renderer& renderer, const Camera& camera) {
-    for (const auto& tile : tiles) {
-        renderTile(tile, renderer, camera);
+bool Track::loadCompiled(const std::string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Failed to open compiled track file: " << filename << std::endl;
+        return false;
+    }
+    
+    CompiledTrackHeader header;
+    if (file.size() < sizeof(header)) {
+        std::cerr << "Compiled track file is truncated: " << filename << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    
+    if (std::memcmp(header.magic, COMPILED_TRACK_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != COMPILED_TRACK_VERSION ||
+        header.endianTag != COMPILED_TRACK_ENDIAN_TAG) {
+        std::cerr << "Unsupported compiled track file: " << filename << std::endl;
+        return false;
+    }
+    
+    const uint64_t cellCount = header.gridColumns >= 0 && header.gridRows >= 0
+        ? static_cast<uint64_t>(header.gridColumns) * header.gridRows + 1 : 0;
+    
+    auto sectionFits = [&](uint64_t offset, uint64_t bytes) {
+        return offset <= file.size() && bytes <= file.size() - offset;
+    };
+    
+    if (header.fileSize != file.size() || cellCount == 0 ||
+        !sectionFits(header.tilesOffset, uint64_t(header.tileCount) * sizeof(Tile)) ||
+        !sectionFits(header.startsOffset, uint64_t(header.startCount) * sizeof(Point2D)) ||
+        !sectionFits(header.gridCellStartOffset, cellCount * sizeof(uint32_t)) ||
+        !sectionFits(header.gridCellItemsOffset, uint64_t(header.gridItemCount) * sizeof(uint32_t))) {
+        std::cerr << "Compiled track file is truncated: " << filename << std::endl;
+        return false;
+    }
+    
+    // Every section is a straight copy out of the mapping
+    std::vector<Tile> newTiles(header.tileCount);
+    std::vector<Point2D> newStarts(header.startCount);
+    std::vector<uint32_t> cellStart(cellCount);
+    std::vector<uint32_t> cellItems(header.gridItemCount);
+    
+    std::memcpy(newTiles.data(), file.data() + header.tilesOffset, newTiles.size() * sizeof(Tile));
+    std::memcpy(newStarts.data(), file.data() + header.startsOffset, newStarts.size() * sizeof(Point2D));
+    std::memcpy(cellStart.data(), file.data() + header.gridCellStartOffset, cellStart.size() * sizeof(uint32_t));
+    std::memcpy(cellItems.data(), file.data() + header.gridCellItemsOffset, cellItems.size() * sizeof(uint32_t));
+    
+    auto finiteTile = [](const Tile& tile) {
+        return std::isfinite(tile.x) && std::isfinite(tile.y) && std::isfinite(tile.width) &&
+               std::isfinite(tile.height) && std::isfinite(tile.angle);
+    };
+    auto finiteStart = [](const Point2D& start) { return std::isfinite(start.x) && std::isfinite(start.y); };
+    if (!std::all_of(newTiles.begin(), newTiles.end(), finiteTile) ||
+        !std::all_of(newStarts.begin(), newStarts.end(), finiteStart)) {
+        std::cerr << "Non-finite tile or start position in compiled track file: " << filename << std::endl;
+        return false;
+    }
+    
+    SpatialGrid grid;
+    if (!grid.assign(header.gridOriginX, header.gridOriginY, header.gridCellSize,
+                     header.gridColumns, header.gridRows,
+                     std::move(cellStart), std::move(cellItems), newTiles.size())) {
+        std::cerr << "Corrupt spatial index in compiled track file: " << filename << std::endl;
+        return false;
+    }
+    
+    tiles = std::move(newTiles);
+    startPositions = std::move(newStarts);
+    tileGrid = std::move(grid);
+    mergeTiles();
+    racingLineDirty = true;
+    invalidateFlowField();
+    return true;
+}
+
+bool Track::saveCompiled(const std::string& filename) const {
+    SpatialGrid grid;
+    grid.build(tiles);
+    
+    const auto& cellStart = grid.getCellStart();
+    const auto& cellItems = grid.getCellItems();
+    
+    auto align = [](uint64_t offset) { return (offset + 7) & ~uint64_t(7); };
+    
+    CompiledTrackHeader header = {};
+    std::memcpy(header.magic, COMPILED_TRACK_MAGIC, sizeof(header.magic));
+    header.version = COMPILED_TRACK_VERSION;
+    header.endianTag = COMPILED_TRACK_ENDIAN_TAG;
+    header.tileCount = static_cast<uint32_t>(tiles.size());
+    header.startCount = static_cast<uint32_t>(startPositions.size());
+    header.gridColumns = grid.getColumns();
+    header.gridRows = grid.getRows();
+    header.gridOriginX = grid.getOriginX();
+    header.gridOriginY = grid.getOriginY();
+    header.gridCellSize = grid.getCellSize();
+    header.gridItemCount = static_cast<uint32_t>(cellItems.size());
+    header.tilesOffset = align(sizeof(header));
+    header.startsOffset = align(header.tilesOffset + tiles.size() * sizeof(Tile));
+    header.gridCellStartOffset = align(header.startsOffset + startPositions.size() * sizeof(Point2D));
+    header.gridCellItemsOffset = align(header.gridCellStartOffset + cellStart.size() * sizeof(uint32_t));
+    header.fileSize = header.gridCellItemsOffset + cellItems.size() * sizeof(uint32_t);
+    
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to save compiled track file: " << filename << std::endl;
+        return false;
+    }
+    
+    uint64_t written = 0;
+    auto writeSection = [&](uint64_t offset, const void* data, uint64_t bytes) {
+        static const char padding[8] = {};
+        file.write(padding, static_cast<std::streamsize>(offset - written));
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        written = offset + bytes;
+    };
+    
+    writeSection(0, &header, sizeof(header));
+    writeSection(header.tilesOffset, tiles.data(), tiles.size() * sizeof(Tile));
+    writeSection(header.startsOffset, startPositions.data(), startPositions.size() * sizeof(Point2D));
+    writeSection(header.gridCellStartOffset, cellStart.data(), cellStart.size() * sizeof(uint32_t));
+    writeSection(header.gridCellItemsOffset, cellItems.data(), cellItems.size() * sizeof(uint32_t));
+    
+    if (!file) {
+        std::cerr << "Failed to write compiled track file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Track::load(const std::string& filename) {
+    const std::string compiled = compiledPathFor(filename);
+    
+    std::error_code error;
+    auto compiledTime = std::filesystem::last_write_time(compiled, error);
+    if (!error) {
+        auto sourceTime = std::filesystem::last_write_time(filename, error);
+        if ((error || compiledTime >= sourceTime) && loadCompiled(compiled)) {
+            return true;
+        }
+    }
+    
+    return loadFromFile(filename);
+}
+
+std::string Track::compiledPathFor(const std::string& filename) {
+    return std::filesystem::path(filename).replace_extension(".trk").string();
+}
+
+void Track::render(Renderer& renderer, const Camera& camera) const {
+    PROFILE_ZONE("Track::render");
+    ViewRect view = camera.getVisibleRect();
+    size_t drawn = drawLayer(renderer, view.minX, view.minY, view.maxX, view.maxY, camera.getX(), camera.getY());
+    
+    RenderStats& stats = renderer.getStats();
+    stats.tilesSubmitted += drawn;
+    stats.tilesCulled += drawTiles.size() - drawn;
+}
+
+size_t Track::drawLayer(Renderer& renderer, float minX, float minY, float maxX, float maxY,
+                        float offsetX, float offsetY) const {
+    drawTilesInRect(minX, minY, maxX, maxY, visibleTiles);
+    auto kept = std::lower_bound(visibleTiles.begin(), visibleTiles.end(), mergedDrawCount);
+    for (auto it = visibleTiles.begin(); it != kept; ++it) {
+        renderTileParts(drawTiles[*it], drawShapes[*it], renderer, offsetX, offsetY, true, false);
+    }
+    
+    // A road tile merged into a rectangle still has its own outline. Merged
+    // tiles only overlap tiles of their own type, so nothing kept apart is
+    // underneath one.
+    if (kept != visibleTiles.begin()) {
+        tilesInRect(minX, minY, maxX, maxY, visibleBorders);
+        for (uint32_t index : visibleBorders) {
+            if (mergedBorder[index]) {
+                renderTileParts(tiles[index], shapeOf(tiles[index]), renderer, offsetX, offsetY, false, true);
+            }
+        }
+    }
+    
+    for (auto it = kept; it != visibleTiles.end(); ++it) {
+        renderTile(drawTiles[*it], drawShapes[*it], renderer, offsetX, offsetY);
     }
+    return visibleTiles.size();
 }
 
-void Track::renderTile(const Tile& tile, Renderer& renderer, const Camera& camera) {
-    float screenX = tile.x - camera.getX();
-    float screenY = tile.y - camera.getY();
+void Track::renderTile(const Tile& tile, Renderer& renderer, float offsetX, float offsetY) {
+    renderTile(tile, shapeOf(tile), renderer, offsetX, offsetY);
+}
+
+void Track::renderTile(const Tile& tile, const TileShape& shape, Renderer& renderer,
+                       float offsetX, float offsetY) {
+    renderTileParts(tile, shape, renderer, offsetX, offsetY, true, true);
+}
+
+void Track::renderTileParts(const Tile& tile, const TileShape& shape, Renderer& renderer,
+                            float offsetX, float offsetY, bool fill, bool border) {
+    float screenX = tile.x - offsetX;
+    float screenY = tile.y - offsetY;
     
     int r, g, b;
     switch (tile.type) {
@@ -122,60 +612,211 @@ void Track::renderTile(const Tile& tile, Renderer& renderer, const Camera& camer
             r = 128; g = 128; b = 128;
     }
     
-    renderer.drawRect(screenX, screenY, tile.width, tile.height, r, g, b);
+    bool bordered = border && isBordered(tile.type);
+    if (shape.rotated) {
+        Point2D world[4];
+        shape.corners(world);
+        SDL_FPoint corners[4];
+        for (int i = 0; i < 4; ++i) {
+            corners[i] = { world[i].x - offsetX, world[i].y - offsetY };
+        }
+        if (fill) {
+            renderer.drawQuad(corners, r, g, b);
+        }
+        if (bordered) {
+            renderer.drawQuad(corners, r - 30, g - 30, b - 30, false);
+        }
+        return;
+    }
+    
+    if (fill) {
+        renderer.drawRect(screenX, screenY, tile.width, tile.height, r, g, b);
+    }
     
     // Draw border for track tiles
-    if (tile.type == TileType::TRACK || tile.type == TileType::START_FINISH) {
+    if (bordered) {
         renderer.drawRect(screenX, screenY, tile.width, tile.height, 
                          r - 30, g - 30, b - 30, false);
     }
 }
 
-void Track::checkCollisions(Car& car) {
-    bool onTrack = isOnTrack(car.getX(), car.getY());
+CollisionResult Track::checkCollisions(Car& car, float deltaTime) {
+    CollisionResult result;
+    result.offTrack = !isOnTrack(car.getX(), car.getY());
     
-    if (!onTrack) {
-        // Apply friction when off track
-        car.setVelocity(car.getVelocityX() * 0.9f, car.getVelocityY() * 0.9f);
+    if (result.offTrack) {
+        // Apply friction when off track (0.9 of the velocity kept per 1/60 s)
+        float friction = std::pow(0.9f, deltaTime * 60.0f);
+        car.setVelocity(car.getVelocityX() * friction, car.getVelocityY() * friction);
     }
     
-    // Check for wall collisions
-    for (const auto& tile : tiles) {
-        if (tile.type == TileType::WALL) {
-            float dx = car.getX() - (tile.x + tile.width / 2);
-            float dy = car.getY() - (tile.y + tile.height / 2);
-            float distance = std::sqrt(dx * dx + dy * dy);
-            
-            float minDist = car.getRadius() + std::min(tile.width, tile.height) / 2;
-            
-            if (distance < minDist && 
-                car.getX() > tile.x && car.getX() < tile.x + tile.width &&
-                car.getY() > tile.y && car.getY() < tile.y + tile.height) {
-                // Push car out of wall
-                float angle = std::atan2(dy, dx);
-                car.setPosition(
-                    tile.x + tile.width / 2 + std::cos(angle) * minDist,
-                    tile.y + tile.height / 2 + std::sin(angle) * minDist
-                );
-                // Bounce back
-                car.setVelocity(-car.getVelocityX() * 0.5f, -car.getVelocityY() * 0.5f);
+    // Each contact ends the sweep there and starts a new one with what is
+    // left of the move; a car wedged between walls gives up after a few
+    const float radius = car.getRadius();
+    float x = car.getPreviousX();
+    float y = car.getPreviousY();
+    float moveX = car.getX() - x;
+    float moveY = car.getY() - y;
+    float vx = car.getVelocityX();
+    float vy = car.getVelocityY();
+    
+    for (int contact = 0; contact < MAX_WALL_CONTACTS; ++contact) {
+        // First wall met, or the lowest-indexed one already overlapped
+        uint32_t hit = UINT32_MAX;
+        float hitT = 0.0f, normalX = 0.0f, normalY = 0.0f, depth = 0.0f;
+        const float minX = std::min(x, x + moveX) - radius;
+        const float minY = std::min(y, y + moveY) - radius;
+        const float maxX = std::max(x, x + moveX) + radius;
+        const float maxY = std::max(y, y + moveY) + radius;
+        if (minX > wallMaxX || maxX < wallMinX || minY > wallMaxY || maxY < wallMinY) {
+            break;
+        }
+        wallGrid.visitRect(minX, minY, maxX, maxY, [&](uint32_t index) {
+            const TileShape& wall = wallShapes[index];
+            if (wall.minX > maxX || wall.maxX < minX || wall.minY > maxY || wall.maxY < minY) {
+                return;
             }
+            float t = 0.0f, nx, ny, d = 0.0f;
+            if (!Physics::circleBoxPenetration(x, y, radius, wall, nx, ny, d) &&
+                !Physics::sweepCircleBox(x, y, moveX, moveY, radius, wall, t, nx, ny)) {
+                return;
+            }
+            if (hit == UINT32_MAX || t < hitT || (t == hitT && index < hit)) {
+                hit = index;
+                hitT = t;
+                normalX = nx;
+                normalY = ny;
+                depth = d;
+            }
+        });
+        
+        if (hit == UINT32_MAX) {
+            break;
+        }
+        ++result.wallHits;
+        
+        x += moveX * hitT + normalX * (depth + CONTACT_GAP);
+        y += moveY * hitT + normalY * (depth + CONTACT_GAP);
+        moveX *= 1.0f - hitT;
+        moveY *= 1.0f - hitT;
+        
+        float moveInto = moveX * normalX + moveY * normalY;
+        if (moveInto < 0.0f) {
+            moveX -= (1.0f + WALL_RESTITUTION) * moveInto * normalX;
+            moveY -= (1.0f + WALL_RESTITUTION) * moveInto * normalY;
         }
+        float speedInto = vx * normalX + vy * normalY;
+        if (speedInto < 0.0f) {
+            vx -= (1.0f + WALL_RESTITUTION) * speedInto * normalX;
+            vy -= (1.0f + WALL_RESTITUTION) * speedInto * normalY;
+        }
+        if (contact + 1 == MAX_WALL_CONTACTS) {
+            moveX = 0.0f;
+            moveY = 0.0f;
+        }
+    }
+    
+    if (result.wallHits > 0) {
+        car.setPosition(x + moveX, y + moveY);
+        car.setVelocity(vx, vy);
     }
+    return result;
 }
 
 bool Track::isOnTrack(float x, float y) const {
-    for (const auto& tile : tiles) {
-        if ((tile.type == TileType::TRACK || 
-             tile.type == TileType::START_FINISH ||
-             tile.type == TileType::CHECKPOINT ||
-             tile.type == TileType::JUMP) &&
-            x > tile.x && x < tile.x + tile.width &&
-            y > tile.y && y < tile.y + tile.height) {
-            return true;
+    uint8_t surface = surfaceMap.lookup(x, y);
+    if (surface != SurfaceMap::MIXED) {
+        return isDrivable(static_cast<TileType>(surface));
+    }
+    return onDrivableTile(x, y);
+}
+
+bool Track::onDrivableTile(float x, float y) const {
+    return drivableGrid.visitPoint(x, y, [&](uint32_t index) {
+        return drivableShapes[index].contains(x, y);
+    });
+}
+
+TileType Track::surfaceAt(float x, float y) const {
+    uint8_t surface = surfaceMap.lookup(x, y);
+    if (surface != SurfaceMap::MIXED) {
+        return static_cast<TileType>(surface);
+    }
+    
+    // Same precedence as the map: the drivable type ranked highest, then wall
+    bool drivable = onDrivableTile(x, y);
+    auto rank = [drivable](TileType type) {
+        switch (type) {
+            case TileType::JUMP: return drivable ? 4 : 0;
+            case TileType::CHECKPOINT: return drivable ? 3 : 0;
+            case TileType::START_FINISH: return drivable ? 2 : 0;
+            case TileType::TRACK: return drivable ? 1 : 0;
+            case TileType::WALL: return drivable ? 0 : 1;
+            default: return 0;
+        }
+    };
+    TileType best = drivable ? TileType::TRACK : TileType::GRASS;
+    drawGrid.visitPoint(x, y, [&](uint32_t index) {
+        TileType type = drawTiles[index].type;
+        if (rank(type) > rank(best) && drawShapes[index].contains(x, y)) {
+            best = type;
         }
+        return false;
+    });
+    return best;
+}
+
+int Track::drivableTileAt(float x, float y) const {
+    int found = -1;
+    tileGrid.visitPoint(x, y, [&](uint32_t index) {
+        const Tile& tile = tiles[index];
+        if (isDrivable(tile.type) && (found < 0 || index < static_cast<uint32_t>(found)) &&
+            tileContains(tile, x, y)) {
+            found = static_cast<int>(index);
+        }
+        return false;
+    });
+    return found;
+}
+
+const RacingLine& Track::getRacingLine() const {
+    if (racingLineDirty) {
+        racingLine.build(*this);
+        racingLineDirty = false;
+    }
+    return racingLine;
+}
+
+const FlowField& Track::getFlowField() const {
+    // A clean call only reads the flags, so it is safe from many threads
+    if (flowFieldStale) {
+        flowField.build(*this);
+        flowFieldStale = false;
+        flowFieldEdited = false;
+    } else if (flowFieldEdited) {
+        flowField.update(*this, editMinX, editMinY, editMaxX, editMaxY);
+        flowFieldEdited = false;
     }
-    return false;
+    return flowField;
+}
+
+void Track::resetWallBounds() {
+    wallMinX = FLT_MAX;
+    wallMinY = FLT_MAX;
+    wallMaxX = -FLT_MAX;
+    wallMaxY = -FLT_MAX;
+}
+
+void Track::growWallBounds(const TileShape& wall) {
+    wallMinX = std::min(wallMinX, wall.minX);
+    wallMinY = std::min(wallMinY, wall.minY);
+    wallMaxX = std::max(wallMaxX, wall.maxX);
+    wallMaxY = std::max(wallMaxY, wall.maxY);
+}
+
+void Track::invalidateFlowField() {
+    flowFieldStale = true;
+    flowFieldEdited = false;
 }
 
 Point2D Track::getStartPosition(int index) const {
@@ -187,9 +828,137 @@ Point2D Track::getStartPosition(int index) const {
 
 void Track::addTile(TileType type, float x, float y, float width, float height, float angle) {
     tiles.push_back({type, x, y, width, height, angle});
+    tileGrid.insert(tiles, static_cast<uint32_t>(tiles.size() - 1));
+    const TileShape shape = shapeOf(tiles.back());
+    drawTiles.push_back(tiles.back());
+    drawShapes.push_back(shape);
+    drawGrid.insert(drawTiles, static_cast<uint32_t>(drawTiles.size() - 1));
+    mergedBorder.push_back(0);
+    if (isDrivable(type)) {
+        drivableTiles.push_back({TileType::TRACK, x, y, width, height, angle});
+        drivableShapes.push_back(shape);
+        drivableGrid.insert(drivableTiles, static_cast<uint32_t>(drivableTiles.size() - 1));
+    }
+    if (type == TileType::WALL) {
+        wallTiles.push_back(tiles.back());
+        wallShapes.push_back(shape);
+        wallGrid.insert(wallTiles, static_cast<uint32_t>(wallTiles.size() - 1));
+        growWallBounds(shape);
+    }
+    if (!surfaceMap.empty()) {
+        surfaceMap.clear();
+    }
+    racingLineDirty = true;
+    
+    if (!flowFieldStale) {
+        if (!flowFieldEdited) {
+            editMinX = shape.minX;
+            editMinY = shape.minY;
+            editMaxX = shape.maxX;
+            editMaxY = shape.maxY;
+        }
+        editMinX = std::min(editMinX, shape.minX);
+        editMinY = std::min(editMinY, shape.minY);
+        editMaxX = std::max(editMaxX, shape.maxX);
+        editMaxY = std::max(editMaxY, shape.maxY);
+        flowFieldEdited = true;
+    }
+}
+
+void Track::setTiles(std::vector<Tile> newTiles, std::vector<Point2D> newStarts) {
+    tiles = std::move(newTiles);
+    startPositions = std::move(newStarts);
+    tileGrid.build(tiles);
+    mergeTiles();
+    racingLineDirty = true;
+    invalidateFlowField();
+}
+
+void Track::tilesInRect(float minX, float minY, float maxX, float maxY, std::vector<uint32_t>& out) const {
+    tilesOverlapping(tileGrid, tiles, minX, minY, maxX, maxY, out);
+}
+
+void Track::drawTilesInRect(float minX, float minY, float maxX, float maxY, std::vector<uint32_t>& out) const {
+    tilesOverlapping(drawGrid, drawShapes, minX, minY, maxX, maxY, out);
+}
+
+TileMergeStats Track::mergeTiles() {
+    PROFILE_ZONE("Track::mergeTiles");
+    // The rectangles are indexed as finely as the tiles they replace, so a
+    // point still only meets the few around it rather than every long strip
+    const float cellSize = tileGrid.getCellSize();
+    const size_t maxCells = 4 * tiles.size() + 64;
+    
+    std::vector<uint32_t> mergedSources;
+    drawTiles = ::mergeTiles(tiles, &mergedSources);
+    drawShapes = shapesOf(drawTiles);
+    drawGrid.build(drawTiles, cellSize, maxCells);
+    mergedDrawCount = drawTiles.size() - (tiles.size() - mergedSources.size());
+    mergedBorder.assign(tiles.size(), 0);
+    for (uint32_t index : mergedSources) {
+        mergedBorder[index] = isBordered(tiles[index].type);
+    }
+    
+    // Only drivability matters here, so every drivable type merges together
+    std::vector<Tile> drivable;
+    for (const Tile& tile : tiles) {
+        if (isDrivable(tile.type)) {
+            drivable.push_back(tile);
+            drivable.back().type = TileType::TRACK;
+        }
+    }
+    drivableTiles = ::mergeTiles(drivable);
+    drivableShapes = shapesOf(drivableTiles);
+    drivableGrid.build(drivableTiles, cellSize, maxCells);
+    
+    std::vector<Tile> walls;
+    for (const Tile& tile : tiles) {
+        if (tile.type == TileType::WALL) {
+            walls.push_back(tile);
+        }
+    }
+    wallTiles = ::mergeTiles(walls);
+    wallShapes = shapesOf(wallTiles);
+    wallGrid.build(wallTiles, cellSize, maxCells);
+    resetWallBounds();
+    for (const TileShape& wall : wallShapes) {
+        growWallBounds(wall);
+    }
+    
+    if (surfaceCellSize > 0.0f) {
+        surfaceMap.build(drawTiles, drawGrid, drivableTiles, drivableGrid, surfaceCellSize);
+    } else {
+        surfaceMap.clear();
+    }
+    
+    generation = nextGeneration();
+    
+    TileMergeStats stats;
+    stats.tiles = tiles.size();
+    stats.drawTiles = drawTiles.size();
+    stats.drivableTiles = drivableTiles.size();
+    stats.wallTiles = wallTiles.size();
+    return stats;
 }
 
 void Track::clear() {
     tiles.clear();
     startPositions.clear();
+    tileGrid.clear();
+    drawTiles.clear();
+    drawShapes.clear();
+    drawGrid.clear();
+    mergedDrawCount = 0;
+    mergedBorder.clear();
+    drivableTiles.clear();
+    drivableShapes.clear();
+    drivableGrid.clear();
+    wallTiles.clear();
+    wallShapes.clear();
+    wallGrid.clear();
+    resetWallBounds();
+    surfaceMap.clear();
+    generation = nextGeneration();
+    racingLineDirty = true;
+    invalidateFlowField();
 }
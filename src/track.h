@@ -4,30 +4,30 @@
 #include <string>
 #include <vector>
 #include <nlohmann/json.hpp>
-#include "renderer.h"
-#include "camera.h"
 #include "car.h"
+#include "tile.h"
+#include "spatial_grid.h"
+#include "surface_map.h"
+#include "racing_line.h"
+#include "flow_field.h"
 
 using json = nlohmann::json;
 
-enum class TileType {
-    GRASS,
-    TRACK,
-    START_FINISH,
-    CHECKPOINT,
-    JUMP,
-    WALL
-};
+class Renderer;
+class Camera;
 
-struct Tile {
-    TileType type;
-    float x, y;
-    float width, height;
-    float angle;
+// What Track::checkCollisions found for a car this tick
+struct CollisionResult {
+    bool offTrack = false;
+    int wallHits = 0; // Wall contacts this tick
 };
 
-struct Point2D {
-    float x, y;
+// Tile counts before and after Track::mergeTiles()
+struct TileMergeStats {
+    size_t tiles = 0;
+    size_t drawTiles = 0;
+    size_t drivableTiles = 0;
+    size_t wallTiles = 0;
 };
 
 class Track {
@@ -37,22 +37,138 @@ public:
     bool loadFromFile(const std::string& filename);
     bool saveToFile(const std::string& filename);
     
-    void render(Renderer& renderer, const Camera& camera);
-    void checkCollisions(Car& car);
+    // Compiled binary tracks (see track_format.h)
+    bool loadCompiled(const std::string& filename);
+    bool saveCompiled(const std::string& filename) const;
+    
+    // Loads a JSON track, preferring its compiled sibling when that exists
+    // and is at least as new as the JSON file
+    bool load(const std::string& filename);
+    static std::string compiledPathFor(const std::string& filename);
+    
+    // Draws the tiles in view, found through the spatial index, with
+    // drawLayer(). TrackChunks caches this for the game and editor.
+    void render(Renderer& renderer, const Camera& camera) const;
+    
+    // Draws the tiles overlapping a world rectangle, offset by (-offsetX,
+    // -offsetY), looking just as drawing every tile in order would: the
+    // merged fills, then the border of each road tile merged into them,
+    // then the tiles kept apart. Returns how many of getDrawTiles() it drew.
+    size_t drawLayer(Renderer& renderer, float minX, float minY, float maxX, float maxY,
+                     float offsetX, float offsetY) const;
+    
+    // Draws one tile offset by (-offsetX, -offsetY), turned by its angle
+    static void renderTile(const Tile& tile, Renderer& renderer, float offsetX, float offsetY);
+    static void renderTile(const Tile& tile, const TileShape& shape, Renderer& renderer,
+                           float offsetX, float offsetY);
+    
+    // Slows a car off the track, then sweeps its circle along this tick's
+    // move (from its pose at Car::beginTick() to where it is now) against
+    // the walls. At the first contact the car stops there and the rest of
+    // its move and its velocity bounce off the wall; a car that starts
+    // inside a wall is pushed straight out. Fast cars cannot pass through
+    // thin walls. Rotated walls are oriented boxes.
+    CollisionResult checkCollisions(Car& car, float deltaTime);
+    bool isOnTrack(float x, float y) const;
+    
+    // Surface under a point as SurfaceMap defines it; isOnTrack() is
+    // isDrivable(surfaceAt()). Read from the surface map where it can be,
+    // from the merged tiles where a tile edge is near.
+    TileType surfaceAt(float x, float y) const;
+    
+    // Lowest-indexed drivable tile containing (x, y), or -1
+    int drivableTileAt(float x, float y) const;
+    
+    // Built on first use after the tiles change, then shared by every bot.
+    // Not safe to call concurrently while a rebuild is pending.
+    const RacingLine& getRacingLine() const;
+    
+    // Steering field over the racing line, likewise built on first use.
+    // Tiles added since then are patched in around where they went, still
+    // following the line the field was built with; a load or clear, or a
+    // tile outside the field, rebuilds it along the current line.
+    const FlowField& getFlowField() const;
     
     Point2D getStartPosition(int index) const;
     
     void addTile(TileType type, float x, float y, float width, float height, float angle = 0);
+    // Replaces the whole track at once and merges it, as loading does;
+    // much faster than addTile() one by one for large generated tracks
+    void setTiles(std::vector<Tile> newTiles, std::vector<Point2D> newStarts);
     void clear();
     
+    // Tiles as authored, for editing and saving
     const std::vector<Tile>& getTiles() const { return tiles; }
     
+    // Coalesces the tiles (see tile_merge.h) into the rectangles render()
+    // fills, the walls checkCollisions() sweeps against and, ignoring which
+    // drivable type each is, the ones isOnTrack() tests. getTiles() is
+    // untouched. Runs on load; tiles added afterwards are appended unmerged
+    // until the next call.
+    TileMergeStats mergeTiles();
+    const std::vector<Tile>& getDrawTiles() const { return drawTiles; }
+    const std::vector<TileShape>& getDrawShapes() const { return drawShapes; }
+    
+    // Cell size of the surface map mergeTiles() builds, 0 for none. Takes
+    // effect from the next mergeTiles(); adding a tile drops the map until
+    // then.
+    void setSurfaceCellSize(float size) { surfaceCellSize = size; }
+    const SurfaceMap& getSurfaceMap() const { return surfaceMap; }
+    
+    // Indices, in ascending order, of the tiles overlapping a rectangle
+    void tilesInRect(float minX, float minY, float maxX, float maxY, std::vector<uint32_t>& out) const;
+    
+    // Likewise for getDrawTiles()
+    void drawTilesInRect(float minX, float minY, float maxX, float maxY, std::vector<uint32_t>& out) const;
+    
+    // Changes whenever the tile list or its merged form is replaced rather
+    // than appended to (load, clear, mergeTiles), and is never shared by
+    // two tracks
+    uint64_t getGeneration() const { return generation; }
+    const std::vector<Point2D>& getStartPositions() const { return startPositions; }
+    
 private:
     std::vector<Tile> tiles;
     std::vector<Point2D> startPositions;
+    SpatialGrid tileGrid;
+    // Each merged set keeps its tiles' shapes alongside, index for index
+    std::vector<Tile> drawTiles;
+    std::vector<TileShape> drawShapes;
+    SpatialGrid drawGrid;
+    // drawTiles before this are merged rectangles; the rest are kept tiles
+    size_t mergedDrawCount;
+    // Per tile: a road tile merged into one of them, outlined on its own
+    std::vector<uint8_t> mergedBorder;
+    std::vector<Tile> drivableTiles; // All typed TRACK
+    std::vector<TileShape> drivableShapes;
+    SpatialGrid drivableGrid;
+    std::vector<Tile> wallTiles;
+    std::vector<TileShape> wallShapes;
+    SpatialGrid wallGrid;
+    float wallMinX, wallMinY, wallMaxX, wallMaxY; // Around every wall; min > max when there are none
+    SurfaceMap surfaceMap;
+    float surfaceCellSize;
+    uint64_t generation;
+    mutable std::vector<uint32_t> visibleTiles; // Scratch for drawLayer()
+    mutable std::vector<uint32_t> visibleBorders;
     
-    void renderTile(const Tile& tile, Renderer& renderer, const Camera& camera);
-    bool isOnTrack(float x, float y) const;
+    mutable RacingLine racingLine;
+    mutable bool racingLineDirty;
+    
+    mutable FlowField flowField;
+    mutable bool flowFieldStale;
+    // Bounds of tiles added since the flow field was last refreshed
+    mutable bool flowFieldEdited;
+    mutable float editMinX, editMinY, editMaxX, editMaxY;
+    
+    void invalidateFlowField();
+    
+    static void renderTileParts(const Tile& tile, const TileShape& shape, Renderer& renderer,
+                                float offsetX, float offsetY, bool fill, bool border);
+    
+    bool onDrivableTile(float x, float y) const;
+    void resetWallBounds();
+    void growWallBounds(const TileShape& wall);
 };
 
 #endif // TRACK_H
@@ -0,0 +1,226 @@
+#include "track_chunks.h"
+#include "track.h"
+#include "camera.h"
+#include "renderer.h"
+#include "profiler.h"
+#include <cmath>
+
+TrackChunks::TrackChunks(Renderer& renderer)
+    : renderer(renderer)
+    , generation(0)
+    , tilesSeen(0)
+    , frame(0)
+    , textureCount(0)
+    , redrawCount(0)
+    , unsupported(false)
+{
+}
+
+TrackChunks::~TrackChunks() {
+    clear();
+}
+
+void TrackChunks::clear() {
+    for (auto& entry : chunks) {
+        if (entry.second.texture) {
+            SDL_DestroyTexture(entry.second.texture);
+        }
+    }
+    for (SDL_Texture* texture : spareTextures) {
+        SDL_DestroyTexture(texture);
+    }
+    chunks.clear();
+    spareTextures.clear();
+    textureCount = 0;
+    generation = 0; // Never a track's, so the next render starts afresh
+    tilesSeen = 0;
+}
+
+void TrackChunks::render(const Track& track, const Camera& camera) {
+    PROFILE_ZONE("TrackChunks::render");
+    SDL_Renderer* sdl = renderer.getSDLRenderer();
+    if (!sdl) {
+        return;
+    }
+    if (unsupported) {
+        track.render(renderer, camera);
+        return;
+    }
+
+    sync(track);
+    ++frame;
+
+    const ViewRect view = camera.getVisibleRect();
+    const float left = camera.getX();
+    const float top = camera.getY();
+    const int cx0 = static_cast<int>(std::floor(view.minX / CHUNK_SIZE));
+    const int cy0 = static_cast<int>(std::floor(view.minY / CHUNK_SIZE));
+    const int cx1 = static_cast<int>(std::floor(view.maxX / CHUNK_SIZE));
+    const int cy1 = static_cast<int>(std::floor(view.maxY / CHUNK_SIZE));
+
+    // Mark the whole view first, so no visible chunk gives up its texture
+    // to another one this frame
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            auto it = chunks.find(chunkKey(cx, cy));
+            if (it != chunks.end()) {
+                it->second.lastShown = frame;
+            }
+        }
+    }
+
+    // Whatever was queued before the track stays underneath it
+    renderer.flush();
+
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            auto it = chunks.find(chunkKey(cx, cy));
+            if (it == chunks.end()) {
+                // Tiles are only appended, so an empty chunk stays empty
+                // until the next generation
+                if (!findTiles(track, cx, cy)) {
+                    continue;
+                }
+                it = chunks.emplace(chunkKey(cx, cy), Chunk()).first;
+                it->second.lastShown = frame;
+            }
+            Chunk& chunk = it->second;
+            if (chunk.dirty && !redraw(track, cx, cy, chunk)) {
+                SDL_Log("Track chunk textures unavailable, drawing tiles directly: %s", SDL_GetError());
+                unsupported = true;
+                clear();
+                track.render(renderer, camera);
+                return;
+            }
+
+            // Whole pixels, matching how the tiles would have been placed
+            SDL_FRect dest = {
+                std::round(cx * static_cast<float>(CHUNK_SIZE) - left),
+                std::round(cy * static_cast<float>(CHUNK_SIZE) - top),
+                static_cast<float>(CHUNK_SIZE),
+                static_cast<float>(CHUNK_SIZE)
+            };
+            SDL_RenderTexture(sdl, chunk.texture, nullptr, &dest);
+            ++renderer.getStats().chunksSubmitted;
+        }
+    }
+}
+
+void TrackChunks::sync(const Track& track) {
+    const auto& tiles = track.getDrawTiles();
+    const auto& shapes = track.getDrawShapes();
+
+    if (track.getGeneration() != generation || tiles.size() < tilesSeen) {
+        for (auto& entry : chunks) {
+            if (entry.second.texture) {
+                spareTextures.push_back(entry.second.texture);
+            }
+        }
+        chunks.clear();
+        generation = track.getGeneration();
+        tilesSeen = tiles.size();
+        return;
+    }
+
+    // Tiles are only ever appended between generations
+    for (size_t i = tilesSeen; i < tiles.size(); ++i) {
+        const TileShape& shape = shapes[i];
+        int x0 = static_cast<int>(std::floor(shape.minX / CHUNK_SIZE));
+        int y0 = static_cast<int>(std::floor(shape.minY / CHUNK_SIZE));
+        int x1 = static_cast<int>(std::floor(shape.maxX / CHUNK_SIZE));
+        int y1 = static_cast<int>(std::floor(shape.maxY / CHUNK_SIZE));
+
+        double area = (static_cast<double>(x1) - x0 + 1) * (static_cast<double>(y1) - y0 + 1);
+        if (area > chunks.size()) {
+            for (auto& entry : chunks) {
+                int cx = static_cast<int32_t>(entry.first >> 32);
+                int cy = static_cast<int32_t>(entry.first & 0xffffffffu);
+                if (cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1) {
+                    entry.second.dirty = true;
+                }
+            }
+            continue;
+        }
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                auto it = chunks.find(chunkKey(cx, cy));
+                if (it != chunks.end()) {
+                    it->second.dirty = true;
+                }
+            }
+        }
+    }
+    tilesSeen = tiles.size();
+}
+
+bool TrackChunks::findTiles(const Track& track, int cx, int cy) {
+    const float originX = cx * static_cast<float>(CHUNK_SIZE);
+    const float originY = cy * static_cast<float>(CHUNK_SIZE);
+    track.drawTilesInRect(originX, originY, originX + CHUNK_SIZE, originY + CHUNK_SIZE, chunkTiles);
+    return !chunkTiles.empty();
+}
+
+bool TrackChunks::redraw(const Track& track, int cx, int cy, Chunk& chunk) {
+    const float originX = cx * static_cast<float>(CHUNK_SIZE);
+    const float originY = cy * static_cast<float>(CHUNK_SIZE);
+    chunk.dirty = false;
+
+    if (!chunk.texture) {
+        chunk.texture = acquireTexture();
+        if (!chunk.texture) {
+            return false;
+        }
+    }
+
+    SDL_Renderer* sdl = renderer.getSDLRenderer();
+    SDL_Texture* previous = SDL_GetRenderTarget(sdl);
+    if (!SDL_SetRenderTarget(sdl, chunk.texture)) {
+        return false;
+    }
+
+    SDL_SetRenderDrawColor(sdl, 0, 0, 0, 0);
+    SDL_RenderClear(sdl);
+
+    track.drawLayer(renderer, originX, originY, originX + CHUNK_SIZE, originY + CHUNK_SIZE, originX, originY);
+    renderer.flush();
+
+    SDL_SetRenderTarget(sdl, previous);
+    ++redrawCount;
+    return true;
+}
+
+SDL_Texture* TrackChunks::acquireTexture() {
+    if (!spareTextures.empty()) {
+        SDL_Texture* texture = spareTextures.back();
+        spareTextures.pop_back();
+        return texture;
+    }
+
+    if (textureCount >= MAX_TEXTURES) {
+        // Take over the texture of the chunk shown longest ago, which is
+        // forgotten until it comes back into view
+        auto oldest = chunks.end();
+        for (auto it = chunks.begin(); it != chunks.end(); ++it) {
+            const Chunk& candidate = it->second;
+            if (candidate.texture && candidate.lastShown < frame &&
+                (oldest == chunks.end() || candidate.lastShown < oldest->second.lastShown)) {
+                oldest = it;
+            }
+        }
+        if (oldest != chunks.end()) {
+            SDL_Texture* texture = oldest->second.texture;
+            chunks.erase(oldest);
+            return texture;
+        }
+    }
+
+    SDL_Texture* texture = SDL_CreateTexture(renderer.getSDLRenderer(), SDL_PIXELFORMAT_ARGB8888,
+                                             SDL_TEXTUREACCESS_TARGET, CHUNK_SIZE, CHUNK_SIZE);
+    if (!texture) {
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
+    ++textureCount;
+    return texture;
+}
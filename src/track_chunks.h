@@ -0,0 +1,75 @@
+#ifndef TRACK_CHUNKS_H
+#define TRACK_CHUNKS_H
+
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Track;
+class Camera;
+class Renderer;
+
+// The static track layer cached in render-target textures CHUNK_SIZE world
+// units square. A frame copies the chunks that intersect the view instead
+// of drawing every tile, so its cost follows the screen, not the track.
+//
+// A chunk is rasterised the first time it comes into view and again only
+// after tiles are added inside it; loading or clearing the track drops
+// them all. At most MAX_TEXTURES chunk textures (4 MiB each) are kept, the
+// least recently shown being reused beyond that. Only chunks with tiles in
+// them are tracked, and a chunk that gives up its texture is forgotten, so
+// the bookkeeping stays within the kept textures plus the view however far
+// the camera roams. When the renderer cannot draw to textures, tiles are
+// drawn directly as before.
+//
+// Textures belong to the SDL renderer: clear() (or destroy) this before it.
+class TrackChunks {
+public:
+    static constexpr int CHUNK_SIZE = 1024;
+    static constexpr size_t MAX_TEXTURES = 32;
+
+    explicit TrackChunks(Renderer& renderer);
+    ~TrackChunks();
+
+    void render(const Track& track, const Camera& camera);
+    void clear();
+
+    size_t getTextureCount() const { return textureCount; }
+    // Chunks tracked: those holding a texture, plus any in view awaiting one
+    size_t getChunkCount() const { return chunks.size(); }
+    // Chunks rasterised since construction
+    size_t getRedrawCount() const { return redrawCount; }
+
+private:
+    struct Chunk {
+        SDL_Texture* texture = nullptr;
+        bool dirty = true;
+        uint64_t lastShown = 0;
+    };
+
+    Renderer& renderer;
+    std::unordered_map<uint64_t, Chunk> chunks;
+    std::vector<SDL_Texture*> spareTextures;
+    std::vector<uint32_t> chunkTiles;
+
+    uint64_t generation;
+    size_t tilesSeen;
+    uint64_t frame;
+    size_t textureCount;
+    size_t redrawCount;
+    bool unsupported;
+
+    static uint64_t chunkKey(int cx, int cy) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    }
+
+    void sync(const Track& track);
+    // Fills chunkTiles with the draw tiles overlapping a chunk
+    bool findTiles(const Track& track, int cx, int cy);
+    bool redraw(const Track& track, int cx, int cy, Chunk& chunk);
+    SDL_Texture* acquireTexture();
+};
+
+#endif // TRACK_CHUNKS_H
@@ -0,0 +1,95 @@
+#include "track.h"
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool sameTrack(const Track& a, const Track& b) {
+    const auto& tilesA = a.getTiles();
+    const auto& tilesB = b.getTiles();
+    const auto& startsA = a.getStartPositions();
+    const auto& startsB = b.getStartPositions();
+    
+    return tilesA.size() == tilesB.size() && startsA.size() == startsB.size() &&
+           std::memcmp(tilesA.data(), tilesB.data(), tilesA.size() * sizeof(Tile)) == 0 &&
+           std::memcmp(startsA.data(), startsB.data(), startsA.size() * sizeof(Point2D)) == 0;
+}
+
+// Compiles one JSON track and checks that JSON -> .trk -> JSON is lossless
+bool compileTrack(const std::string& input, const std::string& output) {
+    Track source;
+    if (!source.loadFromFile(input) || !source.saveCompiled(output)) {
+        return false;
+    }
+    
+    Track compiled;
+    if (!compiled.loadCompiled(output) || !sameTrack(source, compiled)) {
+        std::cerr << "Compiled track does not match source: " << input << std::endl;
+        return false;
+    }
+    
+    std::string roundTrip = (std::filesystem::temp_directory_path() /
+                             (std::filesystem::path(output).stem().string() + ".roundtrip.json")).string();
+    Track decompiled;
+    bool lossless = compiled.saveToFile(roundTrip) &&
+                    decompiled.loadFromFile(roundTrip) &&
+                    sameTrack(source, decompiled);
+    std::error_code error;
+    std::filesystem::remove(roundTrip, error);
+    
+    if (!lossless) {
+        std::cerr << "JSON round trip is not lossless: " << input << std::endl;
+        return false;
+    }
+    
+    std::cout << input << " -> " << output << " (" << source.getTiles().size() << " tiles, "
+              << std::filesystem::file_size(output) << " bytes)" << std::endl;
+    return true;
+}
+
+void printUsage() {
+    std::cerr << "Usage: track_compiler [-o output_dir] track.json...\n"
+              << "       track_compiler --decompile track.trk track.json" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::strcmp(argv[1], "--decompile") == 0) {
+        if (argc != 4) {
+            printUsage();
+            return 1;
+        }
+        Track track;
+        return track.loadCompiled(argv[2]) && track.saveToFile(argv[3]) ? 0 : 1;
+    }
+    
+    std::string outputDir;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outputDir = argv[++i];
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    
+    if (inputs.empty()) {
+        printUsage();
+        return 1;
+    }
+    
+    bool ok = true;
+    for (const auto& input : inputs) {
+        std::filesystem::path output = Track::compiledPathFor(input);
+        if (!outputDir.empty()) {
+            output = std::filesystem::path(outputDir) / output.filename();
+        }
+        ok = compileTrack(input, output.string()) && ok;
+    }
+    
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+#ifndef TRACK_FORMAT_H
+#define TRACK_FORMAT_H
+
+#include <cstdint>
+#include <type_traits>
+#include "tile.h"
+
+// Compiled track file (.trk), produced from the JSON authoring format by
+// track_compiler. Little-endian, laid out so every section can be copied
+// straight out of a memory mapping:
+//
+//   CompiledTrackHeader
+//   Tile       tiles[tileCount]
+//   Point2D    startPositions[startCount]
+//   uint32_t   gridCellStart[gridColumns * gridRows + 1]
+//   uint32_t   gridCellItems[gridItemCount]
+//
+// Each section starts at the offset recorded in the header, aligned to 8.
+
+constexpr char COMPILED_TRACK_MAGIC[4] = { 'M', 'R', 'T', 'K' };
+// 2: the grid indexes rotated tiles by their rotated bounds
+constexpr uint32_t COMPILED_TRACK_VERSION = 2;
+constexpr uint32_t COMPILED_TRACK_ENDIAN_TAG = 0x01020304;
+
+struct CompiledTrackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t endianTag;
+    uint32_t tileCount;
+    uint32_t startCount;
+
+    int32_t gridColumns;
+    int32_t gridRows;
+    float gridOriginX;
+    float gridOriginY;
+    float gridCellSize;
+    uint32_t gridItemCount;
+    uint32_t reserved;
+
+    uint64_t tilesOffset;
+    uint64_t startsOffset;
+    uint64_t gridCellStartOffset;
+    uint64_t gridCellItemsOffset;
+    uint64_t fileSize;
+};
+
+// Tiles and start positions are stored exactly as they sit in memory
+static_assert(std::is_trivially_copyable<Tile>::value && sizeof(Tile) == 24,
+              "Tile layout is part of the compiled track format");
+static_assert(std::is_trivially_copyable<Point2D>::value && sizeof(Point2D) == 8,
+              "Point2D layout is part of the compiled track format");
+static_assert(sizeof(CompiledTrackHeader) == 88, "Compiled track header must stay packed");
+
+#endif // TRACK_FORMAT_H
@@ -0,0 +1,335 @@
+#include "track_gen.h"
+#include "track.h"
+#include "job_system.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+namespace {
+
+// Node rows per independently seeded piece of the spanning tree. Fixed, so
+// the tree does not depend on how many threads build it.
+const int BAND_ROWS = 16;
+// Horizontal tree edges get this share of a vertical edge's random weight,
+// so Kruskal takes them first and the loop runs further in x
+const double HORIZONTAL_BIAS = 0.35;
+
+// Directions between cells, as bits of a cell's connection mask
+enum Direction { RIGHT, DOWN, LEFT, UP };
+const int STEP_X[] = { 1, 0, -1, 0 };
+const int STEP_Y[] = { 0, 1, 0, -1 };
+
+uint8_t bit(int direction) {
+    return static_cast<uint8_t>(1u << direction);
+}
+
+int opposite(int direction) {
+    return (direction + 2) % 4;
+}
+
+// splitmix64 over (seed, stream, index): independent random numbers for any
+// piece of the work, in any order
+uint64_t hashOf(uint64_t seed, uint64_t stream, uint64_t index) {
+    uint64_t z = seed + stream * 0xbf58476d1ce4e5b9ull + index * 0x9e3779b97f4a7c15ull + 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// In [0, 1)
+double unitOf(uint64_t hash) {
+    return (hash >> 11) * (1.0 / 9007199254740992.0);
+}
+
+enum Stream : uint64_t { TREE_EDGE = 1, BAND_JOIN, JUMP };
+
+size_t findRoot(std::vector<uint32_t>& parent, size_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+struct Layout {
+    int columns, rows;       // Nodes
+    std::vector<uint8_t> right, down; // Tree edge from each node to its +x / +y neighbour
+};
+
+// Random spanning tree by Kruskal over shuffled edges, one band of rows at
+// a time, then one random edge down between each pair of bands
+void buildTree(Layout& layout, uint64_t seed, JobSystem& jobs) {
+    const int columns = layout.columns;
+    const int rows = layout.rows;
+    layout.right.assign(static_cast<size_t>(columns) * rows, 0);
+    layout.down.assign(static_cast<size_t>(columns) * rows, 0);
+    const size_t bands = (rows + BAND_ROWS - 1) / BAND_ROWS;
+
+    jobs.parallelFor(bands, 1, [&](size_t begin, size_t end) {
+        std::vector<std::pair<double, uint32_t>> edges;
+        std::vector<uint32_t> parent;
+        for (size_t band = begin; band < end; ++band) {
+            const int firstRow = static_cast<int>(band) * BAND_ROWS;
+            const int bandRows = std::min(BAND_ROWS, rows - firstRow);
+            const size_t firstNode = static_cast<size_t>(firstRow) * columns;
+            const uint32_t nodes = static_cast<uint32_t>(bandRows * columns);
+
+            // Edge 2n leads right from node n of the band, 2n + 1 down
+            edges.clear();
+            for (uint32_t n = 0; n < nodes; ++n) {
+                if (static_cast<int>(n % columns) + 1 < columns) {
+                    double weight = unitOf(hashOf(seed, TREE_EDGE, 2 * (firstNode + n))) * HORIZONTAL_BIAS;
+                    edges.push_back({ weight, 2 * n });
+                }
+                if (static_cast<int>(n / columns) + 1 < bandRows) {
+                    edges.push_back({ unitOf(hashOf(seed, TREE_EDGE, 2 * (firstNode + n) + 1)), 2 * n + 1 });
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+
+            parent.resize(nodes);
+            std::iota(parent.begin(), parent.end(), 0u);
+            for (const auto& edge : edges) {
+                uint32_t from = edge.second / 2;
+                bool isDown = edge.second & 1;
+                uint32_t to = isDown ? from + columns : from + 1;
+                size_t a = findRoot(parent, from);
+                size_t b = findRoot(parent, to);
+                if (a == b) {
+                    continue;
+                }
+                parent[a] = static_cast<uint32_t>(b);
+                (isDown ? layout.down : layout.right)[firstNode + from] = 1;
+            }
+        }
+    });
+
+    for (size_t band = 1; band < bands; ++band) {
+        int column = static_cast<int>(hashOf(seed, BAND_JOIN, band) % columns);
+        layout.down[(band * BAND_ROWS - 1) * columns + column] = 1;
+    }
+}
+
+// Connection mask of every cell on the (2 * columns) x (2 * rows) grid.
+// Each node's four cells start as a little loop of their own; every tree
+// edge opens the two loops it joins and links them, leaving one loop
+// through every cell.
+std::vector<uint8_t> connectCells(const Layout& layout, JobSystem& jobs) {
+    const int columns = layout.columns;
+    const int width = 2 * columns;
+    std::vector<uint8_t> masks(static_cast<size_t>(width) * 2 * layout.rows);
+
+    jobs.parallelFor(layout.rows, 64, [&](size_t begin, size_t end) {
+        for (size_t row = begin; row < end; ++row) {
+            for (int column = 0; column < columns; ++column) {
+                size_t n = row * columns + column;
+                bool r = layout.right[n];
+                bool d = layout.down[n];
+                bool l = column > 0 && layout.right[n - 1];
+                bool u = row > 0 && layout.down[n - columns];
+                size_t topLeft = 2 * row * width + 2 * column;
+                masks[topLeft] = (u ? bit(UP) : bit(RIGHT)) | (l ? bit(LEFT) : bit(DOWN));
+                masks[topLeft + 1] = (u ? bit(UP) : bit(LEFT)) | (r ? bit(RIGHT) : bit(DOWN));
+                masks[topLeft + width] = (d ? bit(DOWN) : bit(RIGHT)) | (l ? bit(LEFT) : bit(UP));
+                masks[topLeft + width + 1] = (d ? bit(DOWN) : bit(LEFT)) | (r ? bit(RIGHT) : bit(UP));
+            }
+        }
+    });
+    return masks;
+}
+
+// Cells in order round the loop, and the direction out of each
+void traceLoop(const std::vector<uint8_t>& masks, int width, std::vector<uint32_t>& cells, std::vector<uint8_t>& out) {
+    cells.clear();
+    out.clear();
+    cells.reserve(masks.size());
+    out.reserve(masks.size());
+    uint32_t cell = 0;
+    int from = -1;
+    do {
+        int direction = 0;
+        while (!(masks[cell] & bit(direction)) || direction == from) {
+            ++direction;
+        }
+        cells.push_back(cell);
+        out.push_back(static_cast<uint8_t>(direction));
+        cell = static_cast<uint32_t>(static_cast<int>(cell) + STEP_X[direction] + STEP_Y[direction] * width);
+        from = opposite(direction);
+    } while (cell != 0 && cells.size() < masks.size());
+}
+
+// Longest run of cells leaving in the given direction, as its last index
+size_t longestRun(const std::vector<uint8_t>& out, int direction, size_t& length) {
+    const size_t count = out.size();
+    // Start counting just after a cell that turns, so runs never wrap
+    size_t begin = 0;
+    while (begin < count && out[begin] == direction) {
+        ++begin;
+    }
+    length = 0;
+    size_t last = 0;
+    size_t run = 0;
+    for (size_t k = 1; k <= count; ++k) {
+        size_t i = (begin + k) % count;
+        run = out[i] == direction ? run + 1 : 0;
+        if (run > length) {
+            length = run;
+            last = i;
+        }
+    }
+    return last;
+}
+
+} // namespace
+
+GeneratedTrack generateTrack(const TrackGenOptions& options, JobSystem& jobs) {
+    PROFILE_ZONE("generateTrack");
+    GeneratedTrack result;
+    const int road = std::max(1, options.roadWidth);
+    const int pitch = road + 2;
+    const float size = options.tileSize;
+    // Every cell connects on two sides: the middle square, two strips of
+    // road and 1x1 walls round the rest
+    const size_t tilesPerCell = 3 + static_cast<size_t>(pitch) * pitch - road * road - 2 * road;
+
+    // Square-ish, four cells to a node
+    Layout layout;
+    double nodes = std::max(1.0, static_cast<double>(options.tiles) / (4.0 * tilesPerCell));
+    layout.columns = std::max(1, static_cast<int>(std::lround(std::sqrt(nodes))));
+    layout.rows = std::max(1, static_cast<int>(std::lround(nodes / layout.columns)));
+    buildTree(layout, options.seed, jobs);
+    const int width = 2 * layout.columns;
+    const std::vector<uint8_t> masks = connectCells(layout, jobs);
+
+    std::vector<uint32_t> cells;
+    std::vector<uint8_t> out;
+    traceLoop(masks, width, cells, out);
+    const size_t loop = cells.size();
+
+    // Drive whichever way round has the longer straight heading +x
+    size_t forward = 0, backward = 0;
+    longestRun(out, RIGHT, forward);
+    longestRun(out, LEFT, backward);
+    if (backward > forward) {
+        std::reverse(cells.begin(), cells.end());
+        for (size_t k = 0; k < loop; ++k) {
+            uint32_t next = cells[(k + 1) % loop];
+            int dx = static_cast<int>(next % width) - static_cast<int>(cells[k] % width);
+            int dy = static_cast<int>(next / width) - static_cast<int>(cells[k] / width);
+            out[k] = static_cast<uint8_t>(dx > 0 ? RIGHT : dx < 0 ? LEFT : dy > 0 ? DOWN : UP);
+        }
+    }
+    size_t straight = 0;
+    const size_t startCell = longestRun(out, RIGHT, straight);
+    result.loopCells = loop;
+    result.straightCells = straight;
+
+    auto centreOf = [&](size_t k) {
+        uint32_t cell = cells[k % loop];
+        return Point2D{ ((cell % width) * pitch + pitch / 2.0f) * size, ((cell / width) * pitch + pitch / 2.0f) * size };
+    };
+
+    // Two abreast, a tile apart front to back, following the road back
+    // from the line
+    const float rowSpacing = size;
+    const float lateral = road * size / 4;
+    Point2D line = centreOf(startCell);
+    line.x += (pitch / 2.0f - 0.5f) * size;
+    size_t gridCells = 1;
+    {
+        Point2D from = line;
+        Point2D to = centreOf(startCell);
+        size_t k = startCell;
+        float walked = 0.0f;
+        for (int slot = 0; slot < options.startPositions; ++slot) {
+            float target = rowSpacing * (slot / 2 + 1);
+            float segment = std::hypot(to.x - from.x, to.y - from.y);
+            while (walked + segment < target) {
+                walked += segment;
+                from = to;
+                k = (k + loop - 1) % loop;
+                to = centreOf(k);
+                segment = std::hypot(to.x - from.x, to.y - from.y);
+                ++gridCells;
+            }
+            float t = (target - walked) / segment;
+            // Facing the way the cars drive, from 'to' towards 'from'
+            float ux = (from.x - to.x) / segment;
+            float uy = (from.y - to.y) / segment;
+            float side = slot % 2 == 0 ? -lateral : lateral;
+            result.startPositions.push_back({ from.x + (to.x - from.x) * t - uy * side,
+                                              from.y + (to.y - from.y) * t + ux * side });
+        }
+    }
+
+    // Checkpoints evenly round the loop after the start line
+    std::vector<uint8_t> checkpoint(loop, 0);
+    const int checkpoints = std::max(0, options.checkpoints);
+    for (int c = 0; c < checkpoints; ++c) {
+        size_t offset = static_cast<size_t>(static_cast<double>(loop) * (c + 1) / (checkpoints + 1));
+        if (offset > 0 && offset < loop) {
+            checkpoint[(startCell + offset) % loop] = 1;
+        }
+    }
+
+    result.tiles.resize(loop * tilesPerCell);
+    jobs.parallelFor(loop, 1024, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const uint32_t cell = cells[k];
+            const uint8_t mask = masks[cell];
+            const int from = opposite(out[(k + loop - 1) % loop]);
+            const float originX = (cell % width) * pitch * size;
+            const float originY = (cell / width) * pitch * size;
+
+            // Clear of the grid and the line itself
+            const size_t behindStart = (startCell + loop - k) % loop;
+            const bool jump = !checkpoint[k] && behindStart > gridCells && k != (startCell + 1) % loop &&
+                              unitOf(hashOf(options.seed, JUMP, k)) < options.jumpChance;
+
+            // The road is one tile wide in the link graph, as on the shipped
+            // tracks: the middle square plus a strip out to each side it
+            // connects on. The start line is the strip leaving the start
+            // cell, a checkpoint the strip into its cell.
+            Tile* tile = &result.tiles[k * tilesPerCell];
+            *tile++ = { jump ? TileType::JUMP : TileType::TRACK, originX + size, originY + size,
+                        road * size, road * size, 0.0f };
+            for (int direction = RIGHT; direction <= UP; ++direction) {
+                if (!(mask & bit(direction))) {
+                    continue;
+                }
+                TileType type = TileType::TRACK;
+                if (k == startCell && direction == RIGHT) {
+                    type = TileType::START_FINISH;
+                } else if (checkpoint[k] && direction == from) {
+                    type = TileType::CHECKPOINT;
+                }
+                const bool across = direction == RIGHT || direction == LEFT;
+                const float x = direction == RIGHT ? (pitch - 1) * size : direction == LEFT ? 0.0f : size;
+                const float y = direction == DOWN ? (pitch - 1) * size : direction == UP ? 0.0f : size;
+                *tile++ = { type, originX + x, originY + y, across ? size : road * size, across ? road * size : size, 0.0f };
+            }
+            for (int j = 0; j < pitch; ++j) {
+                for (int i = 0; i < pitch; ++i) {
+                    const bool middleX = i >= 1 && i <= road;
+                    const bool middleY = j >= 1 && j <= road;
+                    const bool isRoad = (middleX && middleY) ||
+                                        (middleY && i > road && (mask & bit(RIGHT))) ||
+                                        (middleY && i < 1 && (mask & bit(LEFT))) ||
+                                        (middleX && j > road && (mask & bit(DOWN))) ||
+                                        (middleX && j < 1 && (mask & bit(UP)));
+                    if (!isRoad) {
+                        *tile++ = { TileType::WALL, originX + i * size, originY + j * size, size, size, 0.0f };
+                    }
+                }
+            }
+        }
+    });
+    return result;
+}
+
+void buildTrack(Track& track, const GeneratedTrack& generated) {
+    PROFILE_ZONE("buildTrack");
+    track.setTiles(generated.tiles, generated.startPositions);
+}
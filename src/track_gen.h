@@ -0,0 +1,54 @@
+#ifndef TRACK_GEN_H
+#define TRACK_GEN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "tile.h"
+
+class JobSystem;
+class Track;
+
+struct TrackGenOptions {
+    uint64_t seed = 1;
+    size_t tiles = 10000;      // Target; rounded to whole rows of nodes
+    int roadWidth = 4;         // Tiles across the road
+    float tileSize = 50.0f;
+    int startPositions = 8;
+    int checkpoints = 8;
+    float jumpChance = 0.05f;  // Per cell of road along the circuit
+};
+
+struct GeneratedTrack {
+    std::vector<Tile> tiles;
+    std::vector<Point2D> startPositions;
+    size_t loopCells = 0;      // Cells the circuit passes through
+    size_t straightCells = 0;  // Straight cells before the start line
+};
+
+// Procedural closed circuits of any size, for benchmarks and soak runs.
+//
+// The circuit is the outline of a random spanning tree over a grid of
+// nodes: each node owns a 2x2 block of cells, and walking round the tree
+// passes through every cell once and comes back to the start, so there is
+// one loop and it never crosses itself. Every cell is roadWidth + 2 tiles
+// square with one tile of wall either side of the road. The road through
+// a cell is three tiles, a square and a strip out to each neighbour, so
+// it is one tile wide to the racing line; the walls are 1x1 tiles filling
+// the rest, like a course laid out in the editor. Spanning-tree edges
+// between blocks in a row are favoured, which makes for longer straights.
+//
+// The start line goes at the end of the longest straight heading +x, the
+// way cars spawn facing, with the grid two abreast behind it following
+// the road. Checkpoints are spread evenly round the loop and jumps
+// scattered over it.
+//
+// Each band of node rows draws its part of the tree from its own seed, and
+// each cell its tiles, so the work spreads over the job system's threads
+// and the result depends only on the options, not the thread count.
+GeneratedTrack generateTrack(const TrackGenOptions& options, JobSystem& jobs);
+
+// Replaces the track with the generated one, merged as loading would
+void buildTrack(Track& track, const GeneratedTrack& generated);
+
+#endif // TRACK_GEN_H
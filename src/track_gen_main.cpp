@@ -0,0 +1,98 @@
+#include "track_gen.h"
+#include "track.h"
+#include "job_system.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Writes a seeded procedural circuit of roughly the requested tile count,
+// for benchmarks and soak runs that need large tracks. The same options
+// always give the same track, whatever the thread count. Paths ending in
+// .trk are written compiled, anything else as JSON; use .trk from a few
+// million tiles up, where the JSON gets slow to write and read.
+
+namespace {
+
+struct Options {
+    TrackGenOptions generator;
+    std::string outputPath;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+};
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--tiles") == 0 && hasValue) {
+            options.generator.tiles = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.generator.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--road") == 0 && hasValue) {
+            options.generator.roadWidth = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--starts") == 0 && hasValue) {
+            options.generator.startPositions = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--checkpoints") == 0 && hasValue) {
+            options.generator.checkpoints = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--jumps") == 0 && hasValue) {
+            options.generator.jumpChance = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (argv[i][0] != '-' && options.outputPath.empty()) {
+            options.outputPath = argv[i];
+        } else {
+            return false;
+        }
+    }
+    return !options.outputPath.empty() && options.generator.tiles > 0 && options.generator.roadWidth > 0 &&
+           options.generator.startPositions > 0 && options.generator.checkpoints >= 0;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: track_gen [--tiles N] [--seed N] [--road N] [--starts N] [--checkpoints N]\n"
+                     "                 [--jumps CHANCE] [--threads N] output.json|output.trk" << std::endl;
+        return 1;
+    }
+
+    // The calling thread works too
+    JobSystem jobs(options.threads - 1);
+    auto start = std::chrono::steady_clock::now();
+    GeneratedTrack generated = generateTrack(options.generator, jobs);
+    double generateMs = millisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    Track track;
+    buildTrack(track, generated);
+    double buildMs = millisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    bool saved = endsWith(options.outputPath, ".trk") ? track.saveCompiled(options.outputPath)
+                                                      : track.saveToFile(options.outputPath);
+    if (!saved) {
+        std::cerr << "Failed to write " << options.outputPath << std::endl;
+        return 1;
+    }
+    double saveMs = millisecondsSince(start);
+
+    std::printf("%s: %zu tiles, %zu cells round the loop, %zu straight before the line, %zu start positions\n",
+                options.outputPath.c_str(), generated.tiles.size(), generated.loopCells, generated.straightCells,
+                generated.startPositions.size());
+    std::printf("generate %.1f ms, build %.1f ms, save %.1f ms on %u threads\n", generateMs, buildMs, saveMs,
+                options.threads);
+    return 0;
+}